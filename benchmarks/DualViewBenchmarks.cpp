@@ -0,0 +1,370 @@
+// Headless benchmarks for the Compute module
+//
+// Generates synthetic expression matrices and times the compute kernels, the dataset independent functions in Computation.cpp
+// and SampleScopeProcessor.cpp. Results are written as JSON for regression tracking.
+// All matrices are stored dense, like the points data the plugin reads. The "mostly zeros" scenarios only have a fraction
+// (--density) of non-zero values, they are not stored in a sparse format.
+//
+// Usage: DualViewBenchmarks [--cells 10000,100000] [--genes 500,5000] [--density 0.1] [--repeats 5] [--max-memory-gb 8] [--output results.json]
+
+#include "Compute/ComputeKernels.h"
+#include "Compute/Computation.h"
+#include "Compute/SampleScopeProcessor.h"
+#include "Compute/CrossingMinimization.h"
+#include "Compute/DifferentialExpression.h"
+#include "Compute/SpectralOrdering.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <span>
+#include <tuple>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+    struct Scale
+    {
+        std::int64_t numCells;
+        std::int64_t numGenes;
+        bool         mostlyZeros;       // only a fraction of the values is non-zero, still stored dense
+    };
+
+    // fraction of cells in a selection, number of selected genes and number of clusters used by the benchmarks
+    const double selectedCellFraction = 0.01;
+    const std::int64_t numSelectedGenes = 50;
+    const int numClusters = 20;
+    const float lineThreshold = 0.9f;
+
+    std::vector<std::int64_t> parseSizes(const QString& value)
+    {
+        std::vector<std::int64_t> sizes;
+        for (const QString& item : value.split(',', Qt::SkipEmptyParts))
+            sizes.push_back(item.trimmed().toLongLong());
+        return sizes;
+    }
+
+    // log-normal like values in every cell, or with mostlyZeros only in a fraction of the cells (the others are zero)
+    std::vector<float> generateMatrix(const Scale& scale, double density, std::uint32_t seed)
+    {
+        std::vector<float> matrix(static_cast<std::size_t>(scale.numCells * scale.numGenes), 0.0f);
+
+#pragma omp parallel
+        {
+#ifdef _OPENMP
+            std::mt19937 generator(seed + omp_get_thread_num());
+#else
+            std::mt19937 generator(seed);
+#endif
+            std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+            std::exponential_distribution<float> expression(1.0f);
+
+#pragma omp for
+            for (std::int64_t cell = 0; cell < scale.numCells; cell++)
+            {
+                float* row = matrix.data() + cell * scale.numGenes;
+                for (std::int64_t gene = 0; gene < scale.numGenes; gene++)
+                {
+                    if (!scale.mostlyZeros || uniform(generator) < density)
+                        row[gene] = std::log1p(expression(generator) * 4.0f);
+                }
+            }
+        }
+
+        return matrix;
+    }
+
+    // label of the matrix of a scale in the output
+    QString matrixLabel(const Scale& scale)
+    {
+        return scale.mostlyZeros ? "dense, mostly zeros" : "dense";
+    }
+
+    // count sorted, distinct indices in [0, range), at least one unless the range is empty
+    std::vector<std::uint32_t> sampleIndices(std::int64_t count, std::int64_t range, std::mt19937& generator)
+    {
+        if (range <= 0)
+            return {};
+
+        std::vector<std::uint32_t> indices(range);
+        std::iota(indices.begin(), indices.end(), 0u);
+        std::shuffle(indices.begin(), indices.end(), generator);
+        indices.resize(std::max<std::int64_t>(1, std::min(count, range)));
+        std::sort(indices.begin(), indices.end());
+        return indices;
+    }
+
+    class BenchmarkRunner
+    {
+    public:
+        BenchmarkRunner(int repeats) : _repeats(repeats) {}
+
+        void run(const QString& name, const Scale& scale, const std::function<void()>& function)
+        {
+            // warm-up, also makes sure that lazily allocated outputs exist
+            function();
+
+            std::vector<double> timings;
+            timings.reserve(_repeats);
+
+            for (int repeat = 0; repeat < _repeats; repeat++)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                function();
+                const auto end = std::chrono::steady_clock::now();
+                timings.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+
+            std::sort(timings.begin(), timings.end());
+
+            QJsonObject result;
+            result["name"] = name;
+            result["cells"] = static_cast<qint64>(scale.numCells);
+            result["genes"] = static_cast<qint64>(scale.numGenes);
+            result["matrix"] = matrixLabel(scale);
+            result["repeats"] = _repeats;
+            result["min_ms"] = timings.front();
+            result["median_ms"] = timings[timings.size() / 2];
+            result["mean_ms"] = std::accumulate(timings.begin(), timings.end(), 0.0) / timings.size();
+
+            _results.append(result);
+
+            QTextStream(stdout) << QString("%1 %2x%3 %4: median %5 ms\n").arg(name, -40).arg(scale.numCells).arg(scale.numGenes).arg(matrixLabel(scale), -19).arg(timings[timings.size() / 2], 0, 'f', 3);
+        }
+
+        void skip(const Scale& scale, const QString& reason)
+        {
+            QJsonObject result;
+            result["cells"] = static_cast<qint64>(scale.numCells);
+            result["genes"] = static_cast<qint64>(scale.numGenes);
+            result["matrix"] = matrixLabel(scale);
+            result["skipped"] = reason;
+
+            _results.append(result);
+
+            QTextStream(stdout) << QString("%1x%2 skipped: %3\n").arg(scale.numCells).arg(scale.numGenes).arg(reason);
+        }
+
+        const QJsonArray& getResults() const { return _results; }
+
+    private:
+        int         _repeats;
+        QJsonArray  _results;
+    };
+
+    void benchmarkScale(BenchmarkRunner& runner, const Scale& scale, double density)
+    {
+        std::mt19937 generator(42);
+
+        const std::vector<float> data = generateMatrix(scale, density, 42);
+        const kernels::MatrixView<float> matrix(std::span<const float>(data), scale.numCells, scale.numGenes);
+
+        // the same values as 16 bit integers, to compare element type instantiations
+        std::vector<std::int16_t> dataInt16(data.size());
+        std::transform(data.begin(), data.end(), dataInt16.begin(), [](float value) { return static_cast<std::int16_t>(value); });
+        const kernels::MatrixView<std::int16_t> matrixInt16(std::span<const std::int16_t>(dataInt16), scale.numCells, scale.numGenes);
+
+        const auto selectedCells = sampleIndices(static_cast<std::int64_t>(scale.numCells * selectedCellFraction), scale.numCells, generator);
+        const auto selectedGenes = sampleIndices(numSelectedGenes, scale.numGenes, generator);
+
+        std::vector<std::uint32_t> allCells(scale.numCells);
+        std::iota(allCells.begin(), allCells.end(), 0u);
+
+        // clusters partition the cells round robin
+        std::vector<std::vector<std::uint32_t>> clusterCells(numClusters);
+        for (std::int64_t cell = 0; cell < scale.numCells; cell++)
+            clusterCells[cell % numClusters].push_back(static_cast<std::uint32_t>(cell));
+
+        // --- kernels
+        std::vector<float> columnMins, columnRanges, means;
+        runner.run("kernels::columnRanges", scale, [&]() { kernels::columnRanges(matrix, columnMins, columnRanges); });
+        runner.run("kernels::columnMeans", scale, [&]() { kernels::columnMeans(matrix, means); });
+        runner.run("kernels::columnMeansOverRows", scale, [&]() { kernels::columnMeansOverRows(matrix, selectedCells, means); });
+        runner.run("kernels::rowMeansOverColumns", scale, [&]() { kernels::rowMeansOverColumns(matrix, selectedGenes, means); });
+        runner.run("kernels::columnRanges<int16>", scale, [&]() { kernels::columnRanges(matrixInt16, columnMins, columnRanges); });
+        runner.run("kernels::columnMeans<int16>", scale, [&]() { kernels::columnMeans(matrixInt16, means); });
+
+        std::vector<float> gathered;
+        kernels::rowMeansOverColumns(matrix, selectedGenes, means);
+        runner.run("kernels::gather", scale, [&]() { kernels::gather(means, allCells, gathered); });
+
+        kernels::columnRanges(matrix, columnMins, columnRanges);
+
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> lines;
+        runner.run("kernels::lineConnections", scale, [&]() { kernels::lineConnections(matrix, allCells, columnMins, columnRanges, lineThreshold, lines); });
+
+        std::vector<std::vector<float>> groupMeans;
+        std::vector<int> topGroups;
+        runner.run("kernels::groupColumnMeans", scale, [&]() { kernels::groupColumnMeans(matrix, clusterCells, groupMeans); });
+        runner.run("kernels::topGroupPerColumn", scale, [&]() { kernels::topGroupPerColumn(groupMeans, topGroups); });
+
+        kernels::GeneRankIndex geneRankIndex;
+        runner.run("kernels::GeneRankIndex::build", scale, [&]() { geneRankIndex.build(matrix); });
+
+        std::vector<kernels::GeneStatistics> geneStatistics;
+        kernels::DifferentialExpressionSettings wilcoxon, welch, wilcoxonTop;
+        welch.test = kernels::DifferentialExpressionTest::WelchTTest;
+        wilcoxonTop.topK = 100;
+
+        runner.run("kernels::differentialExpression<wilcoxon>", scale, [&]() { kernels::differentialExpression(matrix, geneRankIndex, selectedCells, wilcoxon, geneStatistics); });
+        runner.run("kernels::differentialExpression<welch>", scale, [&]() { kernels::differentialExpression(matrix, geneRankIndex, selectedCells, welch, geneStatistics); });
+        runner.run("kernels::differentialExpression<wilcoxon, top 100>", scale, [&]() { kernels::differentialExpression(matrix, geneRankIndex, selectedCells, wilcoxonTop, geneStatistics); });
+
+        kernels::GroupColumnMoments clusterMoments;
+        std::vector<std::vector<kernels::GeneStatistics>> clusterMarkers;
+        runner.run("kernels::groupColumnMoments", scale, [&]() { kernels::groupColumnMoments(matrix, clusterCells, clusterMoments); });
+        runner.run("kernels::rankMarkerGenes", scale, [&]() { kernels::rankMarkerGenes(clusterMoments, 0, clusterMarkers); });
+
+        // --- Computation.cpp
+        std::uniform_real_distribution<float> uniform(-50.0f, 50.0f);
+        std::vector<mv::Vector2f> embedding(scale.numCells);
+        for (auto& point : embedding)
+            point = mv::Vector2f(uniform(generator), uniform(generator));
+
+        std::vector<mv::Vector2f> embeddingCopy;
+        runner.run("normalizeYValues", scale, [&]() { embeddingCopy = embedding; normalizeYValues(embeddingCopy); });
+        runner.run("projectToVerticalAxis", scale, [&]() { embeddingCopy = embedding; projectToVerticalAxis(embeddingCopy, 0.5f); });
+
+        std::vector<float> embeddingPoints, oneDEmbedding;
+        for (const auto& point : embedding)
+            embeddingPoints.insert(embeddingPoints.end(), { point.x, point.y });
+
+        runner.run("kernels::spectralOrdering", scale, [&]() { kernels::spectralOrdering(embeddingPoints, oneDEmbedding); });
+
+        // the lines connect the genes (A) to the cells (B), both axes start in random order
+        std::vector<float> geneValues(scale.numGenes), cellValues(scale.numCells);
+        std::generate(geneValues.begin(), geneValues.end(), [&]() { return uniform(generator); });
+        std::generate(cellValues.begin(), cellValues.end(), [&]() { return uniform(generator); });
+
+        std::vector<std::uint32_t> geneRanks, cellRanks;
+        runner.run("kernels::minimizeCrossings", scale, [&]() {
+            kernels::valueRanks(geneValues, geneRanks);
+            kernels::valueRanks(cellValues, cellRanks);
+            kernels::minimizeCrossings(lines, geneRanks, cellRanks);
+        });
+
+        std::vector<float> scaled;
+        runner.run("scaleDataRange", scale, [&]() { scaleDataRange(means, scaled, false, 10.0f); });
+        runner.run("scaleDataRangeExperiment", scale, [&]() { scaleDataRangeExperiment(means, scaled, false, 10.0f); });
+
+        // --- SampleScopeProcessor.cpp
+        QVector<Cluster> clusters;
+        for (int clusterIndex = 0; clusterIndex < numClusters; clusterIndex++)
+        {
+            Cluster cluster;
+            cluster.setName(QString("Cluster %1").arg(clusterIndex));
+            cluster.setColor(QColor::fromHsv(clusterIndex * 360 / numClusters, 200, 200));
+            cluster.setIndices(std::vector<std::uint32_t>(clusterCells[clusterIndex].begin(), clusterCells[clusterIndex].end()));
+            clusters.append(cluster);
+        }
+
+        std::vector<std::uint32_t> sampledPoints(selectedCells.begin(), selectedCells.end());
+        QStringList labels, counts, colors;
+        runner.run("computeMetadataCounts", scale, [&]() { std::tie(labels, counts, colors) = computeMetadataCounts(clusters, sampledPoints); });
+
+        QStringList geneSymbols;
+        for (std::int64_t gene = 0; gene < scale.numGenes; gene++)
+            geneSymbols.append(QString("Gene%1").arg(gene));
+
+        runner.run("buildSelectionPayload", scale, [&]() { buildSelectionPayload(false, "Cell type", geneSymbols, labels, counts, colors); });
+
+        QVariantList enrichmentResults;
+        for (int term = 0; term < 200; term++)
+        {
+            enrichmentResults.append(QVariantMap{
+                { "Source", "GO:BP" }, { "Term ID", QString("GO:%1").arg(term, 7, 10, QChar('0')) }, { "Term Name", QString("Term %1").arg(term) },
+                { "Padj", 1e-5 * term }, { "Highlight", term % 3 == 0 }, { "Symbol", geneSymbols.mid(term, 20).join(",") } });
+        }
+
+        runner.run("buildEnrichmentPayload", scale, [&]() { buildEnrichmentPayload(enrichmentResults); });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+    QCoreApplication::setApplicationName("DualViewBenchmarks");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless benchmarks for the DualView compute module");
+    parser.addHelpOption();
+
+    QCommandLineOption cellsOption("cells", "Comma separated numbers of cells.", "cells", "10000,100000");
+    QCommandLineOption genesOption("genes", "Comma separated numbers of genes.", "genes", "500,5000");
+    QCommandLineOption densityOption("density", "Fraction of non-zero values in the mostly zero matrices (stored dense).", "density", "0.1");
+    QCommandLineOption repeatsOption("repeats", "Number of timed repetitions per benchmark.", "repeats", "5");
+    QCommandLineOption maxMemoryOption("max-memory-gb", "Skip scales whose matrix would exceed this size.", "gb", "8");
+    QCommandLineOption outputOption("output", "JSON output file, stdout only if empty.", "file", "");
+
+    parser.addOptions({ cellsOption, genesOption, densityOption, repeatsOption, maxMemoryOption, outputOption });
+    parser.process(application);
+
+    const double density = parser.value(densityOption).toDouble();
+    const double maxMemoryBytes = parser.value(maxMemoryOption).toDouble() * 1024.0 * 1024.0 * 1024.0;
+
+    BenchmarkRunner runner(std::max(1, parser.value(repeatsOption).toInt()));
+
+    for (const auto numCells : parseSizes(parser.value(cellsOption)))
+    {
+        for (const auto numGenes : parseSizes(parser.value(genesOption)))
+        {
+            for (const bool mostlyZeros : { false, true })
+            {
+                const Scale scale{ numCells, numGenes, mostlyZeros };
+
+                if (static_cast<double>(numCells) * numGenes * (sizeof(float) + sizeof(std::int16_t)) > maxMemoryBytes)
+                {
+                    runner.skip(scale, "matrix exceeds --max-memory-gb");
+                    continue;
+                }
+
+                benchmarkScale(runner, scale, density);
+            }
+        }
+    }
+
+    QJsonObject report;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+#ifdef _OPENMP
+    report["threads"] = omp_get_max_threads();
+#else
+    report["threads"] = 1;
+#endif
+    report["density"] = density;
+    report["benchmarks"] = runner.getResults();
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    const QString outputFilePath = parser.value(outputOption);
+    if (outputFilePath.isEmpty())
+    {
+        QTextStream(stdout) << json;
+        return 0;
+    }
+
+    QFile outputFile(outputFilePath);
+    if (!outputFile.open(QIODevice::WriteOnly))
+    {
+        QTextStream(stderr) << "Cannot write " << outputFilePath << "\n";
+        return 1;
+    }
+
+    outputFile.write(json);
+
+    return 0;
+}
@@ -0,0 +1,264 @@
+// Renders the sample scope sections from the structured payloads sent by DualViewPlugin.
+// The page is loaded once; every update only patches the DOM nodes whose content changed.
+// The connection is established with the "qtBridge" object registered in DualViewPlugin.
+
+var qtBridge = null;
+
+// Last rendered payload pieces, used to skip DOM updates for unchanged parts
+var rendered = {
+    viewStatus: null,
+    geneLabel: null,
+    genes: null,
+    proportions: null,
+    enrichment: null
+};
+
+const maxGenesShown = 80;
+const maxSymbolsShown = 5;
+const proportionBarWidth = 300;
+const proportionBarHeight = 24;
+
+document.addEventListener("DOMContentLoaded", function () {
+    try {
+        new QWebChannel(qt.webChannelTransport, function (channel) {
+            qtBridge = channel.objects.qtBridge;
+
+            qtBridge.qt_js_setSampleScopeSection.connect(function (section, payload) { setSection(section, payload); });
+
+            // Ask Qt to (re-)send the cached sections
+            qtBridge.js_available();
+        });
+    } catch (error) {
+        console.log("SampleScope: qwebchannel: could not connect qt");
+    }
+});
+
+function setSection(section, payload) {
+    if (section === "Selection")
+        renderSelection(payload);
+    else if (section === "Enrichment")
+        renderEnrichment(payload);
+}
+
+function setVisible(element, visible) {
+    element.classList.toggle("hidden", !visible);
+}
+
+// ---------------------------------------------------------
+// Selection section
+// ---------------------------------------------------------
+function renderSelection(payload) {
+    const container = document.getElementById("selection");
+
+    if (payload == null || Object.keys(payload).length === 0) {
+        setVisible(container, false);
+        return;
+    }
+
+    setVisible(container, true);
+
+    if (payload.viewStatus !== rendered.viewStatus) {
+        document.getElementById("view-status").textContent = payload.viewStatus;
+        rendered.viewStatus = payload.viewStatus;
+    }
+
+    if (payload.geneLabel !== rendered.geneLabel) {
+        document.getElementById("gene-label").textContent = payload.geneLabel;
+        rendered.geneLabel = payload.geneLabel;
+    }
+
+    const genes = (payload.genes || []).join(", ");
+    if (genes !== rendered.genes) {
+        renderGenes(payload.genes || []);
+        rendered.genes = genes;
+    }
+
+    const proportions = JSON.stringify([payload.proportionTitle, payload.proportionHint, payload.proportions || []]);
+    if (proportions !== rendered.proportions) {
+        renderProportions(payload);
+        rendered.proportions = proportions;
+    }
+}
+
+function renderGenes(genes) {
+    const cell = document.getElementById("gene-list");
+
+    cell.textContent = genes.slice(0, maxGenesShown).join(", ");
+
+    if (genes.length > maxGenesShown) {
+        const additional = genes.slice(maxGenesShown);
+        const details = document.createElement("details");
+        const summary = document.createElement("summary");
+        const list = document.createElement("p");
+
+        summary.textContent = "and " + additional.length + " more... (click to expand)";
+        list.style.marginTop = "4px";
+        list.textContent = additional.join(", ");
+
+        details.appendChild(summary);
+        details.appendChild(list);
+        cell.appendChild(details);
+    }
+}
+
+function renderProportions(payload) {
+    const row = document.getElementById("proportion-row");
+    const proportions = payload.proportions || [];
+
+    if (proportions.length === 0) {
+        setVisible(row, false);
+        return;
+    }
+
+    setVisible(row, true);
+
+    document.getElementById("proportion-title").textContent = payload.proportionTitle;
+    document.getElementById("proportion-hint").textContent = payload.proportionHint || "";
+
+    const svgNS = "http://www.w3.org/2000/svg";
+    const svg = document.createElementNS(svgNS, "svg");
+    const legend = document.createElement("ul");
+
+    svg.setAttribute("width", proportionBarWidth);
+    svg.setAttribute("height", proportionBarHeight);
+    svg.style.border = "none";
+    svg.style.borderRadius = "3px";
+    legend.className = "legend";
+
+    let xOffset = 0.0;
+
+    for (const proportion of proportions) {
+        const sliceWidth = proportion.fraction * proportionBarWidth;
+        const rect = document.createElementNS(svgNS, "rect");
+
+        rect.setAttribute("x", xOffset);
+        rect.setAttribute("y", 0);
+        rect.setAttribute("width", sliceWidth);
+        rect.setAttribute("height", proportionBarHeight);
+        rect.setAttribute("fill", proportion.color);
+        rect.setAttribute("stroke", "white");
+        rect.setAttribute("stroke-width", 1);
+        svg.appendChild(rect);
+
+        xOffset += sliceWidth;
+
+        const item = document.createElement("li");
+        const swatch = document.createElement("span");
+
+        swatch.className = "legend-color";
+        swatch.style.backgroundColor = proportion.color;
+        item.appendChild(swatch);
+        item.appendChild(document.createTextNode(proportion.label + " (" + (proportion.fraction * 100.0).toFixed(1) + "%)"));
+        legend.appendChild(item);
+    }
+
+    const chart = document.getElementById("proportion-chart");
+    chart.replaceChildren(svg, legend);
+}
+
+// ---------------------------------------------------------
+// Enrichment section
+// ---------------------------------------------------------
+function renderEnrichment(payload) {
+    const container = document.getElementById("enrichment");
+
+    if (payload == null || Object.keys(payload).length === 0) {
+        setVisible(container, false);
+        rendered.enrichment = null;
+        return;
+    }
+
+    setVisible(container, true);
+
+    const rows = payload.rows || [];
+    const serialized = JSON.stringify(rows);
+
+    if (serialized === rendered.enrichment)
+        return;
+
+    rendered.enrichment = serialized;
+
+    const table = document.getElementById("enrichment-table");
+    const fragment = document.createDocumentFragment();
+
+    if (rows.length === 0) {
+        const header = document.createElement("tr");
+        const cell = document.createElement("th");
+        cell.textContent = "No GO term available";
+        header.appendChild(cell);
+        fragment.appendChild(header);
+        table.replaceChildren(fragment);
+        return;
+    }
+
+    const headers = payload.headers || [];
+    const headerRow = document.createElement("tr");
+
+    for (const header of headers) {
+        const cell = document.createElement("th");
+        cell.textContent = header;
+        headerRow.appendChild(cell);
+    }
+
+    fragment.appendChild(headerRow);
+
+    for (const row of rows) {
+        const tableRow = document.createElement("tr");
+        const termID = row["Term ID"];
+
+        tableRow.className = "term-row";
+        tableRow.addEventListener("click", function () { rowClicked(termID); });
+
+        for (const key of headers)
+            tableRow.appendChild(createEnrichmentCell(key, row[key]));
+
+        fragment.appendChild(tableRow);
+    }
+
+    table.replaceChildren(fragment);
+}
+
+function createEnrichmentCell(key, value) {
+    const cell = document.createElement("td");
+    let text = (value === undefined || value === null) ? "" : value.toString();
+
+    // format Padj 3 decimal places
+    if (key === "Padj") {
+        const pValue = Number(value);
+        if (!isNaN(pValue))
+            text = pValue.toExponential(3);
+    }
+
+    // collapse long symbol list
+    if (key === "Symbol") {
+        const genes = text.split(",");
+        if (genes.length > maxSymbolsShown) {
+            const details = document.createElement("details");
+            const summary = document.createElement("summary");
+            const list = document.createElement("p");
+
+            details.style.display = "inline";
+            details.addEventListener("click", function (event) { event.stopPropagation(); });
+            summary.style.display = "inline";
+            summary.textContent = "and more... ";
+            list.textContent = genes.join(", ");
+
+            details.appendChild(summary);
+            details.appendChild(list);
+
+            cell.appendChild(document.createTextNode(genes.slice(0, maxSymbolsShown).join(", ") + " "));
+            cell.appendChild(details);
+            return cell;
+        }
+    }
+
+    cell.textContent = text;
+    return cell;
+}
+
+function rowClicked(goTermID) {
+    console.log("Clicked GO Term:", goTermID);
+    if (qtBridge) {
+        qtBridge.js_qt_passSelectionToQt(goTermID);
+    }
+}
@@ -1,4 +1,4 @@
-#include "ColoringActionA.h"
+#include "ColoringAction.h"
 #include "src/DualViewPlugin.h"
 #include "src/ScatterplotWidget.h"
 #include "DataHierarchyItem.h"
@@ -11,9 +11,10 @@ using namespace mv::gui;
 
 //const QColor ColoringAction::DEFAULT_CONSTANT_COLOR = qRgb(93, 93, 225);
 
-ColoringActionA::ColoringActionA(QObject* parent, const QString& title) :
+ColoringAction::ColoringAction(QObject* parent, const QString& title) :
     VerticalGroupAction(parent, title),
-    _dualViewPlugin(dynamic_cast<DualViewPlugin*>(parent->parent()))
+    _dualViewPlugin(nullptr),
+    _isA(true)
     //_colorByAction(this, "Color by", { "meta data", "selected genes" })
 
     //_colorByModel(this),  
@@ -39,20 +40,6 @@ ColoringActionA::ColoringActionA(QObject* parent, const QString& title) :
     //_dualViewPlugin->getWidget().addAction(&_dimensionAction);
 
 
-    connect(&_dualViewPlugin->getEmbeddingDatasetA(), &Dataset<Points>::changed, this, [this]() {
-        const auto positionDataset = _dualViewPlugin->getEmbeddingDatasetA();
-
-        if (!positionDataset.isValid())
-            return;
-
-        std::vector<Vector3f> colors(positionDataset->getNumPoints(), Vector3f(93/255.f, 93/255.f, 225/255.f)); // back to default color
-        _dualViewPlugin->getEmbeddingWidgetA().setColors(colors);
-
-        // Optionally, reset the current color dataset if it should no longer be valid
-        _currentColorDataset = Dataset<DatasetImpl>();
-    });
-
-    
     /*connect(&_colorByAction, &OptionAction::currentIndexChanged, this, [this] {
         qDebug() << "_colorByAction.currentIndexChanged to " << _colorByAction.getCurrentText() << _colorByAction.getCurrentIndex();
    
@@ -100,6 +87,30 @@ ColoringActionA::ColoringActionA(QObject* parent, const QString& title) :
 
 }
 
+void ColoringAction::initialize(DualViewPlugin* dualViewPlugin, bool isA)
+{
+    Q_ASSERT(dualViewPlugin != nullptr);
+
+    if (dualViewPlugin == nullptr)
+        return;
+
+    _dualViewPlugin = dualViewPlugin;
+    _isA = isA;
+
+    connect(&_dualViewPlugin->getEmbeddingDataset(_isA), &Dataset<Points>::changed, this, [this]() {
+        const auto positionDataset = _dualViewPlugin->getEmbeddingDataset(_isA);
+
+        if (!positionDataset.isValid())
+            return;
+
+        std::vector<Vector3f> colors(positionDataset->getNumPoints(), Vector3f(93/255.f, 93/255.f, 225/255.f)); // back to default color
+        _dualViewPlugin->getEmbeddingWidget(_isA).setColors(colors);
+
+        // Optionally, reset the current color dataset if it should no longer be valid
+        _currentColorDataset = Dataset<DatasetImpl>();
+    });
+}
+
 //QMenu* ColoringAction::getContextMenu(QWidget* parent /*= nullptr*/)
 //{
 //    auto menu = new QMenu("Color", parent);
@@ -116,16 +127,16 @@ ColoringActionA::ColoringActionA(QObject* parent, const QString& title) :
 //}
 
 
-Dataset<DatasetImpl> ColoringActionA::getCurrentColorDataset() const
+Dataset<DatasetImpl> ColoringAction::getCurrentColorDataset() const
 {
     return _currentColorDataset;
 }
 
-void ColoringActionA::setCurrentColorDataset(const Dataset<DatasetImpl>& colorDataset)
+void ColoringAction::setCurrentColorDataset(const Dataset<DatasetImpl>& colorDataset)
 {
     _currentColorDataset = colorDataset;  // Store the new dataset
 
-    qDebug() << "ColoringActionA: setCurrentColorDataset() " << colorDataset->getGuiName();
+    qDebug() << "ColoringAction" << (_isA ? "A" : "B") << ": setCurrentColorDataset() " << colorDataset->getGuiName();
     
     updateScatterPlotWidgetColors();
 }
@@ -148,47 +159,30 @@ void ColoringActionA::setCurrentColorDataset(const Dataset<DatasetImpl>& colorDa
 //    }
 //}
 
-void ColoringActionA::updateScatterPlotWidgetColors()
+void ColoringAction::updateScatterPlotWidgetColors()
 {
-    qDebug() << "ColoringActionA: updateScatterPlotWidgetColors()";
+    qDebug() << "ColoringAction" << (_isA ? "A" : "B") << ": updateScatterPlotWidgetColors()";
+
+    if (_dualViewPlugin == nullptr)
+        return;
 
     if (!_currentColorDataset.isValid()) {
-        qDebug() << "ColoringActionA: no valid color dataset";
+        qDebug() << "ColoringAction" << (_isA ? "A" : "B") << ": no valid color dataset";
         return;  
     }
 
-    // Mapping from local to global indices
-    std::vector<std::uint32_t> globalIndices;
-
-    auto positionDataset = _dualViewPlugin->getEmbeddingDatasetA();
-
-    // Get global indices from the position dataset
-    int totalNumPoints = 0;
-    if (positionDataset->isDerivedData())
-        totalNumPoints = positionDataset->getSourceDataset<Points>()->getFullDataset<Points>()->getNumPoints();
-    else
-        totalNumPoints = positionDataset->getFullDataset<Points>()->getNumPoints();
-
-    positionDataset->getGlobalIndices(globalIndices);
-
-    // Generate color buffer for global and local colors
-    std::vector<Vector3f> globalColors(totalNumPoints);
-    std::vector<Vector3f> localColors(positionDataset->getNumPoints());
-
-    // Loop over all clusters and populate global colors
-    for (const auto& cluster : _currentColorDataset.get<Clusters>()->getClusters())
-        for (const auto& index : cluster.getIndices())
-            globalColors[index] = Vector3f(cluster.getColor().redF(), cluster.getColor().greenF(), cluster.getColor().blueF());
-    std::int32_t localColorIndex = 0;
+    auto positionDataset = _dualViewPlugin->getEmbeddingDataset(_isA);
+    const Dataset<Clusters> clusterDataset(_currentColorDataset.get<Clusters>());
 
-    // Loop over all global indices and find the corresponding local color
-    for (const auto& globalIndex : globalIndices)
-        localColors[localColorIndex++] = globalColors[globalIndex];
+    // the labels are shared with the 1D embedding colors, only the palette is refreshed when just the cluster colors changed
+    auto& clusterColorCache = _dualViewPlugin->getClusterColorCache(_isA);
+    if (!clusterColorCache.update(clusterDataset, positionDataset, Vector3f(0.0f, 0.0f, 0.0f)))
+        return;
 
-    // Apply colors to scatter plot widget without modification
-    _dualViewPlugin->getEmbeddingWidgetA().setColors(localColors);
+    // the scatterplot only uploads the palette if the labels did not change
+    _dualViewPlugin->getEmbeddingWidget(_isA).setLabels(clusterColorCache.getLabels(), clusterColorCache.getPalette());
 
-    qDebug() << "ColoringAction: set colors A";
+    qDebug() << "ColoringAction: set colors" << (_isA ? "A" : "B");
 }
 
 //void ColoringAction::updateColorMapActionScalarRange()
@@ -321,7 +315,7 @@ void ColoringActionA::updateScatterPlotWidgetColors()
 //    GroupAction::disconnectFromPublicAction(recursive);
 //}
 
-void ColoringActionA::fromVariantMap(const QVariantMap& variantMap)
+void ColoringAction::fromVariantMap(const QVariantMap& variantMap)
 {
     GroupAction::fromVariantMap(variantMap);
 
@@ -332,7 +326,7 @@ void ColoringActionA::fromVariantMap(const QVariantMap& variantMap)
     _colorMap2DAction.fromParentVariantMap(variantMap);*/
 }
 
-QVariantMap ColoringActionA::toVariantMap() const
+QVariantMap ColoringAction::toVariantMap() const
 {
     auto variantMap = GroupAction::toVariantMap();
 
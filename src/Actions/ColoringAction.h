@@ -20,11 +20,11 @@ class DualViewPlugin;
 /**
  * Coloring action class
  *
- * Action class for configuring the coloring of points
+ * Action class for configuring the coloring of the points of embedding A or B
  *
  * @author Thomas Kroes
  */
-class ColoringActionA : public VerticalGroupAction
+class ColoringAction : public VerticalGroupAction
 {
     Q_OBJECT
 
@@ -35,7 +35,14 @@ public:
      * @param parent Pointer to parent object
      * @param title Title
      */
-    Q_INVOKABLE ColoringActionA(QObject* parent, const QString& title);
+    Q_INVOKABLE ColoringAction(QObject* parent, const QString& title);
+
+    /**
+     * Initialize the coloring action with \p dualViewPlugin for embedding A or B
+     * @param dualViewPlugin Pointer to dual view plugin
+     * @param isA Whether the action colors the points of embedding A or of embedding B
+     */
+    void initialize(DualViewPlugin* dualViewPlugin, bool isA);
 
     /**
      * Get the context menu for the action
@@ -129,6 +136,7 @@ public: // Action getters
 
 private:
     DualViewPlugin*         _dualViewPlugin;     /** Pointer to scatter plot plugin */
+    bool                    _isA;                /** Whether the action colors embedding A or embedding B */
 
     Dataset<DatasetImpl>   _currentColorDataset;
     //ColorSourceModel        _colorByModel;          /** Color by model (model input for the color by action) */
@@ -145,6 +153,6 @@ private:
     friend class mv::AbstractActionsManager;
 };
 
-Q_DECLARE_METATYPE(ColoringActionA)
+Q_DECLARE_METATYPE(ColoringAction)
 
-inline const auto coloringActionAMetaTypeId = qRegisterMetaType<ColoringActionA*>("ColoringActionA");
\ No newline at end of file
+inline const auto coloringActionMetaTypeId = qRegisterMetaType<ColoringAction*>("ColoringAction");
\ No newline at end of file
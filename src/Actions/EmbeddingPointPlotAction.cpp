@@ -0,0 +1,40 @@
+#include "EmbeddingPointPlotAction.h"
+#include "src/DualViewPlugin.h"
+
+using namespace mv::gui;
+
+EmbeddingPointPlotAction::EmbeddingPointPlotAction(QObject* parent, const QString& title) :
+    VerticalGroupAction(parent, title),
+    _pointPlotAction(this, title)
+{
+    setIconByName("paint-brush");
+    setToolTip("Point plot settings");
+    setConfigurationFlag(WidgetAction::ConfigurationFlag::ForceCollapsedInGroup);
+    setLabelSizingType(LabelSizingType::Auto);
+
+    addAction(&_pointPlotAction.getSizeAction());
+    addAction(&_pointPlotAction.getOpacityAction());
+    addAction(&_pointPlotAction.getFocusSelection());
+}
+
+void EmbeddingPointPlotAction::initialize(DualViewPlugin* dualViewPlugin, bool isA)
+{
+    _pointPlotAction.initialize(dualViewPlugin, isA);
+}
+
+void EmbeddingPointPlotAction::fromVariantMap(const QVariantMap& variantMap)
+{
+    VerticalGroupAction::fromVariantMap(variantMap);
+
+    _pointPlotAction.fromParentVariantMap(variantMap);
+
+}
+
+QVariantMap EmbeddingPointPlotAction::toVariantMap() const
+{
+    auto variantMap = VerticalGroupAction::toVariantMap();
+
+    _pointPlotAction.insertIntoVariantMap(variantMap);
+
+    return variantMap;
+}
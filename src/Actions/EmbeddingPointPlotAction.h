@@ -12,9 +12,9 @@ class DualViewPlugin;
 /**
  * Point plot action class
  *
- * Action class for point plot settings
+ * Action class for point plot settings of embedding A or B
  */
-class EmbeddingAPointPlotAction : public VerticalGroupAction
+class EmbeddingPointPlotAction : public VerticalGroupAction
 {
     Q_OBJECT
 
@@ -26,7 +26,14 @@ public:
      * @param parent Pointer to parent object
      * @param title Title of the action
      */
-    Q_INVOKABLE EmbeddingAPointPlotAction(QObject* parent, const QString& title);
+    Q_INVOKABLE EmbeddingPointPlotAction(QObject* parent, const QString& title);
+
+    /**
+     * Initialize the point plot action with \p dualViewPlugin for embedding A or B
+     * @param dualViewPlugin Pointer to dual view plugin
+     * @param isA Whether the action configures the points of embedding A or of embedding B
+     */
+    void initialize(DualViewPlugin* dualViewPlugin, bool isA);
 
 
 
@@ -47,14 +54,14 @@ public: // Serialization
 
 public: // Action getters
 
-    PointPlotAction& getPointPlotAction() { return _pointPlotActionA; }
+    PointPlotAction& getPointPlotAction() { return _pointPlotAction; }
 
 
 private:
-    PointPlotAction         _pointPlotActionA;            /** point plot action*/
+    PointPlotAction         _pointPlotAction;            /** point plot action*/
 
 };
 
-Q_DECLARE_METATYPE(EmbeddingAPointPlotAction)
+Q_DECLARE_METATYPE(EmbeddingPointPlotAction)
 
-inline const auto embeddingAPointPlotActionMetaTypeId = qRegisterMetaType<EmbeddingAPointPlotAction*>("EmbeddingAPointPlotAction");
\ No newline at end of file
+inline const auto embeddingPointPlotActionMetaTypeId = qRegisterMetaType<EmbeddingPointPlotAction*>("EmbeddingPointPlotAction");
\ No newline at end of file
@@ -6,7 +6,10 @@ using namespace mv::gui;
 EnrichmentSettingsAction::EnrichmentSettingsAction(QObject* parent, const QString& title) :
     GroupAction(parent, title),
     _organismPickerAction(this, "Organism"),
-    _significanceThresholdMethodAction(this, "Significance Correction Method")
+    _significanceThresholdMethodAction(this, "Significance Correction Method"),
+    _providerAction(this, "Provider"),
+    _geneSetFilePickerAction(this, "Gene Sets (GMT)"),
+    _ontologyFilePickerAction(this, "Ontology (OBO)")
 {
     setIconByName("dna");
     setConfigurationFlag(WidgetAction::ConfigurationFlag::ForceCollapsedInGroup);
@@ -20,6 +23,28 @@ EnrichmentSettingsAction::EnrichmentSettingsAction(QObject* parent, const QStrin
     _significanceThresholdMethodAction.initialize(QStringList({ "g_SCS", "bonferroni", "fdr"}), "bonferroni");
     addAction(&_significanceThresholdMethodAction);
 
+    _providerAction.setToolTip("Run the enrichment analysis with g:Profiler or offline with local gene set files");
+    _providerAction.initialize(QStringList({ "g:Profiler", "Local" }), "g:Profiler");
+    addAction(&_providerAction);
+
+    _geneSetFilePickerAction.setToolTip("Gene set file (GMT) for the local enrichment analysis");
+    _geneSetFilePickerAction.setNameFilters({ "Gene set files (*.gmt)" });
+    addAction(&_geneSetFilePickerAction);
+
+    _ontologyFilePickerAction.setToolTip("Optional GO ontology file (OBO) with the term names for the local enrichment analysis");
+    _ontologyFilePickerAction.setNameFilters({ "Ontology files (*.obo)" });
+    addAction(&_ontologyFilePickerAction);
+
+    const auto updateFilePickers = [this]() -> void {
+        const bool isLocal = _providerAction.getCurrentText() == "Local";
+        _geneSetFilePickerAction.setEnabled(isLocal);
+        _ontologyFilePickerAction.setEnabled(isLocal);
+    };
+
+    updateFilePickers();
+
+    connect(&_providerAction, &OptionAction::currentTextChanged, this, updateFilePickers);
+
     auto plugin = dynamic_cast<DualViewPlugin*>(parent->parent());
     if (plugin == nullptr)
         return;
@@ -32,13 +57,28 @@ EnrichmentSettingsAction::EnrichmentSettingsAction(QObject* parent, const QStrin
         plugin->updateEnrichmentSignificanceThresholdMethod();
         });
 
+    connect(&_providerAction, &OptionAction::currentTextChanged, this, [this, plugin] {
+        plugin->updateEnrichmentProvider();
+        });
+
+    connect(&_geneSetFilePickerAction, &FilePickerAction::filePathChanged, this, [this, plugin] {
+        plugin->updateEnrichmentProvider();
+        });
+
+    connect(&_ontologyFilePickerAction, &FilePickerAction::filePathChanged, this, [this, plugin] {
+        plugin->updateEnrichmentProvider();
+        });
+
 }
 
 void EnrichmentSettingsAction::fromVariantMap(const QVariantMap& variantMap)
 {
     GroupAction::fromVariantMap(variantMap);
     _organismPickerAction.fromParentVariantMap(variantMap);
-    
+    _providerAction.fromParentVariantMap(variantMap);
+    _geneSetFilePickerAction.fromParentVariantMap(variantMap);
+    _ontologyFilePickerAction.fromParentVariantMap(variantMap);
+
 }
 
 QVariantMap EnrichmentSettingsAction::toVariantMap() const
@@ -46,6 +86,9 @@ QVariantMap EnrichmentSettingsAction::toVariantMap() const
     auto variantMap = GroupAction::toVariantMap();
 
     _organismPickerAction.insertIntoVariantMap(variantMap);
+    _providerAction.insertIntoVariantMap(variantMap);
+    _geneSetFilePickerAction.insertIntoVariantMap(variantMap);
+    _ontologyFilePickerAction.insertIntoVariantMap(variantMap);
 
     return variantMap;
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <actions/GroupAction.h>
 #include <actions/OptionAction.h>
+#include <actions/FilePickerAction.h>
 
 using namespace mv::gui;
 
@@ -43,10 +44,16 @@ public: // Action getters
 
     OptionAction& getOrganismPickerAction() { return _organismPickerAction; }
     OptionAction& getSignificanceThresholdMethodAction() { return _significanceThresholdMethodAction; }
+    OptionAction& getProviderAction() { return _providerAction; }
+    FilePickerAction& getGeneSetFilePickerAction() { return _geneSetFilePickerAction; }
+    FilePickerAction& getOntologyFilePickerAction() { return _ontologyFilePickerAction; }
 
 private:
     OptionAction                     _organismPickerAction;          /** Action for choose organism */
     OptionAction                     _significanceThresholdMethodAction;
+    OptionAction                     _providerAction;                /** Action for choosing the enrichment provider (web service or local gene set files) */
+    FilePickerAction                 _geneSetFilePickerAction;       /** Gene set (GMT) file for the local provider */
+    FilePickerAction                 _ontologyFilePickerAction;      /** Optional GO ontology (OBO) file for term names of the local provider */
 
 };
 
@@ -6,7 +6,11 @@ using namespace mv::gui;
 LineSettingsAction::LineSettingsAction(QObject* parent, const QString& title) :
     GroupAction(parent, title),
     _thresholdLinesAction(this, "Background", 0.f, 1.f, 0.9f, 3),
-    _log2FCThreshold(this, "log2FC", 0.f, 5.f, 2.f, 2)
+    _log2FCThreshold(this, "log2FC", 0.f, 5.f, 2.f, 2),
+    _minimizeCrossingsAction(this, "Minimize crossings", false),
+    _testAction(this, "Test"),
+    _fdrThresholdAction(this, "FDR", 0.f, 1.f, 0.05f, 3),
+    _topGenesAction(this, "Top genes", 0, 10000, 500)
 {
     setIconByName("sliders");
     setConfigurationFlag(WidgetAction::ConfigurationFlag::ForceCollapsedInGroup);
@@ -14,9 +18,18 @@ LineSettingsAction::LineSettingsAction(QObject* parent, const QString& title) :
 
     _thresholdLinesAction.setToolTip("Expression threshold for background lines");
     _log2FCThreshold.setToolTip("log2FC Threshold");
+    _minimizeCrossingsAction.setToolTip("Reorder both 1D embeddings to reduce line crossings, the embedding coordinates are kept but assigned to other points");
+    _testAction.setToolTip("Test for the genes that differ between the selected cells and the other cells");
+    _testAction.initialize(QStringList({ "Wilcoxon rank-sum", "Welch t-test" }), "Wilcoxon rank-sum");
+    _fdrThresholdAction.setToolTip("Maximum Benjamini-Hochberg adjusted p value of the genes enriched in a selection");
+    _topGenesAction.setToolTip("Number of genes with the highest test scores that are considered for a selection, 0 for all genes");
 
     addAction(&_thresholdLinesAction);
     addAction(&_log2FCThreshold);
+    addAction(&_minimizeCrossingsAction);
+    addAction(&_testAction);
+    addAction(&_fdrThresholdAction);
+    addAction(&_topGenesAction);
 
     auto plugin = dynamic_cast<DualViewPlugin*>(parent->parent());
     if (plugin == nullptr)
@@ -30,6 +43,22 @@ LineSettingsAction::LineSettingsAction(QObject* parent, const QString& title) :
         plugin->updateLog2FCThreshold();
         });
 
+    connect(&_minimizeCrossingsAction, &ToggleAction::toggled, [this, plugin](bool toggled) {
+        plugin->updateMinimizeCrossings();
+        });
+
+    connect(&_testAction, &OptionAction::currentTextChanged, this, [plugin] {
+        plugin->updateDifferentialExpressionSettings();
+        });
+
+    connect(&_fdrThresholdAction, &DecimalAction::valueChanged, this, [plugin](float val) {
+        plugin->updateDifferentialExpressionSettings();
+        });
+
+    connect(&_topGenesAction, &IntegralAction::valueChanged, this, [plugin](std::int32_t value) {
+        plugin->updateDifferentialExpressionSettings();
+        });
+
 }
 
 void LineSettingsAction::fromVariantMap(const QVariantMap& variantMap)
@@ -37,6 +66,10 @@ void LineSettingsAction::fromVariantMap(const QVariantMap& variantMap)
     GroupAction::fromVariantMap(variantMap);
     _thresholdLinesAction.fromParentVariantMap(variantMap);
     _log2FCThreshold.fromParentVariantMap(variantMap);
+    _minimizeCrossingsAction.fromParentVariantMap(variantMap);
+    _testAction.fromParentVariantMap(variantMap);
+    _fdrThresholdAction.fromParentVariantMap(variantMap);
+    _topGenesAction.fromParentVariantMap(variantMap);
     
 }
 
@@ -46,6 +79,10 @@ QVariantMap LineSettingsAction::toVariantMap() const
 
     _thresholdLinesAction.insertIntoVariantMap(variantMap);
     _log2FCThreshold.insertIntoVariantMap(variantMap);
+    _minimizeCrossingsAction.insertIntoVariantMap(variantMap);
+    _testAction.insertIntoVariantMap(variantMap);
+    _fdrThresholdAction.insertIntoVariantMap(variantMap);
+    _topGenesAction.insertIntoVariantMap(variantMap);
 
     return variantMap;
 }
@@ -1,6 +1,9 @@
 #pragma once
 #include <actions/GroupAction.h>
 #include <actions/DecimalAction.h>
+#include <actions/ToggleAction.h>
+#include <actions/OptionAction.h>
+#include <actions/IntegralAction.h>
 
 using namespace mv::gui;
 
@@ -43,10 +46,18 @@ public: // Action getters
 
     DecimalAction& getThresholdLinesAction() { return _thresholdLinesAction; }
     DecimalAction& getlog2FCThresholdAction() { return _log2FCThreshold; };
+    ToggleAction& getMinimizeCrossingsAction() { return _minimizeCrossingsAction; }
+    OptionAction& getTestAction() { return _testAction; }
+    DecimalAction& getFdrThresholdAction() { return _fdrThresholdAction; }
+    IntegralAction& getTopGenesAction() { return _topGenesAction; }
 
 private:
     DecimalAction                     _thresholdLinesAction;      /** Action for expression value threshold for lines */
     DecimalAction                     _log2FCThreshold;              /** Action for log2FC threshold for lines */
+    ToggleAction                      _minimizeCrossingsAction;      /** Action for reordering the 1D embeddings to reduce line crossings */
+    OptionAction                      _testAction;                   /** Action for the differential expression test of a selection in B */
+    DecimalAction                     _fdrThresholdAction;           /** Action for the adjusted p value threshold of enriched genes */
+    IntegralAction                    _topGenesAction;               /** Action for the number of top genes of a selection in B */
 };
 
 Q_DECLARE_METATYPE(LineSettingsAction)
@@ -0,0 +1,77 @@
+#include "PerformanceSettingsAction.h"
+
+#include "src/DualViewPlugin.h"
+
+#include "src/Compute/PerformanceTrace.h"
+
+#include <QDateTime>
+#include <QFileDialog>
+
+using namespace mv::gui;
+
+PerformanceSettingsAction::PerformanceSettingsAction(QObject* parent, const QString& title) :
+    GroupAction(parent, title),
+    _showHudAction(this, "Show HUD", false),
+    _recordTraceAction(this, "Record trace", false),
+    _exportTraceAction(this, "Export trace"),
+    _clearTraceAction(this, "Clear trace"),
+    _cacheSizeAction(this, "Cache limit (GB)", 0, 256, 4),
+    _clearCacheAction(this, "Clear cache")
+{
+    setIconByName("stopwatch");
+    setConfigurationFlag(WidgetAction::ConfigurationFlag::ForceCollapsedInGroup);
+    setLabelSizingType(LabelSizingType::Auto);
+
+    _showHudAction.setToolTip("Show frame times, drawn points and lines, GPU buffer sizes, selection latency and the last analytics job in the views");
+    _recordTraceAction.setToolTip("Record timings of selections, line generation, GPU uploads, sample scope updates and enrichment requests");
+    _exportTraceAction.setToolTip("Export the recorded trace as Chrome trace JSON (open in chrome://tracing or ui.perfetto.dev)");
+    _clearTraceAction.setToolTip("Discard the recorded trace");
+    _cacheSizeAction.setToolTip("Disk space for line connections and cluster summaries shared by all projects, 0 disables the cache (and the enrichment results on disk)");
+    _clearCacheAction.setToolTip("Remove all cached line connections, cluster summaries and enrichment results from disk");
+
+    addAction(&_showHudAction);
+    addAction(&_recordTraceAction);
+    addAction(&_exportTraceAction);
+    addAction(&_clearTraceAction);
+    addAction(&_cacheSizeAction);
+    addAction(&_clearCacheAction);
+
+    // the HUD and tracing are runtime diagnostics, so their state is deliberately not serialized with the project
+    connect(&_recordTraceAction, &ToggleAction::toggled, this, [](bool toggled) {
+        trace::Tracer::instance().setEnabled(toggled);
+        });
+
+    connect(&_exportTraceAction, &TriggerAction::triggered, this, []() {
+        const QString defaultFileName = QString("DualView_trace_%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+        const QString filePath = QFileDialog::getSaveFileName(nullptr, "Export trace", defaultFileName, "Chrome trace (*.json)");
+
+        if (filePath.isEmpty())
+            return;
+
+        trace::Tracer::instance().exportChromeTrace(filePath);
+        });
+
+    connect(&_clearTraceAction, &TriggerAction::triggered, this, []() {
+        trace::Tracer::instance().clear();
+        });
+
+    auto plugin = dynamic_cast<DualViewPlugin*>(parent->parent());
+    if (plugin == nullptr)
+        return;
+
+    connect(&_showHudAction, &ToggleAction::toggled, this, [plugin](bool toggled) {
+        plugin->setPerformanceHudEnabled(toggled);
+        });
+
+    connect(&_cacheSizeAction, &IntegralAction::valueChanged, this, [this, plugin](std::int32_t value) {
+        plugin->getDerivedStatistics().getDiskCache().setMaxSize(static_cast<qint64>(value) * 1024 * 1024 * 1024);
+        _cacheSizeAction.saveToSettings();
+        });
+
+    // the cache is shared by all projects, so its limit is an application setting instead of part of the project
+    _cacheSizeAction.setSettingsPrefix(plugin, "DerivedDataCache/MaxSizeGB");
+
+    connect(&_clearCacheAction, &TriggerAction::triggered, this, [plugin]() {
+        plugin->getDerivedStatistics().getDiskCache().clear();
+        });
+}
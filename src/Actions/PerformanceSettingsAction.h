@@ -0,0 +1,49 @@
+#pragma once
+#include <actions/GroupAction.h>
+#include <actions/IntegralAction.h>
+#include <actions/ToggleAction.h>
+#include <actions/TriggerAction.h>
+
+using namespace mv::gui;
+
+class DualViewPlugin;
+
+/**
+ * Performance settings action class
+ *
+ * Action class for the performance overlay, for recording and exporting performance traces and for the derived data cache
+ */
+class PerformanceSettingsAction : public GroupAction
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Construct with \p parent and \p title
+     * @param parent Pointer to parent object
+     * @param title Title of the action
+     */
+    Q_INVOKABLE PerformanceSettingsAction(QObject* parent, const QString& title);
+
+public: // Action getters
+
+    ToggleAction& getShowHudAction() { return _showHudAction; }
+    ToggleAction& getRecordTraceAction() { return _recordTraceAction; }
+    TriggerAction& getExportTraceAction() { return _exportTraceAction; }
+    TriggerAction& getClearTraceAction() { return _clearTraceAction; }
+    IntegralAction& getCacheSizeAction() { return _cacheSizeAction; }
+    TriggerAction& getClearCacheAction() { return _clearCacheAction; }
+
+private:
+    ToggleAction                      _showHudAction;             /** Action for showing the performance overlay in the views */
+    ToggleAction                      _recordTraceAction;         /** Action for toggling trace recording */
+    TriggerAction                     _exportTraceAction;         /** Action for exporting the recorded trace as Chrome trace JSON */
+    TriggerAction                     _clearTraceAction;          /** Action for discarding the recorded trace */
+    IntegralAction                    _cacheSizeAction;           /** Action for the size limit of the derived data cache in GB */
+    TriggerAction                     _clearCacheAction;          /** Action for removing all derived data cache artifacts */
+};
+
+Q_DECLARE_METATYPE(PerformanceSettingsAction)
+
+inline const auto performanceSettingsActionMetaTypeId = qRegisterMetaType<PerformanceSettingsAction*>("PerformanceSettingsAction");
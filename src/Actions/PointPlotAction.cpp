@@ -2,6 +2,7 @@
 #include "ScalarSourceAction.h"
 #include "src/DualViewPlugin.h"
 #include "src/ScatterplotWidget.h"
+#include "src/Compute/Computation.h"
 
 #include <DataHierarchyItem.h>
 
@@ -10,10 +11,13 @@ using namespace gui;
 PointPlotAction::PointPlotAction(QObject* parent, const QString& title) :
     VerticalGroupAction(parent, title),
     _dualViewPlugin(nullptr),
+    _isA(true),
     _sizeAction(this, "Point size", 0.0, 100.0, DEFAULT_POINT_SIZE),
     _opacityAction(this, "Point opacity", 0.0, 100.0, DEFAULT_POINT_OPACITY),
     _pointSizeScalars(),
     _pointOpacityScalars(),
+    _pointSizeSelection(),
+    _pointOpacitySelection(),
     _focusSelection(this, "Focus selection"),
     _lastOpacitySourceIndex(-1)
 {
@@ -110,7 +114,7 @@ PointPlotAction::PointPlotAction(QObject* parent, const QString& title) :
     });
 }
 
-void PointPlotAction::initialize(DualViewPlugin* dualViewPlugin)
+void PointPlotAction::initialize(DualViewPlugin* dualViewPlugin, bool isA)
 {
     Q_ASSERT(dualViewPlugin != nullptr);
 
@@ -118,10 +122,11 @@ void PointPlotAction::initialize(DualViewPlugin* dualViewPlugin)
         return;
 
     _dualViewPlugin = dualViewPlugin;
+    _isA = isA;
 
-    connect(&_dualViewPlugin->getEmbeddingDatasetA(), &Dataset<Points>::changed, this, [this]() {
+    connect(&_dualViewPlugin->getEmbeddingDataset(_isA), &Dataset<Points>::changed, this, [this]() {
 
-        const auto positionDataset = _dualViewPlugin->getEmbeddingDatasetA();
+        const auto positionDataset = _dualViewPlugin->getEmbeddingDataset(_isA);
 
         if (!positionDataset.isValid())
             return;
@@ -152,8 +157,15 @@ void PointPlotAction::initialize(DualViewPlugin* dualViewPlugin)
 
     //connect(&_scatterplotPlugin->getPositionDataset(), &Dataset<Points>::childAdded, this, &PointPlotAction::updateDefaultDatasets);
     //connect(&_scatterplotPlugin->getPositionDataset(), &Dataset<Points>::childRemoved, this, &PointPlotAction::updateDefaultDatasets);
-    connect(&_dualViewPlugin->getEmbeddingDatasetA(), &Dataset<Points>::dataSelectionChanged, this, &PointPlotAction::updateScatterPlotWidgetPointSizeScalars);
-    connect(&_dualViewPlugin->getEmbeddingDatasetA(), &Dataset<Points>::dataSelectionChanged, this, &PointPlotAction::updateScatterPlotWidgetPointOpacityScalars);
+
+    // only selection-based scalars depend on the selection
+    connect(&_dualViewPlugin->getEmbeddingDataset(_isA), &Dataset<Points>::dataSelectionChanged, this, [this]() {
+        if (_sizeAction.isSourceSelection())
+            updateScatterPlotWidgetPointSizeScalars();
+
+        if (_opacityAction.isSourceSelection())
+            updateScatterPlotWidgetPointOpacityScalars();
+    });
 
     connect(&_sizeAction, &ScalarAction::magnitudeChanged, this, &PointPlotAction::updateScatterPlotWidgetPointSizeScalars);
     connect(&_sizeAction, &ScalarAction::offsetChanged, this, &PointPlotAction::updateScatterPlotWidgetPointSizeScalars);
@@ -217,7 +229,7 @@ void PointPlotAction::updateDefaultDatasets()
     if (_dualViewPlugin == nullptr)
         return;
 
-    auto positionDataset = Dataset<Points>(_dualViewPlugin->getEmbeddingDatasetA());
+    auto positionDataset = Dataset<Points>(_dualViewPlugin->getEmbeddingDataset(_isA));
 
     if (!positionDataset.isValid())
         return;
@@ -243,65 +255,53 @@ void PointPlotAction::updateScatterPlotWidgetPointSizeScalars()
     if (_dualViewPlugin == nullptr)
         return;
 
-    if (!_dualViewPlugin->getEmbeddingDatasetA().isValid())
+    auto positionDataset = _dualViewPlugin->getEmbeddingDataset(_isA);
+
+    if (!positionDataset.isValid())
         return;
 
-    const auto numberOfPoints = _dualViewPlugin->getEmbeddingDatasetA()->getNumPoints();
+    const auto numberOfPoints = positionDataset->getNumPoints();
 
     if (numberOfPoints != _pointSizeScalars.size())
+    {
         _pointSizeScalars.resize(numberOfPoints);
+        _pointSizeSelection.isValid = false;
+    }
 
-    std::fill(_pointSizeScalars.begin(), _pointSizeScalars.end(), _sizeAction.getMagnitudeAction().getValue());
+    // the action values are read once, not once per point
+    const float magnitude   = _sizeAction.getMagnitudeAction().getValue();
+    const float offset      = _sizeAction.getSourceAction().getOffsetAction().getValue();
 
     if (_sizeAction.isSourceSelection()) {
-        auto positionDataset = _dualViewPlugin->getEmbeddingDatasetA();
-
-        std::fill(_pointSizeScalars.begin(), _pointSizeScalars.end(), _sizeAction.getMagnitudeAction().getValue());
-
-        const auto pointSizeSelectedPoints = _sizeAction.getMagnitudeAction().getValue() + _sizeAction.getSourceAction().getOffsetAction().getValue();
-
-        std::vector<bool> selected;
-
-        positionDataset->selectedLocalIndices(positionDataset->getSelection<Points>()->indices, selected);
-
-        for (size_t i = 0; i < selected.size(); i++) {
-            if (!selected[i])
-                continue;
-
-            _pointSizeScalars[i] = pointSizeSelectedPoints;
-        }
+        updateSelectionScalars(positionDataset, _pointSizeScalars, _pointSizeSelection, magnitude, magnitude + offset);
     }
+    else {
+        _pointSizeSelection.isValid = false;
 
-    if (_sizeAction.isSourceDataset()) {
+        bool mapped = false;
 
-        auto pointSizeSourceDataset = Dataset<Points>(_sizeAction.getCurrentDataset());
+        if (_sizeAction.isSourceDataset()) {
+            auto pointSizeSourceDataset = Dataset<Points>(_sizeAction.getCurrentDataset());
 
-        if (pointSizeSourceDataset.isValid() && pointSizeSourceDataset->getNumPoints() == _dualViewPlugin->getEmbeddingDatasetA()->getNumPoints())
-        {
-            pointSizeSourceDataset->visitData([this, pointSizeSourceDataset, numberOfPoints](auto pointData) {
+            if (pointSizeSourceDataset.isValid() && pointSizeSourceDataset->getNumPoints() == numberOfPoints) {
                 const auto currentDimensionIndex    = _sizeAction.getSourceAction().getDimensionPickerAction().getCurrentDimensionIndex();
-                const auto rangeMin                 = _sizeAction.getSourceAction().getRangeAction().getMinimum();
-                const auto rangeMax                 = _sizeAction.getSourceAction().getRangeAction().getMaximum();
-                const auto rangeLength              = rangeMax - rangeMin;
+                const float rangeMin                = _sizeAction.getSourceAction().getRangeAction().getMinimum();
+                const float rangeMax                = _sizeAction.getSourceAction().getRangeAction().getMaximum();
 
-                if (rangeLength > 0) {
-                    for (std::uint32_t pointIndex = 0; pointIndex < numberOfPoints; pointIndex++) {
-                        auto pointValue = static_cast<float>(pointData[pointIndex][currentDimensionIndex]);
-
-                        const auto pointValueClamped    = std::max(rangeMin, std::min(rangeMax, pointValue));
-                        const auto pointValueNormalized = (pointValueClamped - rangeMin) / rangeLength;
-
-                        _pointSizeScalars[pointIndex] = _sizeAction.getSourceAction().getOffsetAction().getValue() + (pointValueNormalized * _sizeAction.getMagnitudeAction().getValue());
-                    }
-                }
+                if (rangeMax - rangeMin > 0)
+                    mapped = mapDimensionToScalars(pointSizeSourceDataset, currentDimensionIndex, rangeMin, rangeMax, offset, magnitude, _pointSizeScalars);
                 else {
-                    std::fill(_pointSizeScalars.begin(), _pointSizeScalars.end(), _sizeAction.getSourceAction().getOffsetAction().getValue() + (rangeMin * _sizeAction.getMagnitudeAction().getValue()));
+                    std::fill(_pointSizeScalars.begin(), _pointSizeScalars.end(), offset + (rangeMin * magnitude));
+                    mapped = true;
                 }
-            });
+            }
         }
+
+        if (!mapped)
+            std::fill(_pointSizeScalars.begin(), _pointSizeScalars.end(), magnitude);
     }
 
-    _dualViewPlugin->getEmbeddingWidgetA().setPointSizeScalars(_pointSizeScalars);
+    _dualViewPlugin->getEmbeddingWidget(_isA).setPointSizeScalars(_pointSizeScalars);
 }
 
 void PointPlotAction::updateScatterPlotWidgetPointOpacityScalars()
@@ -309,70 +309,86 @@ void PointPlotAction::updateScatterPlotWidgetPointOpacityScalars()
     if (_dualViewPlugin == nullptr)
         return;
 
-    if (!_dualViewPlugin->getEmbeddingDatasetA().isValid())
+    auto positionDataset = _dualViewPlugin->getEmbeddingDataset(_isA);
+
+    if (!positionDataset.isValid())
         return;
 
-    const auto numberOfPoints = _dualViewPlugin->getEmbeddingDatasetA()->getNumPoints();
+    const auto numberOfPoints = positionDataset->getNumPoints();
 
     if (numberOfPoints != _pointOpacityScalars.size())
+    {
         _pointOpacityScalars.resize(numberOfPoints);
+        _pointOpacitySelection.isValid = false;
+    }
 
-    const auto opacityMagnitude = 0.01f * _opacityAction.getMagnitudeAction().getValue();
-
-    std::fill(_pointOpacityScalars.begin(), _pointOpacityScalars.end(), opacityMagnitude);
+    const float opacityMagnitude    = 0.01f * _opacityAction.getMagnitudeAction().getValue();
+    const float opacityOffset       = 0.01f * _opacityAction.getSourceAction().getOffsetAction().getValue();
 
     if (_opacityAction.isSourceSelection()) {
-        auto positionDataset    = _dualViewPlugin->getEmbeddingDatasetA();
-        auto selectionSet       = positionDataset->getSelection<Points>();
-
-        std::fill(_pointOpacityScalars.begin(), _pointOpacityScalars.end(), 0.01f * _opacityAction.getMagnitudeAction().getValue());
-
-        const auto opacityOffset                = 0.01f * _opacityAction.getSourceAction().getOffsetAction().getValue();
-        const auto pointOpacitySelectedPoints   = std::min(1.0f, opacityMagnitude + opacityOffset);
-
-        std::vector<uint32_t> localSelectionIndices;
-        positionDataset->getLocalSelectionIndices(localSelectionIndices);
-
-        for (const auto& selectionIndex : localSelectionIndices)
-            _pointOpacityScalars[selectionIndex] = pointOpacitySelectedPoints;
+        updateSelectionScalars(positionDataset, _pointOpacityScalars, _pointOpacitySelection, opacityMagnitude, std::min(1.0f, opacityMagnitude + opacityOffset));
     }
+    else {
+        _pointOpacitySelection.isValid = false;
 
-    if (_opacityAction.isSourceDataset()) {
-        auto pointOpacitySourceDataset = Dataset<Points>(_opacityAction.getCurrentDataset());
+        bool mapped = false;
 
-        if (pointOpacitySourceDataset.isValid() && pointOpacitySourceDataset->getNumPoints() == _dualViewPlugin->getEmbeddingDatasetA()->getNumPoints()) {
-            pointOpacitySourceDataset->visitData([this, pointOpacitySourceDataset, numberOfPoints, opacityMagnitude](auto pointData) {
+        if (_opacityAction.isSourceDataset()) {
+            auto pointOpacitySourceDataset = Dataset<Points>(_opacityAction.getCurrentDataset());
+
+            if (pointOpacitySourceDataset.isValid() && pointOpacitySourceDataset->getNumPoints() == numberOfPoints) {
+                auto& rangeAction                   = _opacityAction.getSourceAction().getRangeAction();
                 const auto currentDimensionIndex    = _opacityAction.getSourceAction().getDimensionPickerAction().getCurrentDimensionIndex();
-                const auto opacityOffset            = 0.01f * _opacityAction.getSourceAction().getOffsetAction().getValue();
-                const auto rangeMin                 = _opacityAction.getSourceAction().getRangeAction().getMinimum();
-                const auto rangeMax                 = _opacityAction.getSourceAction().getRangeAction().getMaximum();
-                const auto rangeLength              = rangeMax - rangeMin;
-
-                if (rangeLength > 0) {
-                    for (std::uint32_t pointIndex = 0; pointIndex < numberOfPoints; pointIndex++) {
-                        auto pointValue                 = static_cast<float>(pointData[pointIndex][currentDimensionIndex]);
-                        const auto pointValueClamped    = std::max(rangeMin, std::min(rangeMax, pointValue));
-                        const auto pointValueNormalized = (pointValueClamped - rangeMin) / rangeLength;
-
-                        if (opacityOffset == 1.0f)
-                            _pointOpacityScalars[pointIndex] = 1.0f;
-                        else
-                            _pointOpacityScalars[pointIndex] = opacityMagnitude * (opacityOffset + (pointValueNormalized / (1.0f - opacityOffset)));
+                const float rangeMin                = rangeAction.getMinimum();
+                const float rangeMax                = rangeAction.getMaximum();
+
+                if (rangeMax - rangeMin > 0) {
+                    // magnitude * (offset + normalized / (1 - offset)) as base + slope * normalized
+                    if (opacityOffset == 1.0f) {
+                        std::fill(_pointOpacityScalars.begin(), _pointOpacityScalars.end(), 1.0f);
+                        mapped = true;
                     }
+                    else
+                        mapped = mapDimensionToScalars(pointOpacitySourceDataset, currentDimensionIndex, rangeMin, rangeMax, opacityMagnitude * opacityOffset, opacityMagnitude / (1.0f - opacityOffset), _pointOpacityScalars);
                 }
                 else {
-                    auto& rangeAction = _opacityAction.getSourceAction().getRangeAction();
-
                     if (rangeAction.getRangeMinAction().getValue() == rangeAction.getRangeMaxAction().getValue())
                         std::fill(_pointOpacityScalars.begin(), _pointOpacityScalars.end(), 0.0f);
                     else
                         std::fill(_pointOpacityScalars.begin(), _pointOpacityScalars.end(), 1.0f);
+
+                    mapped = true;
                 }
-            });
+            }
         }
+
+        if (!mapped)
+            std::fill(_pointOpacityScalars.begin(), _pointOpacityScalars.end(), opacityMagnitude);
+    }
+
+    _dualViewPlugin->getEmbeddingWidget(_isA).setPointOpacityScalars(_pointOpacityScalars);
+}
+
+void PointPlotAction::updateSelectionScalars(const Dataset<Points>& positionDataset, std::vector<float>& scalars, SelectionScalars& selectionScalars, float unselectedValue, float selectedValue)
+{
+    std::vector<std::uint32_t> localSelectionIndices;
+    positionDataset->getLocalSelectionIndices(localSelectionIndices);
+
+    // the scalars still hold the selection-based values, only the points that were or are selected are rewritten
+    if (selectionScalars.isValid && selectionScalars.unselectedValue == unselectedValue && selectionScalars.selectedValue == selectedValue)
+    {
+        kernels::updateSelectionScalars(scalars, selectionScalars.indices, localSelectionIndices, unselectedValue, selectedValue);
+    }
+    else
+    {
+        std::fill(scalars.begin(), scalars.end(), unselectedValue);
+        kernels::updateSelectionScalars(scalars, {}, localSelectionIndices, unselectedValue, selectedValue);
     }
 
-    _dualViewPlugin->getEmbeddingWidgetA().setPointOpacityScalars(_pointOpacityScalars);
+    selectionScalars.indices            = std::move(localSelectionIndices);
+    selectionScalars.unselectedValue    = unselectedValue;
+    selectionScalars.selectedValue      = selectedValue;
+    selectionScalars.isValid            = true;
 }
 
 void PointPlotAction::connectToPublicAction(WidgetAction* publicAction, bool recursive)
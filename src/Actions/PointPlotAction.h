@@ -4,6 +4,8 @@
 
 #include "ScalarAction.h"
 
+#include <PointData/PointData.h>
+
 class DualViewPlugin;
 
 using namespace mv::gui;
@@ -29,10 +31,11 @@ public:
     Q_INVOKABLE PointPlotAction(QObject* parent, const QString& title);
 
     /**
-     * Initialize the selection action with \p scatterplotPlugin
-     * @param scatterplotPlugin Pointer to scatterplot plugin
+     * Initialize the point plot action with \p dualViewPlugin for embedding A or B
+     * @param dualViewPlugin Pointer to dual view plugin
+     * @param isA Whether the action configures the points of embedding A or of embedding B
      */
-    void initialize(DualViewPlugin* dualViewPlugin);
+    void initialize(DualViewPlugin* dualViewPlugin, bool isA);
 
     /**
      * Get action context menu
@@ -69,6 +72,27 @@ protected:
     /** Update the scatter plot widget point opacity scalars */
     void updateScatterPlotWidgetPointOpacityScalars();
 
+private:
+
+    /** Selection-based scalars, kept so a selection change only rewrites the points that were or are selected */
+    struct SelectionScalars
+    {
+        std::vector<std::uint32_t>  indices;                    /** Local indices of the points that have the selected value */
+        float                       unselectedValue = 0.0f;     /** Value of the points that are not selected */
+        float                       selectedValue = 0.0f;       /** Value of the selected points */
+        bool                        isValid = false;            /** Whether the scalars hold the selection-based values */
+    };
+
+    /**
+     * Set \p scalars to \p selectedValue for the selected points of \p positionDataset and to \p unselectedValue otherwise
+     * @param positionDataset Dataset with the selection
+     * @param scalars Scalar per point
+     * @param selectionScalars Selection the scalars were last updated for
+     * @param unselectedValue Value of the points that are not selected
+     * @param selectedValue Value of the selected points
+     */
+    void updateSelectionScalars(const Dataset<Points>& positionDataset, std::vector<float>& scalars, SelectionScalars& selectionScalars, float unselectedValue, float selectedValue);
+
 protected: // Linking
 
     /**
@@ -106,10 +130,13 @@ public: // Action getters
 
 private:
     DualViewPlugin*         _dualViewPlugin;        
+    bool                    _isA;                       /** Whether the action configures embedding A or embedding B */
     ScalarAction            _sizeAction;                /** Point size action */
     ScalarAction            _opacityAction;             /** Point opacity action */
     std::vector<float>      _pointSizeScalars;          /** Cached point size scalars */
     std::vector<float>      _pointOpacityScalars;       /** Cached point opacity scalars */
+    SelectionScalars        _pointSizeSelection;        /** Selection the point size scalars were last updated for */
+    SelectionScalars        _pointOpacitySelection;     /** Selection the point opacity scalars were last updated for */
     ToggleAction            _focusSelection;            /** Focus selection action */
     std::int32_t            _lastOpacitySourceIndex;    /** Last opacity source index that was selected */
 
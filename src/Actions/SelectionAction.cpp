@@ -11,7 +11,8 @@ using namespace mv::gui;
 
 SelectionAction::SelectionAction(QObject* parent, const QString& title) :
     GroupAction(parent, title),
-    _pixelSelectionAction(this, "Point Selection"),
+    _isA(true),
+    _pixelSelectionAction(this, "Point " + title),
     _samplerPixelSelectionAction(this, "Sampler selection")
     //_displayModeAction(this, "Display mode", { "Outline", "Override" }),
     //_outlineOverrideColorAction(this, "Custom color", true),
@@ -57,14 +58,16 @@ SelectionAction::SelectionAction(QObject* parent, const QString& title) :
     connect(&_outlineOverrideColorAction, &ToggleAction::toggled, this, updateActionsReadOnly);*/
 }
 
-void SelectionAction::initialize(DualViewPlugin* dualViewPlugin)
+void SelectionAction::initialize(DualViewPlugin* dualViewPlugin, bool isA)
 {
     Q_ASSERT(dualViewPlugin != nullptr);
 
     if (dualViewPlugin == nullptr)
         return;
 
-    auto& scatterplotWidget = dualViewPlugin->getEmbeddingWidgetA();
+    _isA = isA;
+
+    auto& scatterplotWidget = dualViewPlugin->getEmbeddingWidget(_isA);
 
     getPixelSelectionAction().initialize(&scatterplotWidget, &scatterplotWidget.getPixelSelectionTool(), {
         PixelSelectionType::Rectangle,
@@ -73,9 +76,13 @@ void SelectionAction::initialize(DualViewPlugin* dualViewPlugin)
         PixelSelectionType::Polygon
     });
 
-    getSamplerPixelSelectionAction().initialize(&scatterplotWidget, &scatterplotWidget.getSamplerPixelSelectionTool(), {
-        PixelSelectionType::Sample
-    });
+    // the sampler is only implemented for embedding A
+    if (_isA)
+        getSamplerPixelSelectionAction().initialize(&scatterplotWidget, &scatterplotWidget.getSamplerPixelSelectionTool(), {
+            PixelSelectionType::Sample
+        });
+    else
+        scatterplotWidget.getSamplerPixelSelectionTool().setEnabled(false);
 
 
     //_displayModeAction.setCurrentIndex(static_cast<std::int32_t>(scatterplotPlugin->getScatterplotWidget().getSelectionDisplayMode()));
@@ -86,18 +93,18 @@ void SelectionAction::initialize(DualViewPlugin* dualViewPlugin)
     //_outlineOverrideColorAction.setChecked(scatterplotPlugin->getScatterplotWidget().getSelectionOutlineOverrideColor());
 
     connect(&_pixelSelectionAction.getSelectAllAction(), &QAction::triggered, [this, dualViewPlugin]() {
-        if (dualViewPlugin->getEmbeddingDatasetA().isValid())
-            dualViewPlugin->getEmbeddingDatasetA()->selectAll();
+        if (dualViewPlugin->getEmbeddingDataset(_isA).isValid())
+            dualViewPlugin->getEmbeddingDataset(_isA)->selectAll();
     });
 
     connect(&_pixelSelectionAction.getClearSelectionAction(), &QAction::triggered, this, [this, dualViewPlugin]() {
-        if (dualViewPlugin->getEmbeddingDatasetA().isValid())
-            dualViewPlugin->getEmbeddingDatasetA()->selectNone();
+        if (dualViewPlugin->getEmbeddingDataset(_isA).isValid())
+            dualViewPlugin->getEmbeddingDataset(_isA)->selectNone();
     });
 
     connect(&_pixelSelectionAction.getInvertSelectionAction(), &QAction::triggered, this, [this, dualViewPlugin]() {
-        if (dualViewPlugin->getEmbeddingDatasetA().isValid())
-            dualViewPlugin->getEmbeddingDatasetA()->selectInvert();
+        if (dualViewPlugin->getEmbeddingDataset(_isA).isValid())
+            dualViewPlugin->getEmbeddingDataset(_isA)->selectInvert();
     });
 
     /*connect(&_outlineScaleAction, &DecimalAction::valueChanged, this, [this, scatterplotPlugin](float value) {
@@ -125,13 +132,13 @@ void SelectionAction::initialize(DualViewPlugin* dualViewPlugin)
     });*/
 
     const auto updateReadOnly = [this, dualViewPlugin]() -> void {
-        qDebug() << "updateReadOnly selectionAction";
-        setEnabled(dualViewPlugin->getEmbeddingDatasetA().isValid());
+        qDebug() << "updateReadOnly selectionAction" << (_isA ? "A" : "B");
+        setEnabled(dualViewPlugin->getEmbeddingDataset(_isA).isValid());
     };
 
     updateReadOnly();
 
-    connect(&dualViewPlugin->getEmbeddingDatasetA(), &Dataset<Points>::changed, this, updateReadOnly);
+    connect(&dualViewPlugin->getEmbeddingDataset(_isA), &Dataset<Points>::changed, this, updateReadOnly);
 }
 
 //void SelectionAction::connectToPublicAction(WidgetAction* publicAction, bool recursive)
@@ -177,7 +184,10 @@ void SelectionAction::fromVariantMap(const QVariantMap& variantMap)
     GroupAction::fromVariantMap(variantMap);
 
     _pixelSelectionAction.fromParentVariantMap(variantMap);
-    _samplerPixelSelectionAction.fromParentVariantMap(variantMap);
+
+    if (_isA)
+        _samplerPixelSelectionAction.fromParentVariantMap(variantMap);
+
     //_displayModeAction.fromParentVariantMap(variantMap);
     //_outlineOverrideColorAction.fromParentVariantMap(variantMap);
     //_outlineScaleAction.fromParentVariantMap(variantMap);
@@ -190,7 +200,10 @@ QVariantMap SelectionAction::toVariantMap() const
     auto variantMap = GroupAction::toVariantMap();
 
     _pixelSelectionAction.insertIntoVariantMap(variantMap);
-    _samplerPixelSelectionAction.insertIntoVariantMap(variantMap);
+
+    if (_isA)
+        _samplerPixelSelectionAction.insertIntoVariantMap(variantMap);
+
     //_displayModeAction.insertIntoVariantMap(variantMap);
     //_outlineOverrideColorAction.insertIntoVariantMap(variantMap);
     //_outlineScaleAction.insertIntoVariantMap(variantMap);
@@ -22,10 +22,11 @@ public:
     Q_INVOKABLE SelectionAction(QObject* parent, const QString& title);
 
     /**
-     * Initialize the selection action with \p scatterplotPlugin
-     * @param scatterplotPlugin Pointer to scatterplot plugin
+     * Initialize the selection action with \p dualViewPlugin for embedding A or B
+     * @param dualViewPlugin Pointer to dual view plugin
+     * @param isA Whether the action selects the points of embedding A or of embedding B
      */
-    void initialize(DualViewPlugin* scatterplotPlugin);
+    void initialize(DualViewPlugin* dualViewPlugin, bool isA);
 
 protected: // Linking
 
@@ -67,6 +68,7 @@ public: // Action getters
     //ToggleAction& getOutlineHaloEnabledAction() { return _outlineHaloEnabledAction; }
 
 private:
+    bool                    _isA;                           /** Whether the action selects in embedding A or embedding B */
     PixelSelectionAction    _pixelSelectionAction;          /** Pixel selection action */
     PixelSelectionAction    _samplerPixelSelectionAction;   /** Pixel selection action */
     //OptionAction            _displayModeAction;             /** Type of selection display (e.g. outline or override) */
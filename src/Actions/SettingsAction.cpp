@@ -22,15 +22,23 @@ SettingsAction::SettingsAction(QObject* parent, const QString& title) :
     _dimensionSelectionAction(this, "Gene search"),
     _enrichmentAction(this, "Enrich"),
     _enrichmentSettingsAction(this, "Enrichment settings"),
-    _selectionActionB(this, "Selection B")
+    _selectionActionB(this, "Selection B"),
+    _performanceSettingsAction(this, "Performance")
 {
     setConnectionPermissionsToForceNone();
 
     _currentDatasetsAction.initialize(_dualViewPlugin);
 
-    _selectionAction.initialize(_dualViewPlugin);
+    // the actions of both embeddings share one implementation, parameterized by the embedding they configure
+    _embeddingAPointPlotAction.initialize(_dualViewPlugin, true);
+    _embeddingBPointPlotAction.initialize(_dualViewPlugin, false);
 
-    _selectionActionB.initialize(_dualViewPlugin);
+    _coloringActionA.initialize(_dualViewPlugin, true);
+    _coloringActionB.initialize(_dualViewPlugin, false);
+
+    _selectionAction.initialize(_dualViewPlugin, true);
+
+    _selectionActionB.initialize(_dualViewPlugin, false);
 
     connect(&_reversePointSizeBAction, &ToggleAction::toggled, [this](bool val) {
 		_dualViewPlugin->reversePointSizeB(val);
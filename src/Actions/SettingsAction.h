@@ -5,14 +5,12 @@
 #include <actions/ToggleAction.h>
 
 
-#include "EmbeddingAPointPlotAction.h"
+#include "EmbeddingPointPlotAction.h"
 
 //#include "PointPlotAction.h"
 
 
-#include "EmbeddingBPointPlotAction.h"
-#include "ColoringActionB.h"
-#include "ColoringActionA.h" // TODO: combine coloring actions for embedding A and B
+#include "ColoringAction.h"
 #include "SelectionAction.h"
 #include "LoadedDatasetsAction.h"
 
@@ -20,9 +18,8 @@
 #include "EnrichmentAction.h"
 #include "EnrichmentSettingsAction.h"
 
-#include "SelectionActionB.h"
-
 #include "LineSettingsAction.h"
+#include "PerformanceSettingsAction.h"
 
 using namespace mv::gui;
 
@@ -68,15 +65,15 @@ public: // Serialization
 
 public: // Action getters
     
-    EmbeddingAPointPlotAction& getEmbeddingAPointPlotAction() { return _embeddingAPointPlotAction; }
-    EmbeddingBPointPlotAction& getEmbeddingBPointPlotAction() { return _embeddingBPointPlotAction; }
+    EmbeddingPointPlotAction& getEmbeddingAPointPlotAction() { return _embeddingAPointPlotAction; }
+    EmbeddingPointPlotAction& getEmbeddingBPointPlotAction() { return _embeddingBPointPlotAction; }
     LineSettingsAction& getLineSettingsAction() { return _lineSettingsAction; }
 
-    ColoringActionB& getColoringActionB() { return _coloringActionB; }
-    ColoringActionA& getColoringActionA() { return _coloringActionA; }
+    ColoringAction& getColoringActionB() { return _coloringActionB; }
+    ColoringAction& getColoringActionA() { return _coloringActionA; }
     SelectionAction& getSelectionAction() { return _selectionAction; }
 
-    SelectionActionB& getSelectionActionB() { return _selectionActionB; }
+    SelectionAction& getSelectionActionB() { return _selectionActionB; }
 
     // experimental actions
     ToggleAction& getReversePointSizeBAction() { return _reversePointSizeBAction; }
@@ -84,18 +81,19 @@ public: // Action getters
 
     EnrichmentAction& getEnrichmentAction() { return _enrichmentAction; }
     EnrichmentSettingsAction& getEnrichmentSettingsAction() { return _enrichmentSettingsAction; }
+    PerformanceSettingsAction& getPerformanceSettingsAction() { return _performanceSettingsAction; }
    
 
 protected:
     DualViewPlugin*                   _dualViewPlugin;         /** Pointer to dual view plugin */
 
     LoadedDatasetsAction			  _currentDatasetsAction;    /** Action for managing loaded datasets */
-    EmbeddingAPointPlotAction         _embeddingAPointPlotAction;           /** Action for configuring point plots */
-    EmbeddingBPointPlotAction         _embeddingBPointPlotAction;           /** Action for configuring point plots */
+    EmbeddingPointPlotAction          _embeddingAPointPlotAction;           /** Action for configuring point plots - for embedding A*/
+    EmbeddingPointPlotAction          _embeddingBPointPlotAction;           /** Action for configuring point plots - for embedding B*/
     LineSettingsAction               _lineSettingsAction;          /** Action for line settings */
 
-    ColoringActionB                   _coloringActionB;            /** Action for configuring point coloring - for embedding B*/
-    ColoringActionA                   _coloringActionA;           /** Action for configuring point coloring - for embedding A*/
+    ColoringAction                    _coloringActionB;            /** Action for configuring point coloring - for embedding B*/
+    ColoringAction                    _coloringActionA;           /** Action for configuring point coloring - for embedding A*/
     SelectionAction                   _selectionAction;           /** Action for configuring selection */
 
     // experimental actions
@@ -105,6 +103,7 @@ protected:
     EnrichmentAction                  _enrichmentAction;          /** Action for triggering enrichment analysis */
     EnrichmentSettingsAction		  _enrichmentSettingsAction;  /** Action for configuring enrichment settings */
 
-    // FIXME: should be moved into the SelectionAction class - this is a temp fix
-    SelectionActionB                  _selectionActionB;          /** Action for configuring selection - for embedding B*/
+    SelectionAction                   _selectionActionB;          /** Action for configuring selection - for embedding B*/
+
+    PerformanceSettingsAction         _performanceSettingsAction; /** Action for recording performance traces */
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "widgets/WebWidget.h"
 
 #include <QVariantList>
+#include <QVariantMap>
 
 Q_DECLARE_METATYPE(QVariantList)
 
@@ -24,6 +25,10 @@ signals:
     // But other communication like messaging selection IDs can be handled the same
     void qt_js_setDataAndPlotInJS(const QVariantList& data);
 
+    // Used to push a single sample scope section (e.g. "Selection" or "Enrichment") to res/sample_scope/sample_scope.html
+    // An empty payload hides the section on the JS side
+    void qt_js_setSampleScopeSection(const QString& section, const QVariantMap& payload);
+
     // Signals Qt internal
     // Used to inform the plugin about new selection: the plugin class then updates ManiVault's core
     void passSelectionToCore(const std::vector<unsigned int>& selectionIDs);
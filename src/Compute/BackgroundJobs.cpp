@@ -0,0 +1,69 @@
+#include "BackgroundJobs.h"
+
+#include "PerformanceTrace.h"
+
+#include <QDebug>
+#include <QThread>
+
+BackgroundJobs::BackgroundJobs(QObject* parent) :
+    QObject(parent),
+    _jobs(),
+    _jobId(0)
+{
+}
+
+BackgroundJobs::~BackgroundJobs()
+{
+    // the kernels check their flags, so waiting only lasts until their next check instead of until the end of the job
+    for (const RunningJob& job : _jobs)
+        job.cancelled->store(true);
+
+    // the finished connections of the threads are removed with this object, so no result is published anymore
+    for (const RunningJob& job : _jobs)
+    {
+        job.thread->wait();
+        delete job.thread;
+    }
+}
+
+void BackgroundJobs::start(int lane, const char* name, Job job)
+{
+    cancel(lane);
+
+    const quint64 jobId = ++_jobId;
+
+    auto cancelled = std::make_shared<kernels::CancelFlag>(false);
+    auto publish = std::make_shared<Publish>();
+
+    trace::beginAsync(name, jobId);
+
+    QThread* thread = QThread::create([job = std::move(job), cancelled, publish]() {
+        *publish = job(*cancelled);
+    });
+
+    _jobs.push_back({ thread, lane, cancelled });
+
+    connect(thread, &QThread::finished, this, [this, thread, name, jobId, cancelled, publish]() {
+        trace::endAsync(name, jobId);
+
+        std::erase_if(_jobs, [thread](const RunningJob& job) { return job.thread == thread; });
+        thread->deleteLater();
+
+        if (cancelled->load() || !*publish)
+        {
+            qDebug() << "BackgroundJobs: discarded the result of a cancelled job," << name;
+            return;
+        }
+
+        (*publish)();
+    });
+
+    thread->start(QThread::LowPriority);
+}
+
+void BackgroundJobs::cancel(int lane)
+{
+    for (const RunningJob& job : _jobs)
+        if (job.lane == lane)
+            job.cancelled->store(true);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ComputeKernels.h"
+
+#include <QObject>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QThread;
+
+// Worker threads of the compute engines (1D embeddings, line layout, cluster markers)
+// Jobs run in lanes: starting a job cancels the running job of its lane, so only the latest job of a lane is published
+// A job gets a cancel flag to pass on to its kernels, a cancelled job returns at the next check of its kernel instead of
+// running to the end, so superseded jobs do not pile up. The publish function returned by a job is called on the thread
+// of this object, unless the job was cancelled in the meantime
+class BackgroundJobs : public QObject
+{
+public:
+    using Publish = std::function<void()>;
+    using Job = std::function<Publish(const kernels::CancelFlag& cancelled)>;
+
+    explicit BackgroundJobs(QObject* parent = nullptr);
+
+    // cancels all jobs and waits until their kernels returned, their results are discarded
+    ~BackgroundJobs() override;
+
+    // start a job in a lane, cancels the running job of that lane, name (a string literal) labels the job in the trace
+    void start(int lane, const char* name, Job job);
+
+    // cancel the running job of a lane, its result is discarded
+    void cancel(int lane);
+
+private:
+    struct RunningJob
+    {
+        QThread*                                thread;
+        int                                     lane;
+        std::shared_ptr<kernels::CancelFlag>    cancelled;
+    };
+
+    std::vector<RunningJob>     _jobs;          // running jobs, only the latest one of a lane is not cancelled
+    quint64                     _jobId;         // id of the latest job, matches the begin and end of its trace span
+};
@@ -0,0 +1,105 @@
+#include "ClusterColorCache.h"
+
+#include "ComputeKernels.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <span>
+
+ClusterColorCache::ClusterColorCache() :
+    _clusterDatasetId(),
+    _positionDatasetId(),
+    _labelsKey(0),
+    _labels(),
+    _palette()
+{
+}
+
+bool ClusterColorCache::update(const mv::Dataset<Clusters>& clusterDataset, const mv::Dataset<Points>& positionDataset, const mv::Vector3f& unlabeledColor)
+{
+    if (!clusterDataset.isValid() || !positionDataset.isValid())
+        return false;
+
+    const std::uint64_t labelsKey = computeLabelsKey(clusterDataset, positionDataset);
+
+    if (clusterDataset->getId() != _clusterDatasetId || positionDataset->getId() != _positionDatasetId || labelsKey != _labelsKey)
+    {
+        updateLabels(clusterDataset, positionDataset);
+
+        _clusterDatasetId = clusterDataset->getId();
+        _positionDatasetId = positionDataset->getId();
+        _labelsKey = labelsKey;
+    }
+
+    // the palette is cheap, it is always taken from the current cluster colors
+    const auto& clusters = clusterDataset->getClusters();
+
+    _palette.resize(clusters.size() + 1);
+
+    for (qsizetype clusterIndex = 0; clusterIndex < clusters.size(); clusterIndex++)
+    {
+        const QColor color = clusters[clusterIndex].getColor();
+        _palette[clusterIndex] = mv::Vector3f(color.redF(), color.greenF(), color.blueF());
+    }
+
+    _palette.back() = unlabeledColor;
+
+    return true;
+}
+
+void ClusterColorCache::clear()
+{
+    _clusterDatasetId.clear();
+    _positionDatasetId.clear();
+    _labelsKey = 0;
+    _labels.clear();
+    _palette.clear();
+}
+
+std::uint64_t ClusterColorCache::computeLabelsKey(const mv::Dataset<Clusters>& clusterDataset, const mv::Dataset<Points>& positionDataset)
+{
+    std::uint64_t key = static_cast<std::uint64_t>(positionDataset->getNumPoints());
+
+    // the cluster indices are hashed with the fast parallel kernel, which is cheaper than rebuilding the labels
+    for (const auto& cluster : clusterDataset->getClusters())
+    {
+        const auto& indices = cluster.getIndices();
+        const std::uint64_t clusterHash = kernels::hashBytes(std::as_bytes(std::span<const std::uint32_t>(indices.data(), indices.size())));
+
+        key = (key ^ clusterHash) * 0x100000001b3ULL + static_cast<std::uint64_t>(indices.size());
+    }
+
+    return key;
+}
+
+void ClusterColorCache::updateLabels(const mv::Dataset<Clusters>& clusterDataset, const mv::Dataset<Points>& positionDataset)
+{
+    const auto& clusters = clusterDataset->getClusters();
+    const std::uint32_t unlabeled = static_cast<std::uint32_t>(clusters.size());
+
+    const std::int64_t totalNumPoints = positionDataset->isDerivedData()
+        ? positionDataset->getSourceDataset<Points>()->getFullDataset<Points>()->getNumPoints()
+        : positionDataset->getFullDataset<Points>()->getNumPoints();
+
+    // scatter the cluster of every global index, then gather the local points
+    std::vector<std::uint32_t> globalLabels(totalNumPoints, unlabeled);
+
+    for (std::uint32_t clusterIndex = 0; clusterIndex < unlabeled; clusterIndex++)
+        for (const auto& index : clusters[clusterIndex].getIndices())
+            if (index < globalLabels.size())
+                globalLabels[index] = clusterIndex;
+
+    std::vector<std::uint32_t> globalIndices;
+    positionDataset->getGlobalIndices(globalIndices);
+
+    _labels.assign(positionDataset->getNumPoints(), unlabeled);
+
+    const std::int64_t numLabels = static_cast<std::int64_t>(std::min(globalIndices.size(), _labels.size()));
+
+#pragma omp parallel for
+    for (std::int64_t i = 0; i < numLabels; i++)
+        _labels[i] = globalIndices[i] < globalLabels.size() ? globalLabels[globalIndices[i]] : unlabeled;
+
+    qDebug() << "ClusterColorCache: labels of" << _labels.size() << "points rebuilt for" << clusters.size() << "clusters";
+}
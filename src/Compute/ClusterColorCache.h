@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ClusterData/ClusterData.h>
+#include <Dataset.h>
+#include <PointData/PointData.h>
+
+#include "graphics/Vector3f.h"
+
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+// Cluster colors of the points of a position dataset, stored as a cluster label per point and a color per cluster
+// The labels are only rebuilt when the cluster indices or the position dataset change, so recoloring clusters
+// only touches the palette, which the point renderers upload as color map
+// One cache is shared by all views that color the same position dataset by the same clusters
+class ClusterColorCache
+{
+public:
+    ClusterColorCache();
+
+    // cluster index per point of the position dataset (numClusters for points in no cluster) and the color per cluster,
+    // valid after update()
+    const std::vector<std::uint32_t>& getLabels() const { return _labels; }
+    const std::vector<mv::Vector3f>& getPalette() const { return _palette; }
+
+    // bring the labels and the palette up to date, returns false if the datasets are invalid
+    bool update(const mv::Dataset<Clusters>& clusterDataset, const mv::Dataset<Points>& positionDataset, const mv::Vector3f& unlabeledColor);
+
+    void clear();
+
+private:
+    // identifies the cluster indices and the points of the position dataset
+    static std::uint64_t computeLabelsKey(const mv::Dataset<Clusters>& clusterDataset, const mv::Dataset<Points>& positionDataset);
+
+    void updateLabels(const mv::Dataset<Clusters>& clusterDataset, const mv::Dataset<Points>& positionDataset);
+
+private:
+    QString                         _clusterDatasetId;      // cluster dataset of the labels
+    QString                         _positionDatasetId;     // position dataset of the labels
+    std::uint64_t                   _labelsKey;             // key of the cluster indices and points the labels were built for
+    std::vector<std::uint32_t>      _labels;                // cluster index per local point
+    std::vector<mv::Vector3f>       _palette;               // color per cluster, followed by the color of unlabeled points
+};
@@ -1,6 +1,6 @@
 #include "Computation.h"
 
-void normalizeYValues(std::vector<mv::Vector2f>& embedding)
+void normalizeYValues(std::span<mv::Vector2f> embedding)
 {
     float min_y = std::numeric_limits<float>::max();
     float max_y = std::numeric_limits<float>::lowest();
@@ -16,7 +16,7 @@ void normalizeYValues(std::vector<mv::Vector2f>& embedding)
     }
 }
 
-void projectToVerticalAxis(std::vector<mv::Vector2f>& embeddings, float x_value)
+void projectToVerticalAxis(std::span<mv::Vector2f> embeddings, float x_value)
 {
     for (auto& point : embeddings) {
         point.x = x_value;  // Set x-coordinate to the specified value
@@ -101,6 +101,53 @@ void scaleDataRangeExperiment(const std::vector<float>& input, std::vector<float
     }
 }
 
+QImage createPaletteImage(const std::vector<mv::Vector3f>& palette)
+{
+    QImage image(std::max<int>(1, static_cast<int>(palette.size())), 1, QImage::Format_ARGB32);
+    image.fill(Qt::black);
+
+    for (int i = 0; i < static_cast<int>(palette.size()); i++)
+        image.setPixelColor(i, 0, QColor::fromRgbF(palette[i].x, palette[i].y, palette[i].z));
+
+    return image;
+}
+
+void labelsToScalars(std::span<const std::uint32_t> labels, float labelOffset, std::span<float> scalars)
+{
+    const std::int64_t numLabels = static_cast<std::int64_t>(std::min(labels.size(), scalars.size()));
+
+#pragma omp parallel for
+    for (std::int64_t i = 0; i < numLabels; i++)
+        scalars[i] = labelOffset + static_cast<float>(labels[i]);
+}
+
+bool mapDimensionToScalars(const mv::Dataset<Points>& dataset, std::int32_t dimension, float rangeMin, float rangeMax, float base, float slope, std::vector<float>& scalars)
+{
+    if (!dataset.isValid() || dimension < 0 || dimension >= static_cast<std::int32_t>(dataset->getNumDimensions()))
+        return false;
+
+    const std::int64_t numPoints = static_cast<std::int64_t>(scalars.size());
+
+    if (static_cast<std::int64_t>(dataset->getNumPoints()) != numPoints || !(rangeMax > rangeMin))
+        return false;
+
+    // the raw data of a full dataset is the point matrix, so the column is read in place
+    if (dataset->isFull())
+    {
+        return visitExpressionMatrix(dataset, numPoints, [&](const auto& matrix) {
+            kernels::mapScalars(kernels::columnView(matrix, dimension), rangeMin, rangeMax, base, slope, std::span<float>(scalars));
+        });
+    }
+
+    // the points of a subset are scattered over the raw data of its source
+    std::vector<float> values;
+    dataset->extractDataForDimension(values, dimension);
+
+    kernels::mapScalars(kernels::StridedView<float>(std::span<const float>(values), static_cast<std::int64_t>(values.size())), rangeMin, rangeMax, base, slope, std::span<float>(scalars));
+
+    return true;
+}
+
 void computeDataRange(const mv::Dataset<Points> dataset, std::vector<float>& columnMins, std::vector<float>& columnRanges)
 {
     if (!dataset.isValid())
@@ -114,34 +161,17 @@ void computeDataRange(const mv::Dataset<Points> dataset, std::vector<float>& col
 
     // define lines - assume embedding A is dimension embedding, embedding B is observation embedding
     int64_t numDimensions = dataset->getNumDimensions(); // Assume the number of points in A is the same as the number of dimensions in B
-    int64_t numDimensionsFull = dataset->getNumDimensions();
     int64_t numPoints = dataset->getNumPoints(); // num of points in source dataset B
 
-    std::vector<std::uint32_t> localGlobalIndicesB;
-    dataset->getGlobalIndices(localGlobalIndicesB);
-
-    columnMins.resize(numDimensions);
-    columnRanges.resize(numDimensions);
-
     // Find the minimum value in each column - attention! this is the minimum of the subset (if HSNE)
-#pragma omp parallel for
-    for (int64_t dimIdx = 0; dimIdx < numDimensions; dimIdx++)
-    {
-
-        float minValue = std::numeric_limits<float>::max();
-        float maxValue = std::numeric_limits<float>::lowest();
+    const bool computed = visitExpressionMatrix(dataset, numPoints, [&](const auto& matrix) {
+        kernels::columnRanges(matrix, columnMins, columnRanges);
+    });
 
-        for (int64_t i = 0; i < numPoints; i++)
-        {
-            float val = dataset->getValueAt(i * numDimensionsFull + dimIdx);
-            if (val < minValue)
-                minValue = val;
-            if (val > maxValue)
-                maxValue = val;
-        }
-
-        columnMins[dimIdx] = minValue;
-        columnRanges[dimIdx] = maxValue - minValue;
+    if (!computed)
+    {
+        qDebug() << "computeDataRange: dataset" << dataset->getGuiName() << "has no data for" << numPoints << "points";
+        return;
     }
 
     qDebug() << "Data range computed for " << numDimensions << " dimensions, " << numPoints << " points in dataset B";
@@ -167,9 +197,6 @@ void computeSelectedGeneMeanExpression(const mv::Dataset<Points> sourceDataset,
         return;
     }
 
-    int64_t numDimensionsB = sourceDataset->getNumDimensions();
-    int64_t numSelectedGenes = geneSelection->indices.size();
-
     // Output a dataset to color the spatial map by the selected gene avg. expression - always the same size as the full dataset
     mv::Dataset<Points> fullDatasetB;
     if (sourceDataset->isDerivedData())
@@ -183,38 +210,24 @@ void computeSelectedGeneMeanExpression(const mv::Dataset<Points> sourceDataset,
     int64_t totalNumPoints = fullDatasetB->getNumPoints();
     //qDebug() << "totalNumPoints" << totalNumPoints << "fullDatasetB" << fullDatasetB->getGuiName();
 
-    meanExpressionFull.resize(totalNumPoints, 0.0f);
+    const std::span<const std::uint32_t> selectedGenes(geneSelection->indices);
 
-#pragma omp parallel for  
-    for (int64_t j = 0; j < totalNumPoints; j++)
-    {
-        float sum = 0.0f;
-        for (int64_t i = 0; i < numSelectedGenes; i++)
-        {
-            int64_t geneIndex = geneSelection->indices[i];
-            sum += fullDatasetB->getValueAt(j * numDimensionsB + geneIndex);
-        }
-        meanExpressionFull[j] = sum / numSelectedGenes;
-    }
+    const bool computed = visitExpressionMatrix(fullDatasetB, totalNumPoints, [&](const auto& matrix) {
+        kernels::rowMeansOverColumns(matrix, selectedGenes, meanExpressionFull);
+    });
 
+    if (!computed)
+        qDebug() << "computeSelectedGeneMeanExpression: dataset" << fullDatasetB->getGuiName() << "has no data for" << totalNumPoints << "points";
 }
 
 void extractSelectedGeneMeanExpression(const mv::Dataset<Points> sourceDataset, const std::vector<float>& meanExpressionFull, std::vector<float>& meanExpressionLocal)
 {
     // sourceDataset should be embeddingSourceDatasetB
 
-    int numPointsB = sourceDataset->getNumPoints();
-
-    meanExpressionLocal.clear();
-    meanExpressionLocal.resize(numPointsB, 0.0f);
-
     std::vector<std::uint32_t> localGlobalIndicesB;
     sourceDataset->getGlobalIndices(localGlobalIndicesB);
 
-    for (int i = 0; i < numPointsB; i++)
-    {
-        meanExpressionLocal[i] = meanExpressionFull[localGlobalIndicesB[i]];
-    }
+    kernels::gather(meanExpressionFull, localGlobalIndicesB, meanExpressionLocal);
 }
 
 void identifyGeneSymbolsInDataset(const mv::Dataset<Points> sourceDataset, const QStringList& geneSymbols, QList<int>& foundGeneIndices)
@@ -259,8 +272,8 @@ void computeSelectedCellMeanExpression(const mv::Dataset<Points> sourceDataset,
     std::vector<bool> selected;
     fullDataset->selectedLocalIndices(selection->indices, selected);
 
-    std::vector<int> selectedIndices;
-    for (int i = 0; i < selected.size(); ++i)
+    std::vector<std::uint32_t> selectedIndices;
+    for (std::uint32_t i = 0; i < selected.size(); ++i)
     {
         if (selected[i]) 
             selectedIndices.push_back(i);
@@ -274,18 +287,12 @@ void computeSelectedCellMeanExpression(const mv::Dataset<Points> sourceDataset,
         return;
     }
 
-#pragma omp parallel for
-    for (int64_t i = 0; i < numDimensions; ++i)
-    {
-        float sum = 0.0f;
-        for (size_t idx : selectedIndices)
-        {
-            size_t idxFull = idx * numDimensions + static_cast<size_t>(i);
-            sum += fullDataset->getValueAt(idxFull);
-        }
-        meanExpressionFull[i] = sum / static_cast<float>(numSelected);
-    }
+    const bool computed = visitExpressionMatrix(fullDataset, fullDataset->getNumPoints(), [&](const auto& matrix) {
+        kernels::columnMeansOverRows(matrix, std::span<const std::uint32_t>(selectedIndices), meanExpressionFull);
+    });
 
+    if (!computed)
+        qDebug() << "computeSelectedCellMeanExpression: dataset" << fullDataset->getGuiName() << "has no data";
 }
 
 void computeMeanExpressionForAllCells(const mv::Dataset<Points> sourceDataset, std::vector<float>& meanExpressionFull)
@@ -295,17 +302,10 @@ void computeMeanExpressionForAllCells(const mv::Dataset<Points> sourceDataset, s
     int64_t numDimensions = sourceDataset->getNumDimensions();
     qDebug() << "computeMeanExpressionForAllCells: numPoints: " << numPoints << " numDimensions: " << numDimensions;
 
-    meanExpressionFull.resize(numDimensions, 0.0f);
-
-#pragma omp parallel for
-    for (int64_t i = 0; i < numDimensions; i++)
-    {
-        float sum = 0.0f;
-        for (int64_t j = 0; j < numPoints; j++)
-        {
-            sum += sourceDataset->getValueAt(j * numDimensions + i);
-        }
-        meanExpressionFull[i] = sum / static_cast<float>(numPoints);
-    }
+    const bool computed = visitExpressionMatrix(sourceDataset, numPoints, [&](const auto& matrix) {
+        kernels::columnMeans(matrix, meanExpressionFull);
+    });
 
+    if (!computed)
+        qDebug() << "computeMeanExpressionForAllCells: dataset" << sourceDataset->getGuiName() << "has no data for" << numPoints << "points";
 }
@@ -2,17 +2,58 @@
 #include <vector>
 
 #include "graphics/Vector2f.h"
+#include "graphics/Vector3f.h"
 #include <Dataset.h>
 #include <PointData/PointData.h>
 
+#include "ComputeKernels.h"
 
-void normalizeYValues(std::vector<mv::Vector2f>& embedding);
+#include <QImage>
 
-void projectToVerticalAxis(std::vector<mv::Vector2f>& embeddings, float x_value);
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+// call function with a typed kernels::MatrixView on the first numRows rows of the raw data of the dataset
+// the element type is resolved once here, so the kernels read the values directly instead of per element through getValueAt
+// returns false if the dataset holds fewer values than numRows * numDimensions
+template <typename Function>
+bool visitExpressionMatrix(const mv::Dataset<Points>& dataset, std::int64_t numRows, Function function)
+{
+    const std::int64_t numColumns = dataset->getNumDimensions();
+
+    return dataset->visitFromBeginToEnd<bool>([&](auto begin, auto end) {
+        using ValueType = std::remove_cvref_t<decltype(*begin)>;
+
+        const std::int64_t numValues = end - begin;
+        if (numColumns == 0 || numValues == 0 || numRows * numColumns > numValues)
+            return false;
+
+        function(kernels::MatrixView<ValueType>(std::span<const ValueType>(std::to_address(begin), numValues), numRows, numColumns));
+        return true;
+    });
+}
+
+void normalizeYValues(std::span<mv::Vector2f> embedding);
+
+void projectToVerticalAxis(std::span<mv::Vector2f> embeddings, float x_value);
 
 // for plotting 
 void scaleDataRange(const std::vector<float>& input, std::vector<float>& output, bool reverse, float ptSize);
 
+// categorical coloring: the palette is uploaded as a 1D color map and the labels as color map scalars
+// (palette sizes up to maxPaletteSize fit a color map texture on all OpenGL 3.3 hardware)
+constexpr std::size_t maxPaletteSize = 1024;
+
+QImage createPaletteImage(const std::vector<mv::Vector3f>& palette);
+
+void labelsToScalars(std::span<const std::uint32_t> labels, float labelOffset, std::span<float> scalars);
+
+// scalars[i] = base + slope * (value - rangeMin) / (rangeMax - rangeMin) for the value of point i in the given dimension, clamped to the range
+// scalars must be sized to the number of points, returns false if the dimension or the number of points does not match
+bool mapDimensionToScalars(const mv::Dataset<Points>& dataset, std::int32_t dimension, float rangeMin, float rangeMax, float base, float slope, std::vector<float>& scalars);
+
 void scaleDataRangeExperiment(const std::vector<float>& input, std::vector<float>& output, bool reverse, float ptSize);
 
 // precompute the range of each column every time the dataset changes, for computing line connections
@@ -0,0 +1,133 @@
+#include "ComputeKernels.h"
+
+#include <bit>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+    constexpr std::uint64_t hashPrime1 = 0x9E3779B185EBCA87ULL;
+    constexpr std::uint64_t hashPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+    // final avalanche step of splitmix64
+    std::uint64_t mixHash(std::uint64_t hash)
+    {
+        hash ^= hash >> 30;
+        hash *= 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 27;
+        hash *= 0x94D049BB133111EBULL;
+        hash ^= hash >> 31;
+        return hash;
+    }
+
+    std::uint64_t hashBlock(const std::byte* data, std::size_t size, std::uint64_t seed)
+    {
+        std::uint64_t hash = seed ^ (size * hashPrime1);
+
+        std::size_t offset = 0;
+        for (; offset + sizeof(std::uint64_t) <= size; offset += sizeof(std::uint64_t))
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + offset, sizeof(word));
+            hash = std::rotl(hash ^ (word * hashPrime2), 31) * hashPrime1;
+        }
+
+        for (; offset < size; offset++)
+            hash = std::rotl(hash ^ (static_cast<std::uint64_t>(data[offset]) * hashPrime1), 11) * hashPrime2;
+
+        return mixHash(hash);
+    }
+}
+
+namespace kernels
+{
+    void gather(std::span<const float> input, std::span<const std::uint32_t> indices, std::vector<float>& output)
+    {
+        output.resize(indices.size());
+
+        for (std::size_t i = 0; i < indices.size(); i++)
+            output[i] = input[indices[i]];
+    }
+
+    void updateSelectionScalars(std::span<float> scalars, std::span<const std::uint32_t> previousIndices, std::span<const std::uint32_t> indices, float unselectedValue, float selectedValue)
+    {
+        const std::size_t numScalars = scalars.size();
+
+        for (const std::uint32_t index : previousIndices)
+            if (index < numScalars)
+                scalars[index] = unselectedValue;
+
+        for (const std::uint32_t index : indices)
+            if (index < numScalars)
+                scalars[index] = selectedValue;
+    }
+
+    void topGroupPerColumn(const std::vector<std::vector<float>>& groupMeans, std::vector<int>& topGroups)
+    {
+        if (groupMeans.empty())
+        {
+            topGroups.clear();
+            return;
+        }
+
+        const std::int64_t numColumns = static_cast<std::int64_t>(groupMeans[0].size());
+
+        topGroups.assign(numColumns, 0);
+
+#pragma omp parallel for
+        for (std::int64_t column = 0; column < numColumns; column++)
+        {
+            float maxMean = groupMeans[0][column];
+            int maxGroup = 0;
+
+            for (std::size_t group = 1; group < groupMeans.size(); group++)
+            {
+                if (groupMeans[group][column] > maxMean)
+                {
+                    maxMean = groupMeans[group][column];
+                    maxGroup = static_cast<int>(group);
+                }
+            }
+
+            topGroups[column] = maxGroup;
+        }
+    }
+
+    void benjaminiHochberg(std::span<const double> pValues, double numTests, std::span<double> adjusted)
+    {
+        std::vector<std::uint32_t> order(pValues.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&pValues](std::uint32_t lhs, std::uint32_t rhs) { return pValues[lhs] < pValues[rhs]; });
+
+        double running = 1.0;
+        for (std::size_t rank = order.size(); rank > 0; rank--)
+        {
+            running = std::min(running, pValues[order[rank - 1]] * numTests / static_cast<double>(rank));
+            adjusted[order[rank - 1]] = running;
+        }
+    }
+
+    std::uint64_t hashBytes(std::span<const std::byte> bytes)
+    {
+        const std::int64_t blockSize = 1 << 20;
+        const std::int64_t numBytes = static_cast<std::int64_t>(bytes.size());
+        const std::int64_t numBlocks = (numBytes + blockSize - 1) / blockSize;
+
+        std::vector<std::uint64_t> blockHashes(numBlocks);
+
+#pragma omp parallel for
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t begin = block * blockSize;
+            const std::int64_t size = std::min(blockSize, numBytes - begin);
+
+            blockHashes[block] = hashBlock(bytes.data() + begin, static_cast<std::size_t>(size), static_cast<std::uint64_t>(block) * hashPrime2);
+        }
+
+        std::uint64_t hash = mixHash(static_cast<std::uint64_t>(numBytes) ^ hashPrime1);
+        for (const auto blockHash : blockHashes)
+            hash = mixHash(std::rotl(hash, 17) ^ blockHash);
+
+        return hash;
+    }
+}
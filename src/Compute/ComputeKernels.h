@@ -0,0 +1,343 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Dataset independent kernels behind the functions in Computation.h and the line/top cell computations of the plugin
+// They work on raw (strided) views of a row-major expression matrix (rows are cells, columns are genes) and need no running ManiVault core
+// The kernels are templated on the element type, so the Points element types (float, bfloat16, (u)int16, (u)int8) each get their own
+// instantiation and the type dispatch happens once per call instead of once per element
+namespace kernels
+{
+    // cooperative cancellation of long running kernels: the owner of a background job sets the flag, the kernel checks it
+    // between its iterations and returns early, the incomplete result of a cancelled kernel must be discarded
+    using CancelFlag = std::atomic<bool>;
+
+    inline bool isCancelled(const CancelFlag* cancelled)
+    {
+        return cancelled != nullptr && cancelled->load(std::memory_order_relaxed);
+    }
+
+    // read-only view on a row-major matrix, rows may be padded (rowStride >= numColumns)
+    template <typename T>
+    struct MatrixView
+    {
+        MatrixView(std::span<const T> data, std::int64_t numRows, std::int64_t numColumns, std::int64_t rowStride = 0) :
+            data(data), numRows(numRows), numColumns(numColumns), rowStride(rowStride > 0 ? rowStride : numColumns)
+        {
+        }
+
+        const T* row(std::int64_t row) const { return data.data() + row * rowStride; }
+        float at(std::int64_t row, std::int64_t column) const { return static_cast<float>(data[row * rowStride + column]); }
+
+        std::span<const T>  data;
+        std::int64_t        numRows;
+        std::int64_t        numColumns;
+        std::int64_t        rowStride;
+    };
+
+    // read-only view on every stride-th element, e.g. one column of a row-major matrix
+    template <typename T>
+    struct StridedView
+    {
+        StridedView(std::span<const T> data, std::int64_t size, std::int64_t stride = 1) :
+            data(data), size(size), stride(stride)
+        {
+        }
+
+        float operator[](std::int64_t index) const { return static_cast<float>(data[index * stride]); }
+
+        std::span<const T>  data;
+        std::int64_t        size;
+        std::int64_t        stride;
+    };
+
+    // view on a column of a matrix
+    template <typename T>
+    StridedView<T> columnView(const MatrixView<T>& matrix, std::int64_t column)
+    {
+        return StridedView<T>(matrix.data.subspan(column), matrix.numRows, matrix.rowStride);
+    }
+
+    // minimum and range (max - min) of each column
+    template <typename T>
+    void columnRanges(const MatrixView<T>& matrix, std::vector<float>& columnMins, std::vector<float>& columnRanges)
+    {
+        const std::int64_t numColumns = matrix.numColumns;
+
+        std::vector<float> columnMaxs(numColumns, std::numeric_limits<float>::lowest());
+        columnMins.assign(numColumns, std::numeric_limits<float>::max());
+        columnRanges.resize(numColumns);
+
+        // row-wise traversal to read the matrix sequentially, each thread reduces into its own min/max
+#pragma omp parallel
+        {
+            std::vector<float> localMins(numColumns, std::numeric_limits<float>::max());
+            std::vector<float> localMaxs(numColumns, std::numeric_limits<float>::lowest());
+
+#pragma omp for nowait
+            for (std::int64_t row = 0; row < matrix.numRows; row++)
+            {
+                const T* values = matrix.row(row);
+                for (std::int64_t column = 0; column < numColumns; column++)
+                {
+                    const float value = static_cast<float>(values[column]);
+                    localMins[column] = std::min(localMins[column], value);
+                    localMaxs[column] = std::max(localMaxs[column], value);
+                }
+            }
+
+#pragma omp critical
+            for (std::int64_t column = 0; column < numColumns; column++)
+            {
+                columnMins[column] = std::min(columnMins[column], localMins[column]);
+                columnMaxs[column] = std::max(columnMaxs[column], localMaxs[column]);
+            }
+        }
+
+        for (std::int64_t column = 0; column < numColumns; column++)
+            columnRanges[column] = columnMaxs[column] - columnMins[column];
+    }
+
+    // mean of each column over the given rows
+    template <typename T>
+    void columnMeansOverRows(const MatrixView<T>& matrix, std::span<const std::uint32_t> rows, std::vector<float>& means)
+    {
+        const std::int64_t numColumns = matrix.numColumns;
+        const std::int64_t numRows = static_cast<std::int64_t>(rows.size());
+
+        means.assign(numColumns, 0.0f);
+
+        if (numRows == 0)
+            return;
+
+        // accumulate in double per thread, rows are read contiguously
+#pragma omp parallel
+        {
+            std::vector<double> localSums(numColumns, 0.0);
+
+#pragma omp for nowait
+            for (std::int64_t i = 0; i < numRows; i++)
+            {
+                const T* values = matrix.row(rows[i]);
+                for (std::int64_t column = 0; column < numColumns; column++)
+                    localSums[column] += static_cast<float>(values[column]);
+            }
+
+#pragma omp critical
+            for (std::int64_t column = 0; column < numColumns; column++)
+                means[column] += static_cast<float>(localSums[column]);
+        }
+
+        for (std::int64_t column = 0; column < numColumns; column++)
+            means[column] /= static_cast<float>(numRows);
+    }
+
+    // mean of each column over all rows
+    template <typename T>
+    void columnMeans(const MatrixView<T>& matrix, std::vector<float>& means)
+    {
+        std::vector<std::uint32_t> rows(matrix.numRows);
+        for (std::int64_t row = 0; row < matrix.numRows; row++)
+            rows[row] = static_cast<std::uint32_t>(row);
+
+        columnMeansOverRows(matrix, std::span<const std::uint32_t>(rows), means);
+    }
+
+    // mean of each row over the given columns
+    template <typename T>
+    void rowMeansOverColumns(const MatrixView<T>& matrix, std::span<const std::uint32_t> columns, std::vector<float>& means)
+    {
+        means.assign(matrix.numRows, 0.0f);
+
+        if (columns.empty())
+            return;
+
+        const std::int64_t numSelected = static_cast<std::int64_t>(columns.size());
+
+#pragma omp parallel for
+        for (std::int64_t row = 0; row < matrix.numRows; row++)
+        {
+            const T* values = matrix.row(row);
+
+            float sum = 0.0f;
+            for (std::int64_t i = 0; i < numSelected; i++)
+                sum += static_cast<float>(values[columns[i]]);
+
+            means[row] = sum / static_cast<float>(numSelected);
+        }
+    }
+
+    // lines (column, local row) for all local rows whose value is above min + threshold * range of that column
+    // localToGlobalRows maps the local row index to the row in the matrix
+    template <typename T>
+    void lineConnections(const MatrixView<T>& matrix, std::span<const std::uint32_t> localToGlobalRows, const std::vector<float>& columnMins,
+        const std::vector<float>& columnRanges, float threshold, std::vector<std::pair<std::uint32_t, std::uint32_t>>& lines)
+    {
+        const std::int64_t numColumns = matrix.numColumns;
+        const std::int64_t numLocalRows = static_cast<std::int64_t>(localToGlobalRows.size());
+
+        // per column cut-off, computed once instead of once per element
+        std::vector<float> cutoffs(numColumns);
+        for (std::int64_t column = 0; column < numColumns; column++)
+            cutoffs[column] = columnMins[column] + threshold * columnRanges[column];
+
+        // every block of rows collects its own lines, the blocks are concatenated in order
+        // so the result is identical to a serial row by row traversal
+        const std::int64_t blockSize = 1024;
+        const std::int64_t numBlocks = (numLocalRows + blockSize - 1) / blockSize;
+
+        std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> blockLines(numBlocks);
+
+#pragma omp parallel for schedule(dynamic)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t end = std::min(numLocalRows, (block + 1) * blockSize);
+
+            for (std::int64_t localRow = block * blockSize; localRow < end; localRow++)
+            {
+                const T* values = matrix.row(localToGlobalRows[localRow]);
+                for (std::int64_t column = 0; column < numColumns; column++)
+                {
+                    if (static_cast<float>(values[column]) > cutoffs[column])
+                        blockLines[block].emplace_back(static_cast<std::uint32_t>(column), static_cast<std::uint32_t>(localRow));
+                }
+            }
+        }
+
+        std::size_t numLines = 0;
+        for (const auto& block : blockLines)
+            numLines += block.size();
+
+        lines.clear();
+        lines.reserve(numLines);
+
+        for (const auto& block : blockLines)
+            lines.insert(lines.end(), block.begin(), block.end());
+    }
+
+    // lines (column, group) for all groups of rows whose mean value is above min + threshold * range of that column
+    // the rows of a group are groupRows[groupOffsets[group]] up to groupRows[groupOffsets[group + 1]], e.g. the cells in the area of
+    // influence of an HSNE landmark, groups without rows get no lines
+    template <typename T>
+    void groupLineConnections(const MatrixView<T>& matrix, std::span<const std::uint32_t> groupOffsets, std::span<const std::uint32_t> groupRows,
+        const std::vector<float>& columnMins, const std::vector<float>& columnRanges, float threshold, std::vector<std::pair<std::uint32_t, std::uint32_t>>& lines)
+    {
+        const std::int64_t numColumns = matrix.numColumns;
+        const std::int64_t numGroups = groupOffsets.empty() ? 0 : static_cast<std::int64_t>(groupOffsets.size()) - 1;
+
+        std::vector<float> cutoffs(numColumns);
+        for (std::int64_t column = 0; column < numColumns; column++)
+            cutoffs[column] = columnMins[column] + threshold * columnRanges[column];
+
+        // a group reads many rows, so the blocks are smaller than in lineConnections, the blocks are again concatenated in order
+        const std::int64_t blockSize = 16;
+        const std::int64_t numBlocks = (numGroups + blockSize - 1) / blockSize;
+
+        std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> blockLines(numBlocks);
+
+#pragma omp parallel
+        {
+            std::vector<double> sums(numColumns);
+
+#pragma omp for schedule(dynamic)
+            for (std::int64_t block = 0; block < numBlocks; block++)
+            {
+                const std::int64_t end = std::min(numGroups, (block + 1) * blockSize);
+
+                for (std::int64_t group = block * blockSize; group < end; group++)
+                {
+                    const std::uint32_t begin = groupOffsets[group];
+                    const std::uint32_t numRows = groupOffsets[group + 1] - begin;
+
+                    if (numRows == 0)
+                        continue;
+
+                    std::fill(sums.begin(), sums.end(), 0.0);
+                    for (std::uint32_t i = begin; i < begin + numRows; i++)
+                    {
+                        const T* values = matrix.row(groupRows[i]);
+                        for (std::int64_t column = 0; column < numColumns; column++)
+                            sums[column] += static_cast<float>(values[column]);
+                    }
+
+                    for (std::int64_t column = 0; column < numColumns; column++)
+                    {
+                        if (static_cast<float>(sums[column] / numRows) > cutoffs[column])
+                            blockLines[block].emplace_back(static_cast<std::uint32_t>(column), static_cast<std::uint32_t>(group));
+                    }
+                }
+            }
+        }
+
+        std::size_t numLines = 0;
+        for (const auto& block : blockLines)
+            numLines += block.size();
+
+        lines.clear();
+        lines.reserve(numLines);
+
+        for (const auto& block : blockLines)
+            lines.insert(lines.end(), block.begin(), block.end());
+    }
+
+    // mean of each column for each group of rows, groups without rows get invalidValue
+    template <typename T>
+    void groupColumnMeans(const MatrixView<T>& matrix, const std::vector<std::vector<std::uint32_t>>& groupRows, std::vector<std::vector<float>>& groupMeans, float invalidValue = -100.0f)
+    {
+        groupMeans.resize(groupRows.size());
+
+        for (std::size_t group = 0; group < groupRows.size(); group++)
+        {
+            if (groupRows[group].empty())
+                groupMeans[group].assign(matrix.numColumns, invalidValue);
+            else
+                columnMeansOverRows(matrix, std::span<const std::uint32_t>(groupRows[group]), groupMeans[group]);
+        }
+    }
+
+    // output[i] = base + slope * (values[i] - rangeMin) / (rangeMax - rangeMin), with values[i] clamped to [rangeMin, rangeMax]
+    // maps a data dimension to point size/opacity scalars, requires rangeMax > rangeMin
+    template <typename T>
+    void mapScalars(const StridedView<T>& values, float rangeMin, float rangeMax, float base, float slope, std::span<float> output)
+    {
+        const std::int64_t numValues = std::min(values.size, static_cast<std::int64_t>(output.size()));
+        const std::int64_t stride = values.stride;
+        const T* data = values.data.data();
+        float* scalars = output.data();
+
+        // one multiply-add per element instead of a division per element
+        const float scale = slope / (rangeMax - rangeMin);
+
+#pragma omp parallel for simd
+        for (std::int64_t i = 0; i < numValues; i++)
+        {
+            const float value = std::clamp(static_cast<float>(data[i * stride]), rangeMin, rangeMax);
+            scalars[i] = base + (value - rangeMin) * scale;
+        }
+    }
+
+    // scalars of previousIndices are reset to unselectedValue, then the scalars of indices are set to selectedValue
+    // only touches the points whose selection state may have changed, indices outside of scalars are ignored
+    void updateSelectionScalars(std::span<float> scalars, std::span<const std::uint32_t> previousIndices, std::span<const std::uint32_t> indices, float unselectedValue, float selectedValue);
+
+    // output[i] = input[indices[i]]
+    void gather(std::span<const float> input, std::span<const std::uint32_t> indices, std::vector<float>& output);
+
+    // index of the group with the highest mean for each column (the first group wins ties)
+    void topGroupPerColumn(const std::vector<std::vector<float>>& groupMeans, std::vector<int>& topGroups);
+
+    // Benjamini-Hochberg adjusted p values (step-up, capped at 1), ranked among the given p values only
+    // numTests may exceed the number of p values for tests whose p values are not given, the result is then an upper bound
+    void benjaminiHochberg(std::span<const double> pValues, double numTests, std::span<double> adjusted);
+
+    // fast, non-cryptographic 64 bit hash of a buffer, for detecting changed content
+    // blocks are hashed in parallel, the result does not depend on the number of threads
+    std::uint64_t hashBytes(std::span<const std::byte> bytes);
+}
@@ -0,0 +1,193 @@
+#include "CrossingMinimization.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    // lines per node in compressed row format
+    struct Adjacency
+    {
+        std::vector<std::uint32_t>  offsets;        // start of the neighbours of every node, numNodes + 1 entries
+        std::vector<std::uint32_t>  neighbors;      // nodes on the other axis
+    };
+
+    Adjacency buildAdjacency(std::span<const kernels::Line> lines, std::size_t numNodes, bool bySource)
+    {
+        Adjacency adjacency;
+        adjacency.offsets.assign(numNodes + 1, 0);
+
+        for (const kernels::Line& line : lines)
+            adjacency.offsets[(bySource ? line.first : line.second) + 1]++;
+
+        std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+        std::vector<std::uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+        adjacency.neighbors.resize(lines.size());
+
+        for (const kernels::Line& line : lines)
+        {
+            if (bySource)
+                adjacency.neighbors[fill[line.first]++] = line.second;
+            else
+                adjacency.neighbors[fill[line.second]++] = line.first;
+        }
+
+        return adjacency;
+    }
+
+    // sort the nodes of one axis by the mean rank of their neighbours on the other axis, nodes without neighbours keep
+    // their (scaled) own rank as key so they stay where they are relative to the others
+    void sortByBarycenter(const Adjacency& adjacency, std::span<const std::uint32_t> otherRanks, std::vector<std::uint32_t>& ranks, std::vector<double>& keys, std::vector<std::uint32_t>& order)
+    {
+        const std::int64_t numNodes = static_cast<std::int64_t>(ranks.size());
+        const double scale = static_cast<double>(otherRanks.size()) / static_cast<double>(std::max<std::int64_t>(numNodes, 1));
+
+        keys.resize(numNodes);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (std::int64_t node = 0; node < numNodes; node++)
+        {
+            const std::uint32_t begin = adjacency.offsets[node];
+            const std::uint32_t end = adjacency.offsets[node + 1];
+
+            if (begin == end)
+            {
+                keys[node] = ranks[node] * scale;
+                continue;
+            }
+
+            double sum = 0.0;
+            for (std::uint32_t n = begin; n < end; n++)
+                sum += otherRanks[adjacency.neighbors[n]];
+
+            keys[node] = sum / (end - begin);
+        }
+
+        order.resize(numNodes);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&keys, &ranks](std::uint32_t lhs, std::uint32_t rhs) {
+            return keys[lhs] < keys[rhs] || (keys[lhs] == keys[rhs] && ranks[lhs] < ranks[rhs]);
+        });
+
+        for (std::int64_t rank = 0; rank < numNodes; rank++)
+            ranks[order[rank]] = static_cast<std::uint32_t>(rank);
+    }
+}
+
+namespace kernels
+{
+    void valueRanks(std::span<const float> values, std::vector<std::uint32_t>& ranks)
+    {
+        std::vector<std::uint32_t> order(values.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [values](std::uint32_t lhs, std::uint32_t rhs) { return values[lhs] < values[rhs]; });
+
+        ranks.resize(values.size());
+        for (std::size_t rank = 0; rank < order.size(); rank++)
+            ranks[order[rank]] = static_cast<std::uint32_t>(rank);
+    }
+
+    void valuesByRank(std::span<const float> values, std::span<const std::uint32_t> ranks, std::vector<float>& rankedValues)
+    {
+        std::vector<float> sortedValues(values.begin(), values.end());
+        std::sort(sortedValues.begin(), sortedValues.end());
+
+        rankedValues.resize(values.size());
+        for (std::size_t node = 0; node < values.size(); node++)
+            rankedValues[node] = sortedValues[ranks[node]];
+    }
+
+    std::uint64_t countCrossings(std::span<const Line> lines, std::span<const std::uint32_t> sourceRanks, std::span<const std::uint32_t> destinationRanks)
+    {
+        const std::size_t numSources = sourceRanks.size();
+        const std::size_t numDestinations = destinationRanks.size();
+
+        // destination ranks of the lines grouped by source rank, sorted within a group
+        std::vector<std::uint32_t> offsets(numSources + 1, 0);
+        for (const Line& line : lines)
+            offsets[sourceRanks[line.first] + 1]++;
+
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        std::vector<std::uint32_t> destinations(lines.size());
+
+        for (const Line& line : lines)
+            destinations[fill[sourceRanks[line.first]]++] = destinationRanks[line.second];
+
+        const std::int64_t numGroups = static_cast<std::int64_t>(numSources);
+
+#pragma omp parallel for schedule(dynamic, 64)
+        for (std::int64_t group = 0; group < numGroups; group++)
+            std::sort(destinations.begin() + offsets[group], destinations.begin() + offsets[group + 1]);
+
+        // in this order a line crosses every earlier line that ends at a higher destination rank, counted with a Fenwick
+        // tree over the destination ranks of the lines seen so far
+        std::vector<std::uint32_t> tree(numDestinations + 1, 0);
+        std::uint64_t crossings = 0;
+        std::uint64_t numSeen = 0;
+
+        for (const std::uint32_t destination : destinations)
+        {
+            std::uint64_t numAtOrBelow = 0;
+            for (std::size_t index = destination + 1; index > 0; index -= index & (~index + 1))
+                numAtOrBelow += tree[index];
+
+            crossings += numSeen - numAtOrBelow;
+
+            for (std::size_t index = destination + 1; index <= numDestinations; index += index & (~index + 1))
+                tree[index]++;
+
+            numSeen++;
+        }
+
+        return crossings;
+    }
+
+    std::uint64_t minimizeCrossings(std::span<const Line> lines, std::vector<std::uint32_t>& sourceRanks, std::vector<std::uint32_t>& destinationRanks, const CrossingMinimizationSettings& settings)
+    {
+        std::uint64_t bestCrossings = countCrossings(lines, sourceRanks, destinationRanks);
+
+        if (lines.empty() || bestCrossings == 0)
+            return bestCrossings;
+
+        const Adjacency sourceLines = buildAdjacency(lines, sourceRanks.size(), true);
+        const Adjacency destinationLines = buildAdjacency(lines, destinationRanks.size(), false);
+
+        std::vector<std::uint32_t> currentSourceRanks = sourceRanks;
+        std::vector<std::uint32_t> currentDestinationRanks = destinationRanks;
+
+        std::vector<double> keys;
+        std::vector<std::uint32_t> order;
+
+        for (std::int32_t sweep = 0; sweep < settings.maxSweeps && !isCancelled(settings.cancelled); sweep++)
+        {
+            bool improved = false;
+
+            // one sweep reorders the destinations and then the sources, the best ranks seen so far are kept
+            for (const bool reorderDestinations : { true, false })
+            {
+                if (reorderDestinations)
+                    sortByBarycenter(destinationLines, currentSourceRanks, currentDestinationRanks, keys, order);
+                else
+                    sortByBarycenter(sourceLines, currentDestinationRanks, currentSourceRanks, keys, order);
+
+                const std::uint64_t crossings = countCrossings(lines, currentSourceRanks, currentDestinationRanks);
+
+                if (crossings < bestCrossings)
+                {
+                    bestCrossings = crossings;
+                    sourceRanks = currentSourceRanks;
+                    destinationRanks = currentDestinationRanks;
+                    improved = true;
+                }
+            }
+
+            if (!improved || bestCrossings == 0)
+                break;
+        }
+
+        return bestCrossings;
+    }
+}
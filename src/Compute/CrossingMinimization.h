@@ -0,0 +1,38 @@
+#pragma once
+
+#include "ComputeKernels.h"
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Reordering of the two axes of a bipartite line layout (the 1D embeddings of A and B) to reduce line crossings
+// Lines are (source, destination) index pairs as in the lines view, the order of an axis is given by the rank of
+// every node along it. Like the kernels in ComputeKernels.h this needs no running ManiVault core and is safe to run on a
+// worker thread
+namespace kernels
+{
+    using Line = std::pair<std::uint32_t, std::uint32_t>;
+
+    struct CrossingMinimizationSettings
+    {
+        std::int32_t        maxSweeps   = 8;            // barycenter sweeps over both axes
+        const CancelFlag*   cancelled   = nullptr;      // checked between sweeps, a cancelled minimization keeps the best ranks so far
+    };
+
+    // rank of every value when the values are sorted ascending, ties are ranked by index
+    void valueRanks(std::span<const float> values, std::vector<std::uint32_t>& ranks);
+
+    // the values redistributed over the nodes by rank: the node of rank r gets the r-th smallest value
+    void valuesByRank(std::span<const float> values, std::span<const std::uint32_t> ranks, std::vector<float>& rankedValues);
+
+    // number of pairs of lines that cross, lines sharing an end point do not cross
+    std::uint64_t countCrossings(std::span<const Line> lines, std::span<const std::uint32_t> sourceRanks, std::span<const std::uint32_t> destinationRanks);
+
+    // reduce the number of crossings by alternately sorting the destinations by the mean rank of their sources and the
+    // sources by the mean rank of their destinations (barycenter heuristic), starting from the given ranks
+    // nodes without lines keep their relative position, the ranks are only replaced if the crossings were reduced
+    // returns the number of crossings of the resulting ranks
+    std::uint64_t minimizeCrossings(std::span<const Line> lines, std::vector<std::uint32_t>& sourceRanks, std::vector<std::uint32_t>& destinationRanks, const CrossingMinimizationSettings& settings = {});
+}
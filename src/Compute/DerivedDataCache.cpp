@@ -0,0 +1,179 @@
+#include "DerivedDataCache.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    const qint64 defaultMaxSize = 4LL * 1024 * 1024 * 1024; // 4 GB
+
+    // bump when the layout of the artifacts changes, artifacts of other versions are then never opened
+    const char* artifactFormatVersion = "v2";
+}
+
+MappedArtifact::MappedArtifact(std::unique_ptr<QFile> file, const uchar* data, qint64 size) :
+    _file(std::move(file)),
+    _data(data),
+    _size(size)
+{
+}
+
+MappedArtifact::~MappedArtifact()
+{
+    if (_file && _data)
+        _file->unmap(const_cast<uchar*>(_data));
+}
+
+DerivedDataCache::DerivedDataCache() :
+    _cacheDirectory(),
+    _maxSize(defaultMaxSize)
+{
+    setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/DualView/DerivedDataCache");
+}
+
+void DerivedDataCache::setCacheDirectory(const QString& cacheDirectory)
+{
+    _cacheDirectory = cacheDirectory;
+
+    if (_cacheDirectory.isEmpty())
+        return;
+
+    if (!QDir().mkpath(_cacheDirectory)) {
+        qDebug() << "DerivedDataCache: cannot create cache directory" << _cacheDirectory << ", artifacts are not cached";
+        _cacheDirectory.clear();
+    }
+}
+
+void DerivedDataCache::setMaxSize(qint64 maxSize)
+{
+    _maxSize = std::max<qint64>(0, maxSize);
+
+    evict(_maxSize);
+}
+
+bool DerivedDataCache::store(const QByteArray& sourceHash, const QString& name, std::span<const std::byte> data)
+{
+    if (_cacheDirectory.isEmpty() || sourceHash.isEmpty() || static_cast<qint64>(data.size()) > _maxSize)
+        return false;
+
+    // make room first, so the cache never exceeds its limit
+    evict(_maxSize - static_cast<qint64>(data.size()));
+
+    const QString filePath = artifactFilePath(sourceHash, name);
+
+    if (!QDir().mkpath(QFileInfo(filePath).absolutePath()))
+        return false;
+
+    // write to a temporary file first so that a crash never leaves a truncated artifact behind
+    QSaveFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "DerivedDataCache::store: cannot write" << filePath;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<qint64>(data.size()));
+
+    if (!file.commit()) {
+        qDebug() << "DerivedDataCache::store: cannot write" << filePath << ":" << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+MappedArtifact DerivedDataCache::open(const QByteArray& sourceHash, const QString& name) const
+{
+    if (_cacheDirectory.isEmpty() || sourceHash.isEmpty() || _maxSize == 0)
+        return {};
+
+    auto file = std::make_unique<QFile>(artifactFilePath(sourceHash, name));
+
+    // setting the file time needs write access on Windows, read-only artifacts are still read
+    if (!file->open(QIODevice::ReadWrite | QIODevice::ExistingOnly) && !file->open(QIODevice::ReadOnly))
+        return {};
+
+    if (file->size() == 0)
+        return {};
+
+    // the modification time is the LRU time stamp, file access times are often not maintained
+    if (!file->setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime))
+        qDebug() << "DerivedDataCache::open: cannot update the time stamp of" << file->fileName() << ", it may be evicted early:" << file->errorString();
+
+    const qint64 size = file->size();
+    const uchar* data = file->map(0, size);
+
+    if (data == nullptr) {
+        qDebug() << "DerivedDataCache::open: cannot map" << file->fileName() << ":" << file->errorString();
+        return {};
+    }
+
+    return MappedArtifact(std::move(file), data, size);
+}
+
+bool DerivedDataCache::contains(const QByteArray& sourceHash, const QString& name) const
+{
+    return !_cacheDirectory.isEmpty() && !sourceHash.isEmpty() && _maxSize > 0 && QFileInfo::exists(artifactFilePath(sourceHash, name));
+}
+
+void DerivedDataCache::clear()
+{
+    if (_cacheDirectory.isEmpty())
+        return;
+
+    QDir cacheDirectory(_cacheDirectory);
+
+    for (const QString& entry : cacheDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        QDir(cacheDirectory.filePath(entry)).removeRecursively();
+}
+
+QString DerivedDataCache::artifactFilePath(const QByteArray& sourceHash, const QString& name) const
+{
+    return QString("%1/%2/%3.%4.bin").arg(_cacheDirectory, QString::fromLatin1(sourceHash), name, artifactFormatVersion);
+}
+
+void DerivedDataCache::evict(qint64 maxSize) const
+{
+    if (_cacheDirectory.isEmpty())
+        return;
+
+    std::vector<QFileInfo> artifacts;
+    qint64 totalSize = 0;
+
+    QDirIterator iterator(_cacheDirectory, { "*.bin" }, QDir::Files, QDirIterator::Subdirectories);
+    while (iterator.hasNext()) {
+        artifacts.push_back(iterator.nextFileInfo());
+        totalSize += artifacts.back().size();
+    }
+
+    if (totalSize <= maxSize)
+        return;
+
+    // least recently used first
+    std::sort(artifacts.begin(), artifacts.end(), [](const QFileInfo& lhs, const QFileInfo& rhs) {
+        return lhs.lastModified() < rhs.lastModified();
+        });
+
+    for (const QFileInfo& artifact : artifacts) {
+        if (totalSize <= maxSize)
+            break;
+
+        // a mapped artifact may not be removable on Windows, it is then evicted later
+        if (!QFile::remove(artifact.absoluteFilePath()))
+            continue;
+
+        totalSize -= artifact.size();
+
+        QDir artifactDirectory = artifact.absoluteDir();
+        if (artifactDirectory.isEmpty())
+            artifactDirectory.removeRecursively();
+    }
+}
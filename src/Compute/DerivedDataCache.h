@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+// Read-only memory mapping of a cached artifact, the mapping is released on destruction
+class MappedArtifact
+{
+public:
+    MappedArtifact() = default;
+    MappedArtifact(std::unique_ptr<QFile> file, const uchar* data, qint64 size);
+    ~MappedArtifact();
+
+    MappedArtifact(MappedArtifact&&) = default;
+    MappedArtifact& operator=(MappedArtifact&&) = default;
+
+    bool isValid() const { return _data != nullptr; }
+
+    std::span<const std::byte> bytes() const { return { reinterpret_cast<const std::byte*>(_data), static_cast<std::size_t>(_size) }; }
+
+private:
+    std::unique_ptr<QFile>  _file;              // mapped file, unmapped when closed
+    const uchar*            _data = nullptr;    // start of the mapping
+    qint64                  _size = 0;          // size of the mapping in bytes
+};
+
+// Directory of derived per-dataset artifacts (e.g. line connections, cluster summaries), shared by all projects
+// Artifacts are raw files in <cache directory>/<source hash>/<name>.bin, so reopening a project on the same expression
+// matrix reads them instead of recomputing. They are mapped only while they are read: the readers copy the values once,
+// straight from the mapping into their own vectors
+// The total size is bounded, the least recently used artifacts are evicted first
+class DerivedDataCache
+{
+public:
+    // uses <AppDataLocation>/DualView/DerivedDataCache as cache directory
+    DerivedDataCache();
+
+    QString getCacheDirectory() const { return _cacheDirectory; }
+    void setCacheDirectory(const QString& cacheDirectory);
+
+    // maximum total size of the artifacts in bytes, 0 disables the cache
+    qint64 getMaxSize() const { return _maxSize; }
+    void setMaxSize(qint64 maxSize);
+
+    // write an artifact, replaces an existing one with the same name, returns false if it was not written
+    bool store(const QByteArray& sourceHash, const QString& name, std::span<const std::byte> data);
+
+    // map an artifact and mark it as recently used, the result is invalid if it does not exist
+    MappedArtifact open(const QByteArray& sourceHash, const QString& name) const;
+
+    // whether an artifact exists
+    bool contains(const QByteArray& sourceHash, const QString& name) const;
+
+    // remove all artifacts
+    void clear();
+
+private:
+    QString artifactFilePath(const QByteArray& sourceHash, const QString& name) const;
+
+    // remove least recently used artifacts until the total size fits maxSize
+    void evict(qint64 maxSize) const;
+
+private:
+    QString     _cacheDirectory;    // root of the cache, empty disables the cache
+    qint64      _maxSize;           // maximum total size of all artifacts in bytes
+};
@@ -0,0 +1,420 @@
+#include "DerivedStatistics.h"
+
+#include "ComputeKernels.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+namespace
+{
+    // bump when the layout of the blob changes, older blobs are then ignored and the statistics recomputed
+    const quint32 blobFormatVersion = 4;
+
+    // QDataStream raw blocks are limited to int sizes
+    bool fitsRawBlock(std::size_t numBytes)
+    {
+        return numBytes <= static_cast<std::size_t>(std::numeric_limits<int>::max());
+    }
+
+    // a vector too large for a raw block is written empty, returns false then
+    template <typename T>
+    bool writeVector(QDataStream& stream, const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        const bool fits = fitsRawBlock(values.size() * sizeof(T));
+
+        stream << static_cast<quint64>(fits ? values.size() : 0);
+
+        if (fits)
+            stream.writeRawData(reinterpret_cast<const char*>(values.data()), static_cast<int>(values.size() * sizeof(T)));
+
+        return fits;
+    }
+
+    template <typename T>
+    bool readVector(QDataStream& stream, std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        quint64 size = 0;
+        stream >> size;
+
+        if (stream.status() != QDataStream::Ok || size > static_cast<quint64>(std::numeric_limits<int>::max()) / sizeof(T))
+            return false;
+
+        values.resize(size);
+
+        return stream.readRawData(reinterpret_cast<char*>(values.data()), static_cast<int>(size * sizeof(T))) == static_cast<int>(size * sizeof(T));
+    }
+
+    using IndexPair = std::pair<std::uint32_t, std::uint32_t>;
+
+    // disk cache artifacts are plain arrays of 64 bit counts and of values, read in order from the mapping
+    class ArtifactWriter
+    {
+    public:
+        void writeCount(std::uint64_t count) { append(&count, sizeof(count)); }
+
+        template <typename T>
+        void writeValues(std::span<const T> values) { append(values.data(), values.size_bytes()); }
+
+        // pairs are written as first, second, first, second, ... (std::pair is not trivially copyable)
+        void writePairs(std::span<const IndexPair> pairs)
+        {
+            const auto offset = _bytes.size();
+            _bytes.resize(offset + 2 * sizeof(std::uint32_t) * pairs.size());
+
+            std::byte* out = _bytes.data() + offset;
+            for (const auto& [first, second] : pairs) {
+                std::memcpy(out, &first, sizeof(std::uint32_t));
+                std::memcpy(out + sizeof(std::uint32_t), &second, sizeof(std::uint32_t));
+                out += 2 * sizeof(std::uint32_t);
+            }
+        }
+
+        std::span<const std::byte> bytes() const { return _bytes; }
+
+    private:
+        void append(const void* data, std::size_t numBytes)
+        {
+            const auto offset = _bytes.size();
+            _bytes.resize(offset + numBytes);
+            std::memcpy(_bytes.data() + offset, data, numBytes);
+        }
+
+        std::vector<std::byte> _bytes;
+    };
+
+    class ArtifactReader
+    {
+    public:
+        explicit ArtifactReader(std::span<const std::byte> bytes) : _bytes(bytes) {}
+
+        bool readCount(std::uint64_t& count) { return read(&count, sizeof(count)); }
+
+        template <typename T>
+        bool readValues(std::uint64_t count, std::vector<T>& values)
+        {
+            if (count > (_bytes.size() - _offset) / sizeof(T))
+                return false;
+
+            values.resize(count);
+            return read(values.data(), count * sizeof(T));
+        }
+
+        // reads the pairs straight from the mapping into the output, without an intermediate flat array
+        bool readPairs(std::uint64_t count, std::vector<IndexPair>& pairs)
+        {
+            if (count > (_bytes.size() - _offset) / (2 * sizeof(std::uint32_t)))
+                return false;
+
+            pairs.resize(count);
+
+            const std::byte* in = _bytes.data() + _offset;
+            for (auto& [first, second] : pairs) {
+                std::memcpy(&first, in, sizeof(std::uint32_t));
+                std::memcpy(&second, in + sizeof(std::uint32_t), sizeof(std::uint32_t));
+                in += 2 * sizeof(std::uint32_t);
+            }
+
+            _offset += count * 2 * sizeof(std::uint32_t);
+            return true;
+        }
+
+        bool atEnd() const { return _offset == _bytes.size(); }
+
+    private:
+        bool read(void* data, std::size_t numBytes)
+        {
+            if (numBytes > _bytes.size() - _offset)
+                return false;
+
+            std::memcpy(data, _bytes.data() + _offset, numBytes);
+            _offset += numBytes;
+            return true;
+        }
+
+        std::span<const std::byte>  _bytes;
+        std::size_t                 _offset = 0;
+    };
+
+    QString linesArtifactName(const QByteArray& cellsKey, float threshold)
+    {
+        return QString("lines_%1_%2").arg(QString::fromLatin1(cellsKey)).arg(std::bit_cast<std::uint32_t>(threshold), 8, 16, QChar('0'));
+    }
+
+    QString clusterSummaryArtifactName(const QByteArray& clustersKey)
+    {
+        return QString("clusterMoments_%1").arg(QString::fromLatin1(clustersKey));
+    }
+}
+
+DerivedStatistics::DerivedStatistics() :
+    _sourceHash(),
+    _columnMins(),
+    _columnRanges(),
+    _columnMeans(),
+    _linesCellsKey(),
+    _linesThreshold(0.0f),
+    _hasLines(false),
+    _clustersKey(),
+    _diskCache()
+{
+}
+
+QByteArray DerivedStatistics::computeSourceHash(const mv::Dataset<Points>& dataset)
+{
+    if (!dataset.isValid())
+        return {};
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    hash.addData(QByteArray::number(static_cast<qint64>(dataset->getNumPoints())));
+    hash.addData(QByteArrayView("x"));
+    hash.addData(QByteArray::number(static_cast<qint64>(dataset->getNumDimensions())));
+    hash.addData(QByteArrayView("\n"));
+
+    for (const QString& dimensionName : dataset->getDimensionNames()) {
+        hash.addData(dimensionName.toUtf8());
+        hash.addData(QByteArrayView("\n"));
+    }
+
+    // the raw values are hashed with the fast parallel kernel, the element size distinguishes e.g. float from bfloat16 data
+    const auto valuesHash = dataset->visitFromBeginToEnd<std::uint64_t>([](auto begin, auto end) {
+        using ValueType = std::remove_cvref_t<decltype(*begin)>;
+
+        if (begin == end)
+            return std::uint64_t(0);
+
+        const std::span<const ValueType> values(std::to_address(begin), static_cast<std::size_t>(end - begin));
+        return kernels::hashBytes(std::as_bytes(values)) ^ sizeof(ValueType);
+    });
+
+    hash.addData(QByteArray::number(static_cast<qulonglong>(valuesHash), 16));
+
+    return hash.result().toHex();
+}
+
+bool DerivedStatistics::setSourceHash(const QByteArray& sourceHash)
+{
+    if (sourceHash == _sourceHash)
+        return true;
+
+    clear();
+    _sourceHash = sourceHash;
+
+    return false;
+}
+
+bool DerivedStatistics::getColumnStatistics(std::vector<float>& columnMins, std::vector<float>& columnRanges, std::vector<float>& columnMeans)
+{
+    if (_columnMins.empty())
+    {
+        // layout: numGenes, mins, ranges, means
+        const MappedArtifact artifact = _diskCache.open(_sourceHash, "columnStatistics");
+        ArtifactReader reader(artifact.bytes());
+
+        std::uint64_t numGenes = 0;
+        std::vector<float> mins, ranges, means;
+
+        if (!artifact.isValid() || !reader.readCount(numGenes) || !reader.readValues(numGenes, mins) || !reader.readValues(numGenes, ranges) || !reader.readValues(numGenes, means) || !reader.atEnd())
+            return false;
+
+        _columnMins = std::move(mins);
+        _columnRanges = std::move(ranges);
+        _columnMeans = std::move(means);
+
+        qDebug() << "DerivedStatistics: column statistics read from the disk cache";
+    }
+
+    columnMins = _columnMins;
+    columnRanges = _columnRanges;
+    columnMeans = _columnMeans;
+
+    return true;
+}
+
+void DerivedStatistics::setColumnStatistics(const std::vector<float>& columnMins, const std::vector<float>& columnRanges, const std::vector<float>& columnMeans)
+{
+    _columnMins = columnMins;
+    _columnRanges = columnRanges;
+    _columnMeans = columnMeans;
+
+    if (columnMins.size() != columnRanges.size() || columnMins.size() != columnMeans.size())
+        return;
+
+    ArtifactWriter writer;
+    writer.writeCount(columnMins.size());
+    writer.writeValues(std::span<const float>(columnMins));
+    writer.writeValues(std::span<const float>(columnRanges));
+    writer.writeValues(std::span<const float>(columnMeans));
+
+    _diskCache.store(_sourceHash, "columnStatistics", writer.bytes());
+}
+
+bool DerivedStatistics::getLines(const QByteArray& cellsKey, float threshold, std::vector<std::pair<std::uint32_t, std::uint32_t>>& lines)
+{
+    // layout: numLines, numLines (gene, cell) pairs
+    const MappedArtifact artifact = _diskCache.open(_sourceHash, linesArtifactName(cellsKey, threshold));
+    ArtifactReader reader(artifact.bytes());
+
+    std::uint64_t numLines = 0;
+
+    if (!artifact.isValid() || !reader.readCount(numLines) || !reader.readPairs(numLines, lines) || !reader.atEnd()) {
+        lines.clear();
+        return false;
+    }
+
+    _linesCellsKey = cellsKey;
+    _linesThreshold = threshold;
+    _hasLines = true;
+
+    qDebug() << "DerivedStatistics:" << numLines << "lines read from the disk cache";
+
+    return true;
+}
+
+void DerivedStatistics::setLines(const QByteArray& cellsKey, float threshold, const std::vector<std::pair<std::uint32_t, std::uint32_t>>& lines)
+{
+    _linesCellsKey = cellsKey;
+    _linesThreshold = threshold;
+    _hasLines = true;
+
+    ArtifactWriter writer;
+    writer.writeCount(lines.size());
+    writer.writePairs(lines);
+
+    _diskCache.store(_sourceHash, linesArtifactName(cellsKey, threshold), writer.bytes());
+}
+
+bool DerivedStatistics::getClusterSummary(const QByteArray& clustersKey, kernels::GroupColumnMoments& clusterMoments)
+{
+    // layout: numClusters, numGenes, numCells, the cluster sizes, numClusters x numGenes sums, sums of squares and positive counts,
+    // numGenes total sums, sums of squares and positive counts
+    const MappedArtifact artifact = _diskCache.open(_sourceHash, clusterSummaryArtifactName(clustersKey));
+    ArtifactReader reader(artifact.bytes());
+
+    std::uint64_t numClusters = 0, numGenes = 0, numCells = 0;
+    kernels::GroupColumnMoments moments;
+
+    if (!artifact.isValid() || !reader.readCount(numClusters) || !reader.readCount(numGenes) || !reader.readCount(numCells) || numClusters == 0)
+        return false;
+
+    const std::uint64_t numValues = numClusters * numGenes;
+
+    if (!reader.readValues(numClusters, moments.groupSizes) || !reader.readValues(numValues, moments.sums) || !reader.readValues(numValues, moments.sumSquares) ||
+        !reader.readValues(numValues, moments.numPositive) || !reader.readValues(numGenes, moments.totalSums) || !reader.readValues(numGenes, moments.totalSumSquares) ||
+        !reader.readValues(numGenes, moments.totalNumPositive) || !reader.atEnd())
+        return false;
+
+    moments.numRows = static_cast<std::int64_t>(numCells);
+    moments.numColumns = static_cast<std::int64_t>(numGenes);
+
+    _clustersKey = clustersKey;
+    clusterMoments = std::move(moments);
+
+    qDebug() << "DerivedStatistics: cluster summary read from the disk cache";
+
+    return true;
+}
+
+void DerivedStatistics::setClusterSummary(const QByteArray& clustersKey, const kernels::GroupColumnMoments& clusterMoments)
+{
+    _clustersKey = clustersKey;
+
+    if (clusterMoments.groupSizes.empty())
+        return;
+
+    ArtifactWriter writer;
+    writer.writeCount(clusterMoments.groupSizes.size());
+    writer.writeCount(clusterMoments.numColumns);
+    writer.writeCount(clusterMoments.numRows);
+    writer.writeValues(std::span<const std::int64_t>(clusterMoments.groupSizes));
+    writer.writeValues(std::span<const double>(clusterMoments.sums));
+    writer.writeValues(std::span<const double>(clusterMoments.sumSquares));
+    writer.writeValues(std::span<const std::uint32_t>(clusterMoments.numPositive));
+    writer.writeValues(std::span<const double>(clusterMoments.totalSums));
+    writer.writeValues(std::span<const double>(clusterMoments.totalSumSquares));
+    writer.writeValues(std::span<const std::uint32_t>(clusterMoments.totalNumPositive));
+
+    _diskCache.store(_sourceHash, clusterSummaryArtifactName(clustersKey), writer.bytes());
+}
+
+void DerivedStatistics::clear()
+{
+    _sourceHash.clear();
+    _columnMins.clear();
+    _columnRanges.clear();
+    _columnMeans.clear();
+    _linesCellsKey.clear();
+    _linesThreshold = 0.0f;
+    _hasLines = false;
+    _clustersKey.clear();
+}
+
+void DerivedStatistics::fromVariantMap(const QVariantMap& variantMap)
+{
+    clear();
+
+    if (variantMap.value("Version").toUInt() != blobFormatVersion) {
+        qDebug() << "DerivedStatistics: unsupported version" << variantMap.value("Version").toUInt() << ", statistics will be recomputed";
+        return;
+    }
+
+    const QByteArray data = qUncompress(QByteArray::fromBase64(variantMap.value("Data").toString().toLatin1()));
+    QDataStream stream(data);
+
+    QByteArray sourceHash;
+    stream >> sourceHash;
+
+    const bool valid = readVector(stream, _columnMins) && readVector(stream, _columnRanges) && readVector(stream, _columnMeans);
+
+    stream >> _hasLines >> _linesCellsKey >> _linesThreshold >> _clustersKey;
+
+    if (!valid || stream.status() != QDataStream::Ok || _columnMins.size() != _columnRanges.size() || _columnMins.size() != _columnMeans.size()) {
+        qDebug() << "DerivedStatistics: corrupt statistics in project, they will be recomputed";
+        clear();
+        return;
+    }
+
+    _sourceHash = sourceHash;
+
+    // the lines and the cluster summary are not part of the project, only their keys: they are read from the disk cache or recomputed
+    const bool linesCached = _hasLines && _diskCache.contains(_sourceHash, linesArtifactName(_linesCellsKey, _linesThreshold));
+    const bool clusterSummaryCached = !_clustersKey.isEmpty() && _diskCache.contains(_sourceHash, clusterSummaryArtifactName(_clustersKey));
+
+    qDebug() << "DerivedStatistics: restored statistics of" << _columnMins.size() << "genes, lines" << (linesCached ? "cached" : "not cached") << ", cluster summary" << (clusterSummaryCached ? "cached" : "not cached");
+}
+
+QVariantMap DerivedStatistics::toVariantMap() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    stream << _sourceHash;
+
+    // the column statistics are a few values per gene, all three or none are stored
+    const bool storeColumnStatistics = fitsRawBlock(_columnMins.size() * sizeof(float));
+    const std::vector<float> none;
+
+    writeVector(stream, storeColumnStatistics ? _columnMins : none);
+    writeVector(stream, storeColumnStatistics ? _columnRanges : none);
+    writeVector(stream, storeColumnStatistics ? _columnMeans : none);
+
+    // the lines and the cluster summary can take gigabytes, the project only names their disk cache artifacts
+    stream << _hasLines << _linesCellsKey << _linesThreshold << _clustersKey;
+
+    return {
+        { "Version", blobFormatVersion },
+        { "Data", QString::fromLatin1(qCompress(data).toBase64()) }
+    };
+}
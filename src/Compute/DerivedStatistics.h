@@ -0,0 +1,69 @@
+#pragma once
+
+#include "DerivedDataCache.h"
+#include "DifferentialExpression.h"
+
+#include <Dataset.h>
+#include <PointData/PointData.h>
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Statistics derived from the expression matrix of embedding B, so that loading a project does not recompute them
+// All entries belong to the expression matrix with the source hash, setting another source hash drops them
+// The small per gene column statistics are stored in the project. The line connections and the cluster summaries can be
+// very large: they are written to the shared on-disk cache only and the project stores their keys
+class DerivedStatistics
+{
+public:
+    DerivedStatistics();
+
+    // content hash of the raw values, the size and the dimension names of a points dataset (hex)
+    static QByteArray computeSourceHash(const mv::Dataset<Points>& dataset);
+
+    QByteArray getSourceHash() const { return _sourceHash; }
+
+    // returns false and drops all entries if the hash differs from the current source hash
+    bool setSourceHash(const QByteArray& sourceHash);
+
+    // per gene minimum, range and mean over all cells, returns false if they are neither in the project nor in the disk cache
+    bool getColumnStatistics(std::vector<float>& columnMins, std::vector<float>& columnRanges, std::vector<float>& columnMeans);
+    void setColumnStatistics(const std::vector<float>& columnMins, const std::vector<float>& columnRanges, const std::vector<float>& columnMeans);
+
+    // line connections at the given threshold, cellsKey identifies the cells (global indices in order) of the embedding
+    bool getLines(const QByteArray& cellsKey, float threshold, std::vector<std::pair<std::uint32_t, std::uint32_t>>& lines);
+    void setLines(const QByteArray& cellsKey, float threshold, const std::vector<std::pair<std::uint32_t, std::uint32_t>>& lines);
+
+    // per cluster, per gene moments of the expression (the cluster means and the marker genes follow from them)
+    // clustersKey identifies the clusters and their cells
+    bool getClusterSummary(const QByteArray& clustersKey, kernels::GroupColumnMoments& clusterMoments);
+    void setClusterSummary(const QByteArray& clustersKey, const kernels::GroupColumnMoments& clusterMoments);
+
+    // shared on-disk cache of the entries of all projects
+    DerivedDataCache& getDiskCache() { return _diskCache; }
+
+    void clear();
+
+public: // Serialization
+
+    // the column statistics and the keys of the disk cache artifacts are written as one compressed, versioned binary blob,
+    // unknown versions are ignored on load
+    void fromVariantMap(const QVariantMap& variantMap);
+    QVariantMap toVariantMap() const;
+
+private:
+    QByteArray                                              _sourceHash;            // content hash of the expression matrix
+    std::vector<float>                                      _columnMins;            // per gene minimum
+    std::vector<float>                                      _columnRanges;          // per gene range
+    std::vector<float>                                      _columnMeans;           // per gene mean over all cells
+    QByteArray                                              _linesCellsKey;         // key of the cells of the latest lines
+    float                                                   _linesThreshold;        // line threshold of the latest lines
+    bool                                                    _hasLines;              // whether lines were set or read for the key and the threshold
+    QByteArray                                              _clustersKey;           // key of the clusters of the latest cluster summary
+    DerivedDataCache                                        _diskCache;             // artifacts on disk shared by all projects
+};
@@ -0,0 +1,354 @@
+#include "DifferentialExpression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace
+{
+    // two-sided p value of a standard normal statistic
+    float twoSidedPValue(double statistic)
+    {
+        return static_cast<float>(std::erfc(std::abs(statistic) / std::sqrt(2.0)));
+    }
+
+    // sums over the cells of a gene in one group (the selection) and in the other cells
+    struct GroupSums
+    {
+        double  count;
+        double  sum;
+        double  sumSquares;
+        double  numPositive;
+    };
+
+    // statistics of a gene from the sums of both groups, the score and the p value are those of the Welch test
+    kernels::GeneStatistics welchStatistics(std::uint32_t gene, const GroupSums& selected, const GroupSums& rest)
+    {
+        const double meanSelected = selected.sum / selected.count;
+        const double meanRest = rest.sum / rest.count;
+
+        const double varianceSelected = selected.count > 1.0 ? std::max(0.0, (selected.sumSquares - selected.sum * meanSelected) / (selected.count - 1.0)) : 0.0;
+        const double varianceRest = rest.count > 1.0 ? std::max(0.0, (rest.sumSquares - rest.sum * meanRest) / (rest.count - 1.0)) : 0.0;
+
+        const double standardError = std::sqrt(varianceSelected / selected.count + varianceRest / rest.count);
+        const double pooledDeviation = std::sqrt((varianceSelected + varianceRest) / 2.0);
+
+        // a small epsilon instead of a pseudo count, so the fold change does not depend on the scale of the data
+        constexpr double epsilon = 1e-9;
+
+        kernels::GeneStatistics statistics;
+        statistics.gene = gene;
+        statistics.score = standardError > 0.0 ? static_cast<float>((meanSelected - meanRest) / standardError) : 0.0f;
+        statistics.effectSize = pooledDeviation > 0.0 ? static_cast<float>((meanSelected - meanRest) / pooledDeviation) : 0.0f;
+        statistics.log2FoldChange = static_cast<float>(std::log2((std::max(meanSelected, 0.0) + epsilon) / (std::max(meanRest, 0.0) + epsilon)));
+        statistics.pValue = twoSidedPValue(statistics.score);
+        statistics.fractionSelected = static_cast<float>(selected.numPositive / selected.count);
+        statistics.fractionRest = static_cast<float>(rest.numPositive / rest.count);
+
+        return statistics;
+    }
+
+    // Benjamini-Hochberg adjusted p values of the genes, numTests is the number of genes tested
+    // for a subset of the genes (the top k) the values are upper bounds of the adjusted p values over all genes
+    void adjustPValues(std::vector<kernels::GeneStatistics>& genes, std::size_t numTests)
+    {
+        std::vector<double> pValues(genes.size()), adjusted(genes.size());
+        for (std::size_t i = 0; i < genes.size(); i++)
+            pValues[i] = genes[i].pValue;
+
+        kernels::benjaminiHochberg(pValues, static_cast<double>(numTests), adjusted);
+
+        for (std::size_t i = 0; i < genes.size(); i++)
+            genes[i].adjustedPValue = static_cast<float>(adjusted[i]);
+    }
+
+    // sort by descending score, ties by gene so the result does not depend on the number of threads, keep the top k (0 for all)
+    // and adjust their p values for numTests tests
+    void keepTopGenes(std::vector<kernels::GeneStatistics>& genes, std::size_t topK, std::size_t numTests)
+    {
+        std::sort(genes.begin(), genes.end(), [](const kernels::GeneStatistics& lhs, const kernels::GeneStatistics& rhs) {
+            return lhs.score > rhs.score || (lhs.score == rhs.score && lhs.gene < rhs.gene);
+        });
+
+        if (topK > 0 && genes.size() > topK)
+            genes.resize(topK);
+
+        adjustPValues(genes, numTests);
+    }
+}
+
+namespace kernels
+{
+    void GeneRankIndex::clear()
+    {
+        *this = GeneRankIndex();
+    }
+
+    void GeneRankIndex::finalize(std::vector<std::vector<std::pair<float, std::uint32_t>>>& geneEntries, std::int64_t numCells)
+    {
+        const std::int64_t numGenes = static_cast<std::int64_t>(geneEntries.size());
+
+        _numCells = numCells;
+        _zeroRanks.assign(numGenes, 0.0f);
+        _numPositive.assign(numGenes, 0);
+        _tieCorrections.assign(numGenes, 0.0);
+        _sums.assign(numGenes, 0.0);
+        _sumSquares.assign(numGenes, 0.0);
+
+        _offsets.assign(numGenes + 1, 0);
+        for (std::int64_t gene = 0; gene < numGenes; gene++)
+            _offsets[gene + 1] = _offsets[gene] + geneEntries[gene].size();
+
+        _cells.resize(_offsets.back());
+        _midRanks.resize(_offsets.back());
+
+        const auto tieCorrection = [](double count) { return count * count * count - count; };
+
+#pragma omp parallel for schedule(dynamic)
+        for (std::int64_t gene = 0; gene < numGenes; gene++)
+        {
+            auto& entries = geneEntries[gene];
+            std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second); });
+
+            const std::int64_t numEntries = static_cast<std::int64_t>(entries.size());
+            const std::int64_t numPositive = std::partition_point(entries.begin(), entries.end(), [](const auto& entry) { return entry.first > 0.0f; }) - entries.begin();
+            const std::int64_t numNegative = numEntries - numPositive;
+            const std::int64_t numZeros = numCells - numEntries;
+
+            // the entries are in descending order, the entry at position p has ascending rank numCells - p before tie averaging
+            const std::uint64_t offset = _offsets[gene];
+            double tieSum = tieCorrection(static_cast<double>(numZeros));
+            double sum = 0.0, sumSquares = 0.0;
+
+            for (std::int64_t begin = 0; begin < numEntries;)
+            {
+                std::int64_t end = begin + 1;
+                while (end < numEntries && entries[end].first == entries[begin].first)
+                    end++;
+
+                // positions behind the zeros are shifted down by the size of the zero group
+                const std::int64_t shift = begin >= numPositive ? numZeros : 0;
+                const float midRank = static_cast<float>(numCells - shift - (begin + end - 1) / 2.0);
+
+                for (std::int64_t position = begin; position < end; position++)
+                {
+                    _cells[offset + position] = entries[position].second;
+                    _midRanks[offset + position] = midRank;
+
+                    const double value = entries[position].first;
+                    sum += value;
+                    sumSquares += value * value;
+                }
+
+                tieSum += tieCorrection(static_cast<double>(end - begin));
+                begin = end;
+            }
+
+            _zeroRanks[gene] = static_cast<float>(numNegative + (numZeros + 1) / 2.0);
+            _numPositive[gene] = static_cast<std::uint32_t>(numPositive);
+            _tieCorrections[gene] = tieSum;
+            _sums[gene] = sum;
+            _sumSquares[gene] = sumSquares;
+
+            std::vector<std::pair<float, std::uint32_t>>().swap(entries);
+        }
+    }
+
+    void differentialExpression(const GeneRankIndex& index, std::span<const std::uint32_t> selectedCells, std::span<const double> selectedSums,
+        std::span<const double> selectedSumSquares, const DifferentialExpressionSettings& settings, std::vector<GeneStatistics>& genes)
+    {
+        genes.clear();
+
+        const std::int64_t numCells = index.getNumCells();
+        const std::int64_t numGenes = std::min<std::int64_t>(index.getNumGenes(), static_cast<std::int64_t>(selectedSums.size()));
+
+        std::vector<std::uint8_t> selected(numCells, 0);
+        for (const std::uint32_t cell : selectedCells)
+            if (cell < numCells)
+                selected[cell] = 1;
+
+        const std::int64_t numSelected = std::count(selected.begin(), selected.end(), std::uint8_t(1));
+        const std::int64_t numRest = numCells - numSelected;
+
+        if (numSelected == 0 || numRest == 0)
+            return;
+
+        const double n1 = static_cast<double>(numSelected);
+        const double n2 = static_cast<double>(numRest);
+        const double n = static_cast<double>(numCells);
+
+        const bool wilcoxon = settings.test == DifferentialExpressionTest::WilcoxonRankSum;
+        const std::size_t topK = settings.topK > 0 ? std::min<std::size_t>(settings.topK, numGenes) : 0;
+
+        // z statistic of the rank sum of the selected cells
+        const auto rankSumScore = [n1, n2, n](double rankSum, double tieSum) {
+            const double u = rankSum - n1 * (n1 + 1.0) / 2.0;
+            const double variance = n1 * n2 / 12.0 * ((n + 1.0) - tieSum / (n * (n - 1.0)));
+            return variance > 0.0 ? (u - n1 * n2 / 2.0) / std::sqrt(variance) : 0.0;
+        };
+
+        // the lowest score of the top k genes, per thread: it is never higher than the k-th score over all threads, so pruning by it is safe
+        const auto byScore = [](const GeneStatistics& lhs, const GeneStatistics& rhs) { return lhs.score > rhs.score; };
+        using TopGenes = std::priority_queue<GeneStatistics, std::vector<GeneStatistics>, decltype(byScore)>;
+
+        std::vector<GeneStatistics> allGenes(topK > 0 ? 0 : numGenes);
+        std::vector<std::vector<GeneStatistics>> threadTopGenes;
+
+#pragma omp parallel
+        {
+            TopGenes topGenes(byScore);
+
+#pragma omp for schedule(dynamic, 16)
+            for (std::int64_t gene = 0; gene < numGenes; gene++)
+            {
+                const std::uint64_t begin = index._offsets[gene];
+                const std::uint64_t end = index._offsets[gene + 1];
+                const std::uint64_t positiveEnd = begin + index._numPositive[gene];
+                const double zeroRank = index._zeroRanks[gene];
+
+                const bool prune = wilcoxon && topK > 0 && topGenes.size() == topK;
+                const double threshold = prune ? topGenes.top().score : 0.0;
+
+                double rankSum = 0.0;
+                std::int64_t numSelectedEntries = 0;
+                std::int64_t numSelectedPositive = 0;
+                bool pruned = false;
+
+                for (std::uint64_t entry = begin; entry < end; entry++)
+                {
+                    if (selected[index._cells[entry]])
+                    {
+                        rankSum += index._midRanks[entry];
+                        numSelectedEntries++;
+                        numSelectedPositive += entry < positiveEnd;
+                    }
+
+                    // of the selected cells not seen yet, at most one per remaining entry has a rank up to the rank of this entry,
+                    // the others are zeros
+                    if (prune && (entry - begin) % 64 == 63)
+                    {
+                        const std::int64_t numUnseen = numSelected - numSelectedEntries;
+                        const std::int64_t numUnseenEntries = std::min<std::int64_t>(numUnseen, end - entry - 1);
+                        const double maxRankSum = rankSum + numUnseenEntries * std::max<double>(index._midRanks[entry], zeroRank) + (numUnseen - numUnseenEntries) * zeroRank;
+
+                        if (rankSumScore(maxRankSum, index._tieCorrections[gene]) <= threshold)
+                        {
+                            pruned = true;
+                            break;
+                        }
+                    }
+                }
+
+                if (pruned)
+                    continue;
+
+                const GroupSums selectedGroup = { n1, selectedSums[gene], selectedSumSquares[gene], static_cast<double>(numSelectedPositive) };
+                const GroupSums restGroup = { n2, index._sums[gene] - selectedSums[gene], index._sumSquares[gene] - selectedSumSquares[gene], static_cast<double>(index._numPositive[gene] - numSelectedPositive) };
+
+                GeneStatistics statistics = welchStatistics(static_cast<std::uint32_t>(gene), selectedGroup, restGroup);
+
+                if (wilcoxon)
+                {
+                    rankSum += (numSelected - numSelectedEntries) * zeroRank;
+                    statistics.score = static_cast<float>(rankSumScore(rankSum, index._tieCorrections[gene]));
+                    statistics.pValue = twoSidedPValue(statistics.score);
+                }
+
+                if (topK == 0)
+                {
+                    allGenes[gene] = statistics;
+                }
+                else if (topGenes.size() < topK)
+                {
+                    topGenes.push(statistics);
+                }
+                else if (statistics.score > topGenes.top().score)
+                {
+                    topGenes.pop();
+                    topGenes.push(statistics);
+                }
+            }
+
+            if (topK > 0)
+            {
+                std::vector<GeneStatistics> localGenes;
+                localGenes.reserve(topGenes.size());
+                for (; !topGenes.empty(); topGenes.pop())
+                    localGenes.push_back(topGenes.top());
+
+#pragma omp critical
+                threadTopGenes.push_back(std::move(localGenes));
+            }
+        }
+
+        if (topK > 0)
+        {
+            for (const auto& localGenes : threadTopGenes)
+                allGenes.insert(allGenes.end(), localGenes.begin(), localGenes.end());
+        }
+
+        keepTopGenes(allGenes, topK, static_cast<std::size_t>(numGenes));
+
+        genes = std::move(allGenes);
+    }
+
+    void groupMeans(const GroupColumnMoments& moments, std::vector<std::vector<float>>& means, float invalidValue)
+    {
+        const std::size_t numGroups = moments.groupSizes.size();
+        const std::size_t numColumns = static_cast<std::size_t>(moments.numColumns);
+
+        means.resize(numGroups);
+
+        for (std::size_t group = 0; group < numGroups; group++)
+        {
+            if (moments.groupSizes[group] == 0)
+            {
+                means[group].assign(numColumns, invalidValue);
+                continue;
+            }
+
+            const double groupSize = static_cast<double>(moments.groupSizes[group]);
+
+            means[group].resize(numColumns);
+            for (std::size_t column = 0; column < numColumns; column++)
+                means[group][column] = static_cast<float>(moments.sums[group * numColumns + column] / groupSize);
+        }
+    }
+
+    void rankMarkerGenes(const GroupColumnMoments& moments, std::size_t topK, std::vector<std::vector<GeneStatistics>>& markers, const CancelFlag* cancelled)
+    {
+        const std::int64_t numGroups = static_cast<std::int64_t>(moments.groupSizes.size());
+        const std::int64_t numColumns = moments.numColumns;
+        const double numRows = static_cast<double>(moments.numRows);
+
+        markers.assign(numGroups, {});
+
+#pragma omp parallel for schedule(dynamic)
+        for (std::int64_t group = 0; group < numGroups; group++)
+        {
+            // like an empty selection or a selection of all cells
+            const double groupSize = static_cast<double>(moments.groupSizes[group]);
+            if (groupSize == 0.0 || groupSize == numRows || isCancelled(cancelled))
+                continue;
+
+            std::vector<GeneStatistics> genes(numColumns);
+            for (std::int64_t column = 0; column < numColumns; column++)
+            {
+                const std::int64_t index = group * numColumns + column;
+
+                const GroupSums groupSums = { groupSize, moments.sums[index], moments.sumSquares[index], static_cast<double>(moments.numPositive[index]) };
+                const GroupSums restSums = { numRows - groupSize, moments.totalSums[column] - moments.sums[index], moments.totalSumSquares[column] - moments.sumSquares[index],
+                    static_cast<double>(moments.totalNumPositive[column] - moments.numPositive[index]) };
+
+                genes[column] = welchStatistics(static_cast<std::uint32_t>(column), groupSums, restSums);
+            }
+
+            keepTopGenes(genes, topK, static_cast<std::size_t>(numColumns));
+
+            markers[group] = std::move(genes);
+        }
+    }
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "ComputeKernels.h"
+
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Differential expression of a selection of cells vs the rest of the cells, for all genes at once
+// The rank sums of the Wilcoxon test come from a rank index that is built once per expression matrix: a selection only visits the
+// non-zero entries of every gene instead of sorting the gene again. Like ComputeKernels.h this needs no running ManiVault core
+namespace kernels
+{
+    enum class DifferentialExpressionTest
+    {
+        WilcoxonRankSum,    // Mann-Whitney U with tie correction, normal approximation
+        WelchTTest          // unequal variance t-test, normal approximation (the groups are large)
+    };
+
+    struct DifferentialExpressionSettings
+    {
+        DifferentialExpressionTest  test    = DifferentialExpressionTest::WilcoxonRankSum;
+        std::size_t                 topK    = 0;        // only the genes with the highest scores, 0 for all genes
+    };
+
+    struct GeneStatistics
+    {
+        std::uint32_t   gene                = 0;
+        float           score               = 0.0f;     // z (Wilcoxon) or t (Welch) statistic, positive if higher in the selection
+        float           effectSize          = 0.0f;     // difference of the means in units of the pooled standard deviation (Cohen's d)
+        float           log2FoldChange      = 0.0f;     // of the mean in the selection over the mean in the rest
+        float           pValue              = 1.0f;     // two-sided
+        float           adjustedPValue      = 1.0f;     // Benjamini-Hochberg over all genes (an upper bound for the top k genes)
+        float           fractionSelected    = 0.0f;     // fraction of the selected cells with a positive value
+        float           fractionRest        = 0.0f;     // fraction of the other cells with a positive value
+    };
+
+    // cells of every gene in descending order of their value, with their mid rank (tied values share the mean of their ranks)
+    // only non-zero values are stored: the zeros of a gene are one tie group whose rank follows from the counts, so the index of a
+    // sparse expression matrix is about as large as its non-zero values
+    class GeneRankIndex
+    {
+    public:
+        template <typename T>
+        void build(const MatrixView<T>& matrix);
+
+        void clear();
+
+        bool isEmpty() const { return _numCells == 0; }
+        std::int64_t getNumCells() const { return _numCells; }
+        std::int64_t getNumGenes() const { return static_cast<std::int64_t>(_zeroRanks.size()); }
+
+    private:
+        // sorts and ranks the non-zero (value, cell) entries of every gene
+        void finalize(std::vector<std::vector<std::pair<float, std::uint32_t>>>& geneEntries, std::int64_t numCells);
+
+        friend void differentialExpression(const GeneRankIndex&, std::span<const std::uint32_t>, std::span<const double>, std::span<const double>, const DifferentialExpressionSettings&, std::vector<GeneStatistics>&);
+
+        std::int64_t                _numCells = 0;
+        std::vector<std::uint64_t>  _offsets;           // start of the entries of every gene, numGenes + 1 entries
+        std::vector<std::uint32_t>  _cells;             // non-zero cells of every gene, by descending value
+        std::vector<float>          _midRanks;          // ascending rank (1 based) of every entry
+        std::vector<float>          _zeroRanks;         // mid rank of the zeros of every gene
+        std::vector<std::uint32_t>  _numPositive;       // the first entries of a gene that have a positive value
+        std::vector<double>         _tieCorrections;    // sum of t^3 - t over the tie groups of every gene, zeros included
+        std::vector<double>         _sums;              // sum of every gene over all cells
+        std::vector<double>         _sumSquares;        // sum of squares of every gene over all cells
+    };
+
+    template <typename T>
+    void GeneRankIndex::build(const MatrixView<T>& matrix)
+    {
+        const std::int64_t numGenes = matrix.numColumns;
+        std::vector<std::vector<std::pair<float, std::uint32_t>>> geneEntries(numGenes);
+
+        // a block of genes reads a contiguous part of every row
+        const std::int64_t blockSize = 64;
+        const std::int64_t numBlocks = (numGenes + blockSize - 1) / blockSize;
+
+#pragma omp parallel for schedule(dynamic)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t end = std::min(numGenes, (block + 1) * blockSize);
+
+            for (std::int64_t row = 0; row < matrix.numRows; row++)
+            {
+                const T* values = matrix.row(row);
+                for (std::int64_t gene = block * blockSize; gene < end; gene++)
+                {
+                    const float value = static_cast<float>(values[gene]);
+                    if (value != 0.0f)
+                        geneEntries[gene].emplace_back(value, static_cast<std::uint32_t>(row));
+                }
+            }
+        }
+
+        finalize(geneEntries, matrix.numRows);
+    }
+
+    // sum and sum of squares of each column over the given rows
+    template <typename T>
+    void columnSumsOverRows(const MatrixView<T>& matrix, std::span<const std::uint32_t> rows, std::vector<double>& sums, std::vector<double>& sumSquares)
+    {
+        const std::int64_t numColumns = matrix.numColumns;
+        const std::int64_t numRows = static_cast<std::int64_t>(rows.size());
+
+        sums.assign(numColumns, 0.0);
+        sumSquares.assign(numColumns, 0.0);
+
+#pragma omp parallel
+        {
+            std::vector<double> localSums(numColumns, 0.0);
+            std::vector<double> localSumSquares(numColumns, 0.0);
+
+#pragma omp for nowait
+            for (std::int64_t i = 0; i < numRows; i++)
+            {
+                const T* values = matrix.row(rows[i]);
+                for (std::int64_t column = 0; column < numColumns; column++)
+                {
+                    const double value = static_cast<float>(values[column]);
+                    localSums[column] += value;
+                    localSumSquares[column] += value * value;
+                }
+            }
+
+#pragma omp critical
+            for (std::int64_t column = 0; column < numColumns; column++)
+            {
+                sums[column] += localSums[column];
+                sumSquares[column] += localSumSquares[column];
+            }
+        }
+    }
+
+    // statistics of every gene (or of the top k genes) of the selected cells vs the other cells of the index, by descending score
+    // selectedSums and selectedSumSquares are the column sums over the selected cells, see columnSumsOverRows
+    // with topK and the Wilcoxon test a gene is skipped as soon as its rank sum can no longer reach the top k
+    void differentialExpression(const GeneRankIndex& index, std::span<const std::uint32_t> selectedCells, std::span<const double> selectedSums,
+        std::span<const double> selectedSumSquares, const DifferentialExpressionSettings& settings, std::vector<GeneStatistics>& genes);
+
+    // sums over the cells of every group (e.g. the clusters of a cluster dataset) and over all cells, per gene
+    struct GroupColumnMoments
+    {
+        std::int64_t                numRows     = 0;
+        std::int64_t                numColumns  = 0;
+        std::vector<std::int64_t>   groupSizes;             // number of cells of every group
+        std::vector<double>         sums;                   // group x column sums
+        std::vector<double>         sumSquares;             // group x column sums of squares
+        std::vector<std::uint32_t>  numPositive;            // group x column counts of positive values
+        std::vector<double>         totalSums;              // column sums over all cells
+        std::vector<double>         totalSumSquares;        // column sums of squares over all cells
+        std::vector<std::uint32_t>  totalNumPositive;       // column counts of positive values over all cells
+    };
+
+    // moments of every group of rows and of all rows in one pass over the matrix, rows may be in several groups
+    // cancelled is checked per block of columns, the moments of a cancelled pass are incomplete
+    template <typename T>
+    void groupColumnMoments(const MatrixView<T>& matrix, const std::vector<std::vector<std::uint32_t>>& groupRows, GroupColumnMoments& moments, const CancelFlag* cancelled = nullptr)
+    {
+        const std::int64_t numGroups = static_cast<std::int64_t>(groupRows.size());
+        const std::int64_t numColumns = matrix.numColumns;
+
+        moments.numRows = matrix.numRows;
+        moments.numColumns = numColumns;
+        moments.groupSizes.assign(numGroups, 0);
+        moments.sums.assign(numGroups * numColumns, 0.0);
+        moments.sumSquares.assign(numGroups * numColumns, 0.0);
+        moments.numPositive.assign(numGroups * numColumns, 0);
+        moments.totalSums.assign(numColumns, 0.0);
+        moments.totalSumSquares.assign(numColumns, 0.0);
+        moments.totalNumPositive.assign(numColumns, 0);
+
+        // groups of every row in compressed row format
+        std::vector<std::uint32_t> rowOffsets(matrix.numRows + 1, 0);
+        for (std::int64_t group = 0; group < numGroups; group++)
+            for (const std::uint32_t row : groupRows[group])
+                if (row < matrix.numRows)
+                {
+                    rowOffsets[row + 1]++;
+                    moments.groupSizes[group]++;
+                }
+
+        std::partial_sum(rowOffsets.begin(), rowOffsets.end(), rowOffsets.begin());
+
+        std::vector<std::uint32_t> fill(rowOffsets.begin(), rowOffsets.end() - 1);
+        std::vector<std::uint32_t> rowGroups(rowOffsets.back());
+        for (std::int64_t group = 0; group < numGroups; group++)
+            for (const std::uint32_t row : groupRows[group])
+                if (row < matrix.numRows)
+                    rowGroups[fill[row]++] = static_cast<std::uint32_t>(group);
+
+        // every thread owns a block of columns, so the moments need no per thread copies, a block reads a contiguous part of every row
+        const std::int64_t blockSize = 64;
+        const std::int64_t numBlocks = (numColumns + blockSize - 1) / blockSize;
+
+#pragma omp parallel for schedule(dynamic)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            if (isCancelled(cancelled))
+                continue;
+
+            const std::int64_t begin = block * blockSize;
+            const std::int64_t end = std::min(numColumns, begin + blockSize);
+
+            for (std::int64_t row = 0; row < matrix.numRows; row++)
+            {
+                const T* values = matrix.row(row);
+
+                for (std::int64_t column = begin; column < end; column++)
+                {
+                    const double value = static_cast<float>(values[column]);
+                    if (value == 0.0)
+                        continue;
+
+                    moments.totalSums[column] += value;
+                    moments.totalSumSquares[column] += value * value;
+                    moments.totalNumPositive[column] += value > 0.0;
+
+                    for (std::uint32_t i = rowOffsets[row]; i < rowOffsets[row + 1]; i++)
+                    {
+                        const std::int64_t index = rowGroups[i] * numColumns + column;
+                        moments.sums[index] += value;
+                        moments.sumSquares[index] += value * value;
+                        moments.numPositive[index] += value > 0.0;
+                    }
+                }
+            }
+        }
+    }
+
+    // mean of each column for each group from its moments, groups without rows get invalidValue like in groupColumnMeans
+    void groupMeans(const GroupColumnMoments& moments, std::vector<std::vector<float>>& means, float invalidValue = -100.0f);
+
+    // marker genes of every group vs all other cells: what differentialExpression gives with the Welch test and the same topK for a
+    // selection of exactly the cells of the group, by descending score and adjusted over all columns (the Wilcoxon test needs the
+    // ranks of the cells, it can not be computed from moments)
+    // cancelled is checked per group, the groups not ranked yet are left empty
+    void rankMarkerGenes(const GroupColumnMoments& moments, std::size_t topK, std::vector<std::vector<GeneStatistics>>& markers, const CancelFlag* cancelled = nullptr);
+
+    // the same for an expression matrix whose rows are the cells of the index
+    template <typename T>
+    void differentialExpression(const MatrixView<T>& matrix, const GeneRankIndex& index, std::span<const std::uint32_t> selectedCells,
+        const DifferentialExpressionSettings& settings, std::vector<GeneStatistics>& genes)
+    {
+        std::vector<double> selectedSums, selectedSumSquares;
+        columnSumsOverRows(matrix, selectedCells, selectedSums, selectedSumSquares);
+
+        differentialExpression(index, selectedCells, selectedSums, selectedSumSquares, settings, genes);
+    }
+}
@@ -1,10 +1,145 @@
 #include "EnrichmentAnalysis.h"
 
+#include "PerformanceTrace.h"
+
+#include <QProcessEnvironment>
+
+namespace
+{
+    const char* defaultGprofilerBaseUrl = "https://biit.cs.ut.ee/gprofiler/api/";
+
+    const int defaultDebounceInterval = 250; // ms
+
+    // whether an error reply body complains about the content encoding of the request
+    bool isEncodingError(const QByteArray& replyBody)
+    {
+        const QByteArray body = replyBody.toLower();
+
+        return body.contains("encoding") || body.contains("deflate") || body.contains("decompress");
+    }
+}
 
 EnrichmentAnalysis::EnrichmentAnalysis(QObject* parent)
-    : QObject(parent), networkManager(new QNetworkAccessManager(this))
+    : QObject(parent), networkManager(new QNetworkAccessManager(this)),
+    _gprofilerBaseUrl(QProcessEnvironment::systemEnvironment().value("DUALVIEW_GPROFILER_URL", defaultGprofilerBaseUrl)),
+    _cache(),
+    _provider(Provider::Gprofiler),
+    _localEnrichment(),
+    _loadJobs(this),
+    _debounceTimer(),
+    _pendingRequest(),
+    _requestGeneration(0),
+    _goTermGeneration(0),
+    _enrichmentReply(),
+    _goTermReply(),
+    _background(),
+    _backgroundFingerprint(EnrichmentCache::fingerprint(QStringList())),
+    _backgroundJson(),
+    _requestCompression(QProcessEnvironment::systemEnvironment().value("DUALVIEW_GPROFILER_COMPRESS") == "1" ? RequestCompression::Probing : RequestCompression::Off)
 {
     qDebug() << "EnrichmentAnalysis constructor called, this=" << this;
+
+    _debounceTimer.setSingleShot(true);
+    _debounceTimer.setInterval(defaultDebounceInterval);
+
+    connect(&_debounceTimer, &QTimer::timeout, this, &EnrichmentAnalysis::runPendingEnrichment);
+}
+
+void EnrichmentAnalysis::postGeneEnrichment(const QStringList& query, const QString& species, const QString& method)
+{
+    _pendingRequest = { query, species, method };
+    _requestGeneration++;
+
+    // the in-flight request is superseded, its result would be discarded anyway
+    abortReply(_enrichmentReply);
+
+    _debounceTimer.start();
+}
+
+void EnrichmentAnalysis::runPendingEnrichment()
+{
+    TRACE_JOB("EnrichmentAnalysis::runPendingEnrichment");
+
+    const auto& [query, species, method] = _pendingRequest;
+
+    if (_provider == Provider::Gprofiler) {
+        postGeneGprofiler(query, species, method);
+        return;
+    }
+
+    // gene set files are species specific, so the species is determined by the loaded file
+    if (!_localEnrichment.isLoaded()) {
+        qDebug() << "EnrichmentAnalysis: no gene set file loaded for local enrichment";
+        emit enrichmentDataNotExists();
+        return;
+    }
+
+    // the local backend keeps the background mask as long as the same background list is passed
+    emitEnrichmentResult(_localEnrichment.enrich(query, _background, method));
+}
+
+bool EnrichmentAnalysis::loadLocalGeneSets(const QString& gmtFilePath, const QString& oboFilePath)
+{
+    const bool loadGmt = !gmtFilePath.isEmpty() && gmtFilePath != _localEnrichment.getGmtFilePath();
+    const bool loadObo = !oboFilePath.isEmpty() && oboFilePath != _localEnrichment.getOboFilePath();
+
+    if (!loadGmt && !loadObo)
+        return false;
+
+    // parsing a GMT or OBO file takes seconds, the files are loaded into a separate object that replaces the loaded parts
+    _loadJobs.start(0, "Local gene set loading", [this, gmtFilePath, oboFilePath, loadGmt, loadObo](const kernels::CancelFlag&) -> BackgroundJobs::Publish {
+        auto loaded = std::make_shared<LocalEnrichment>();
+
+        if (loadGmt)
+            loaded->loadGmt(gmtFilePath);
+
+        if (loadObo)
+            loaded->loadObo(oboFilePath);
+
+        return [this, loaded]() {
+            _localEnrichment.takeLoaded(std::move(*loaded));
+            emit localGeneSetsLoaded();
+        };
+    });
+
+    return true;
+}
+
+void EnrichmentAnalysis::postGOtermGenes(const QString& GOTermId, const QString& species)
+{
+    if (_provider == Provider::Gprofiler) {
+        postGOtermGprofiler(GOTermId, species);
+        return;
+    }
+
+    // a pending g:Profiler reply of an earlier term is superseded
+    _goTermGeneration++;
+    abortReply(_goTermReply);
+
+    const QStringList geneNames = _localEnrichment.getTermGenes(GOTermId);
+
+    if (geneNames.isEmpty()) {
+        qDebug() << "EnrichmentAnalysis:" << GOTermId << "is not in the loaded gene set file";
+        return;
+    }
+
+    emit genesFromGOtermDataReady(geneNames);
+}
+
+void EnrichmentAnalysis::setBackground(const QStringList& background)
+{
+    if (background == _background)
+        return;
+
+    _background = background;
+    _backgroundFingerprint = EnrichmentCache::fingerprint(_background);
+
+    // serialize once, instead of converting the (possibly tens of thousands of) names for every query
+    _backgroundJson.clear();
+    if (!_background.isEmpty())
+        _backgroundJson = QJsonDocument(QJsonArray::fromStringList(_background)).toJson(QJsonDocument::Compact);
+
+    qDebug() << "EnrichmentAnalysis: background set," << _background.size() << "genes," << _backgroundJson.size() << "bytes";
 }
 
 void EnrichmentAnalysis::lookupSymbolsToppGene(const QStringList& symbols) {
@@ -214,10 +349,18 @@ void EnrichmentAnalysis::handleEnrichmentReplyToppGene() {
     reply->deleteLater();
 }
 
-void EnrichmentAnalysis::postGeneGprofiler(const QStringList& query, const QStringList& background, const QString& species, const QString& method) { 
+void EnrichmentAnalysis::postGeneGprofiler(const QStringList& query, const QString& species, const QString& method) { 
     //qDebug() << "gprofiler begin...";
 
-    QUrl url("https://biit.cs.ut.ee/gprofiler/api/gost/profile/");
+    // identical queries are answered from the cache, also when offline
+    const QByteArray cacheKey = EnrichmentCache::fingerprint(query, _backgroundFingerprint, species, method);
+
+    QVariantList cachedResult;
+    if (_cache.lookup(cacheKey, cachedResult)) {
+        qDebug() << "Gprofiler: result found in cache" << cacheKey;
+        emitEnrichmentResult(cachedResult);
+        return;
+    }
 
     QJsonObject json;
     json["organism"] = species; // TO DO: hard-coded for mouse dataset
@@ -230,26 +373,88 @@ void EnrichmentAnalysis::postGeneGprofiler(const QStringList& query, const QStri
     // test
     json["highlight"] = "true";
    
-    if (!background.isEmpty()) {
+    if (!_backgroundJson.isEmpty())
         json["domain_scope"] = "custom";
-        json["background"] = QJsonArray::fromStringList(background);
+
+    QByteArray jsonData = QJsonDocument(json).toJson(QJsonDocument::Compact);
+
+    // g:Profiler has no server-side reference for a custom background, so the pre-serialized background is spliced into the object
+    if (!_backgroundJson.isEmpty()) {
+        jsonData.chop(1); // closing brace
+        jsonData += ",\"background\":" + _backgroundJson + "}";
     }   // else background is empty 
 
-    QJsonDocument document(json);
-    QByteArray jsonData = document.toJson();
+    abortReply(_enrichmentReply);
 
-    QNetworkRequest request(url);
+    postGprofilerProfileRequest(jsonData, cacheKey);
+}
+
+void EnrichmentAnalysis::postGprofilerProfileRequest(const QByteArray& body, const QByteArray& cacheKey)
+{
+    QNetworkRequest request(_gprofilerBaseUrl.resolved(QUrl("gost/profile/")));
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
-    QNetworkReply* reply = networkManager->post(request, jsonData);
+    QByteArray payload = body;
+
+    const bool compressed = _requestCompression != RequestCompression::Off;
+
+    if (compressed) {
+        // qCompress produces a zlib stream prefixed with the 4 byte uncompressed size, which is what "deflate" expects without the prefix
+        payload = qCompress(body).mid(4);
+        request.setRawHeader("Content-Encoding", "deflate");
+    }
+
+    trace::beginAsync("g:Profiler enrichment request", _requestGeneration);
+
+    QNetworkReply* reply = networkManager->post(request, payload);
+    reply->setProperty("cacheKey", cacheKey);
+    reply->setProperty("generation", _requestGeneration);
+    reply->setProperty("compressed", compressed);
+
+    // kept while probing, to resend uncompressed once if the server does not accept compressed requests
+    if (_requestCompression == RequestCompression::Probing)
+        reply->setProperty("body", body);
+
     connect(reply, &QNetworkReply::finished, this, &EnrichmentAnalysis::handleEnrichmentReplyGprofiler);
+
+    _enrichmentReply = reply;
 }
 
 void EnrichmentAnalysis::handleEnrichmentReplyGprofiler() {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
 
+    if (reply)
+        trace::endAsync("g:Profiler enrichment request", reply->property("generation").toULongLong());
+
+    TRACE_JOB("EnrichmentAnalysis::handleEnrichmentReplyGprofiler");
+
+    // results of superseded requests must not overwrite the latest one
+    if (!isCurrentReply(reply, _requestGeneration)) {
+        qDebug() << "Gprofiler reply discarded: superseded by a newer request";
+        if (reply)
+            reply->deleteLater();
+        return;
+    }
+
     //qDebug() << "start to handle gprofiler reply...";
 
+    // the first compressed reply settles the probe: only a rejected content encoding switches compression off and is
+    // resent uncompressed, any other failure is reported as is
+    if (reply->property("compressed").toBool() && _requestCompression == RequestCompression::Probing) {
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+        if (reply->error() == QNetworkReply::NoError) {
+            _requestCompression = RequestCompression::On;
+        }
+        else if (status == 415 || (status == 400 && isEncodingError(reply->peek(4096)))) {
+            qDebug() << "Gprofiler rejected the compressed request (HTTP" << status << "), requests are sent uncompressed from now on";
+            _requestCompression = RequestCompression::Off;
+            postGprofilerProfileRequest(reply->property("body").toByteArray(), reply->property("cacheKey").toByteArray());
+            reply->deleteLater();
+            return;
+        }
+    }
+
     if (reply && reply->error() == QNetworkReply::NoError) {
         QByteArray responseData = reply->readAll();
 
@@ -306,13 +511,16 @@ void EnrichmentAnalysis::handleEnrichmentReplyGprofiler() {
                 }
             }
 
-            if (validResultsFound) {
-                emit enrichmentDataReady(outputList);           
-            }
-            else {
+            if (!validResultsFound)
                 qDebug() << "Gprofiler reply warning: no result found";
-                emit enrichmentDataNotExists();
-            }
+
+            // results of a new data release of g:Profiler replace the cached results of the previous one
+            _cache.setDataVersion(jsonObject["meta"].toObject()["version"].toString());
+
+            // an empty list is cached as well, it records that the query has no enriched terms
+            _cache.insert(reply->property("cacheKey").toByteArray(), outputList);
+
+            emitEnrichmentResult(outputList);
         }
         else {
             // The 'result' key does not exist or is not an array
@@ -329,7 +537,7 @@ void EnrichmentAnalysis::handleEnrichmentReplyGprofiler() {
 void EnrichmentAnalysis::postGOtermGprofiler(const QString& GOTermId, const QString& species) {
 	qDebug() << "gprofiler begin...";
 
-	QUrl url("https://biit.cs.ut.ee/gprofiler/api/convert/convert/");
+	QUrl url = _gprofilerBaseUrl.resolved(QUrl("convert/convert/"));
 
 	QJsonObject json;
 	json["organism"] = species; // TO DO: hard-coded for mouse dataset
@@ -343,14 +551,32 @@ void EnrichmentAnalysis::postGOtermGprofiler(const QString& GOTermId, const QStr
 	QNetworkRequest request(url);
 	request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
+	_goTermGeneration++;
+	abortReply(_goTermReply);
+
+	trace::beginAsync("g:Profiler GO term request", _goTermGeneration);
+
 	QNetworkReply* reply = networkManager->post(request, jsonData);
+	reply->setProperty("generation", _goTermGeneration);
 	connect(reply, &QNetworkReply::finished, this, &EnrichmentAnalysis::handleGOtermReplyGprofiler);
+
+	_goTermReply = reply;
 }
 
 void EnrichmentAnalysis::handleGOtermReplyGprofiler()
 {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
 
+    if (reply)
+        trace::endAsync("g:Profiler GO term request", reply->property("generation").toULongLong());
+
+    if (!isCurrentReply(reply, _goTermGeneration)) {
+        qDebug() << "Gprofiler GO term convert reply discarded: superseded by a newer request";
+        if (reply)
+            reply->deleteLater();
+        return;
+    }
+
     qDebug() << "start to handle gprofiler reply...";
 
     if (reply && reply->error() == QNetworkReply::NoError) {
@@ -394,3 +620,26 @@ void EnrichmentAnalysis::handleGOtermReplyGprofiler()
     qDebug() << "Finished handle gprofiler reply...";
 }
 
+void EnrichmentAnalysis::emitEnrichmentResult(const QVariantList& outputList)
+{
+    if (outputList.isEmpty())
+        emit enrichmentDataNotExists();
+    else
+        emit enrichmentDataReady(outputList);
+}
+
+void EnrichmentAnalysis::abortReply(QPointer<QNetworkReply>& reply)
+{
+    if (reply && reply->isRunning())
+        reply->abort(); // emits finished, the handler then discards the reply
+
+    reply.clear();
+}
+
+bool EnrichmentAnalysis::isCurrentReply(QNetworkReply* reply, quint64 currentGeneration) const
+{
+    if (!reply || reply->error() == QNetworkReply::OperationCanceledError)
+        return false;
+
+    return reply->property("generation").toULongLong() == currentGeneration;
+}
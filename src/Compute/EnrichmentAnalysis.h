@@ -7,24 +7,85 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QNetworkRequest>
+#include <QUrl>
+#include <QTimer>
+#include <QPointer>
+
+#include "BackgroundJobs.h"
+#include "EnrichmentCache.h"
+#include "LocalEnrichment.h"
 
 class EnrichmentAnalysis : public QObject
 {
     Q_OBJECT
 
+public:
+    // where enrichment results come from
+    enum class Provider {
+        Gprofiler,      // g:Profiler web service
+        Local           // offline gene set files, see LocalEnrichment
+    };
+
+    // whether gost/profile request bodies are sent deflate compressed
+    enum class RequestCompression {
+        Off,            // never compress (default, not every server accepts compressed request bodies)
+        Probing,        // compress, the first reply tells whether the server accepts it
+        On              // the server accepted a compressed request
+    };
+
 public:
     explicit EnrichmentAnalysis(QObject* parent = nullptr);
 
+    Provider getProvider() const { return _provider; }
+    void setProvider(Provider provider) { _provider = provider; }
+
+    // offline enrichment backend, gene sets are loaded with loadLocalGeneSets
+    LocalEnrichment& getLocalEnrichment() { return _localEnrichment; }
+
+    // load the gene set and ontology files of the offline backend on a worker thread, localGeneSetsLoaded is emitted when
+    // they are in place, paths that are empty or already loaded are skipped, returns false if there is nothing to load
+    bool loadLocalGeneSets(const QString& gmtFilePath, const QString& oboFilePath);
+
+    // genes of a GO term with the current provider, they are emitted with genesFromGOtermDataReady
+    void postGOtermGenes(const QString& GOTermId, const QString& species);
+
+    // schedule the enrichment analysis with the current provider, results are emitted with enrichmentDataReady/enrichmentDataNotExists
+    // triggers within the debounce interval are coalesced into one request and superseded requests are aborted,
+    // so only the result of the latest request is emitted
+    void postGeneEnrichment(const QStringList& query, const QString& species, const QString& method);
+
+    // set the background genes of the current dataset, they are prepared once and reused by all later queries
+    void setBackground(const QStringList& background);
+    const QStringList& getBackground() const { return _background; }
+
+    // debounce interval for postGeneEnrichment in milliseconds
+    int getDebounceInterval() const { return _debounceTimer.interval(); }
+    void setDebounceInterval(int milliseconds) { _debounceTimer.setInterval(milliseconds); }
+
+    // generation of the latest enrichment request, results of older generations are discarded
+    quint64 getRequestGeneration() const { return _requestGeneration; }
+
     // ToppGene
     void lookupSymbolsToppGene(const QStringList& symbols);
     void postGeneToppGene(const QJsonArray& entrezIds);
 
-    // gProfiler
-    void postGeneGprofiler(const QStringList& query, const QStringList& background, const QString& species, const QString& method); 
+    // gProfiler, uses the background set with setBackground
+    void postGeneGprofiler(const QStringList& query, const QString& species, const QString& method); 
 
     // gProfiler post GO term ID and get gene list
     void postGOtermGprofiler(const QString& GOTermId, const QString& species);
 
+    // gProfiler API base url, defaults to the public server or the DUALVIEW_GPROFILER_URL environment variable (e.g. a local stand-in server)
+    QUrl getGprofilerBaseUrl() const { return _gprofilerBaseUrl; }
+    void setGprofilerBaseUrl(const QUrl& baseUrl) { _gprofilerBaseUrl = baseUrl; }
+
+    // compressing request bodies is opt-in: enabling it (or setting DUALVIEW_GPROFILER_COMPRESS=1) probes the server once
+    bool getCompressRequests() const { return _requestCompression != RequestCompression::Off; }
+    void setCompressRequests(bool compressRequests) { _requestCompression = compressRequests ? RequestCompression::Probing : RequestCompression::Off; }
+
+    // cache of the gProfiler enrichment results
+    EnrichmentCache& getCache() { return _cache; }
+
 signals:
     void enrichmentDataReady(const QVariantList& outputList);
 
@@ -33,6 +94,8 @@ signals:
     //void genesFromGOtermDataReady(const QVariantList& outputList);
     void genesFromGOtermDataReady(const QStringList& outputList);
 
+    void localGeneSetsLoaded();
+
 private slots:
     // ToppGene
     void handleLookupReplyToppGene();
@@ -43,6 +106,48 @@ private slots:
 
     void handleGOtermReplyGprofiler();
 
+    // run the request that was last scheduled with postGeneEnrichment
+    void runPendingEnrichment();
+
+private:
+    // abort an in-flight reply that is superseded by a newer request
+    void abortReply(QPointer<QNetworkReply>& reply);
+
+    // true if the reply belongs to the latest request of its kind
+    bool isCurrentReply(QNetworkReply* reply, quint64 currentGeneration) const;
+
+    // post a gost/profile request body, compressed if compression is enabled and the server did not reject it
+    void postGprofilerProfileRequest(const QByteArray& body, const QByteArray& cacheKey);
+
+    // emit enrichmentDataReady or enrichmentDataNotExists for a (cached) result
+    void emitEnrichmentResult(const QVariantList& outputList);
+
 private:
     QNetworkAccessManager* networkManager;  
+    QUrl                   _gprofilerBaseUrl;   // base url of the gProfiler API
+    EnrichmentCache        _cache;              // results of previous gProfiler enrichment queries
+    Provider               _provider;           // current enrichment provider
+    LocalEnrichment        _localEnrichment;    // offline enrichment backend
+    BackgroundJobs         _loadJobs;           // loads the offline gene set files, a single lane
+
+    // request scheduling
+    struct EnrichmentRequest
+    {
+        QStringList query;
+        QString     species;
+        QString     method;
+    };
+
+    QTimer                  _debounceTimer;         // coalesces enrichment triggers
+    EnrichmentRequest       _pendingRequest;        // latest scheduled enrichment request
+    quint64                 _requestGeneration;     // incremented for every scheduled enrichment request
+    quint64                 _goTermGeneration;      // incremented for every GO term request
+    QPointer<QNetworkReply> _enrichmentReply;       // in-flight enrichment reply
+    QPointer<QNetworkReply> _goTermReply;           // in-flight GO term reply
+
+    // background genes, prepared once per dataset
+    QStringList             _background;            // background genes
+    QByteArray              _backgroundFingerprint; // order independent hash of the background, part of the cache key
+    QByteArray              _backgroundJson;        // background serialized as compact JSON array, spliced into each request
+    RequestCompression      _requestCompression;    // whether request bodies are sent deflate compressed
 };
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "EnrichmentCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+namespace
+{
+    // bump when the layout of the cached results changes, older entries are then ignored
+    const quint32 cacheFormatVersion = 1;
+
+    const int defaultMaxAgeDays = 30;
+
+    const int maxMemoryEntries = 256;
+
+    // file in the cache directory with the data version of the entries
+    const char* dataVersionFileName = "dataVersion.txt";
+
+    void addSortedList(QCryptographicHash& hash, QStringList list)
+    {
+        std::sort(list.begin(), list.end());
+
+        hash.addData(QByteArray::number(list.size()));
+
+        for (const QString& item : list) {
+            hash.addData(item.toUtf8());
+            hash.addData(QByteArrayView("\n"));
+        }
+    }
+}
+
+EnrichmentCache::EnrichmentCache() :
+    _cacheDirectory(),
+    _dataVersion(),
+    _maxSize(defaultMaxSize),
+    _maxAgeDays(defaultMaxAgeDays),
+    _entries(maxMemoryEntries)
+{
+    setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/DualView/EnrichmentCache");
+}
+
+QByteArray EnrichmentCache::fingerprint(const QStringList& genes)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    addSortedList(hash, genes);
+
+    return hash.result().toHex();
+}
+
+QByteArray EnrichmentCache::fingerprint(const QStringList& query, const QByteArray& backgroundFingerprint, const QString& species, const QString& method)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    addSortedList(hash, query);
+
+    hash.addData(backgroundFingerprint);
+    hash.addData(QByteArrayView("\n"));
+
+    hash.addData(species.toUtf8());
+    hash.addData(QByteArrayView("\n"));
+    hash.addData(method.toUtf8());
+
+    return hash.result().toHex();
+}
+
+bool EnrichmentCache::lookup(const QByteArray& key, QVariantList& result)
+{
+    if (const QVariantList* entry = _entries.object(key)) {
+        result = *entry;
+        return true;
+    }
+
+    if (_cacheDirectory.isEmpty() || _maxSize == 0)
+        return false;
+
+    QFile file(entryFilePath(key));
+
+    // setting the file time needs write access on Windows, read-only entries are still read
+    if (!file.open(QIODevice::ReadWrite | QIODevice::ExistingOnly) && !file.open(QIODevice::ReadOnly))
+        return false;
+
+    // results of an old lookup may be outdated even if the service did not announce a new data version
+    if (file.fileTime(QFileDevice::FileModificationTime).daysTo(QDateTime::currentDateTime()) > _maxAgeDays) {
+        file.remove();
+        return false;
+    }
+
+    QByteArray data = qUncompress(file.readAll());
+    QDataStream stream(data);
+
+    quint32 version = 0;
+    QVariantList entry;
+
+    stream >> version;
+
+    if (version != cacheFormatVersion)
+        return false;
+
+    stream >> entry;
+
+    if (stream.status() != QDataStream::Ok) {
+        qDebug() << "EnrichmentCache::lookup: corrupt cache entry" << file.fileName();
+        return false;
+    }
+
+    // the access time is the LRU time stamp for the eviction, the age of the result is kept in the creation time
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileAccessTime);
+
+    _entries.insert(key, new QVariantList(entry));
+    result = entry;
+
+    return true;
+}
+
+void EnrichmentCache::insert(const QByteArray& key, const QVariantList& result)
+{
+    _entries.insert(key, new QVariantList(result));
+
+    if (_cacheDirectory.isEmpty() || _maxSize == 0)
+        return;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    stream << cacheFormatVersion << result;
+
+    const QByteArray compressed = qCompress(data);
+
+    // make room first, so the cache never exceeds its limit
+    evict(_maxSize - compressed.size());
+
+    // write to a temporary file first so that a crash never leaves a truncated entry behind
+    QSaveFile file(entryFilePath(key));
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "EnrichmentCache::insert: cannot write" << file.fileName();
+        return;
+    }
+
+    file.write(compressed);
+    file.commit();
+}
+
+void EnrichmentCache::clear()
+{
+    _entries.clear();
+
+    if (_cacheDirectory.isEmpty())
+        return;
+
+    QDir directory(_cacheDirectory);
+
+    for (const QString& fileName : directory.entryList({ "*.bin" }, QDir::Files))
+        directory.remove(fileName);
+}
+
+void EnrichmentCache::setDataVersion(const QString& dataVersion)
+{
+    if (dataVersion.isEmpty() || dataVersion == _dataVersion)
+        return;
+
+    qDebug() << "EnrichmentCache: data version changed from" << _dataVersion << "to" << dataVersion << ", older results are looked up again";
+
+    // the entries of the previous version are no longer found, their files are evicted as the least recently used
+    _dataVersion = dataVersion;
+    _entries.clear();
+
+    if (_cacheDirectory.isEmpty())
+        return;
+
+    QSaveFile file(QDir(_cacheDirectory).filePath(dataVersionFileName));
+
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        file.write(_dataVersion.toUtf8());
+        file.commit();
+    }
+}
+
+void EnrichmentCache::setMaxSize(qint64 maxSize)
+{
+    _maxSize = std::max<qint64>(0, maxSize);
+
+    evict(_maxSize);
+}
+
+void EnrichmentCache::setCacheDirectory(const QString& cacheDirectory)
+{
+    _cacheDirectory = cacheDirectory;
+    _entries.clear();
+
+    if (!_cacheDirectory.isEmpty() && !QDir().mkpath(_cacheDirectory)) {
+        qDebug() << "EnrichmentCache: cannot create cache directory" << _cacheDirectory << ", results are only cached in memory";
+        _cacheDirectory.clear();
+    }
+
+    if (_cacheDirectory.isEmpty())
+        return;
+
+    QFile file(QDir(_cacheDirectory).filePath(dataVersionFileName));
+
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+        _dataVersion = QString::fromUtf8(file.readAll()).trimmed();
+}
+
+QString EnrichmentCache::entryFilePath(const QByteArray& key) const
+{
+    // the data version is part of the file name, so entries of another version are never read
+    const QByteArray versionHash = QCryptographicHash::hash(_dataVersion.toUtf8(), QCryptographicHash::Sha256).toHex().left(16);
+
+    return _cacheDirectory + "/" + QString::fromLatin1(key) + "." + QString::fromLatin1(versionHash) + ".bin";
+}
+
+void EnrichmentCache::evict(qint64 maxSize) const
+{
+    if (_cacheDirectory.isEmpty())
+        return;
+
+    QFileInfoList entries = QDir(_cacheDirectory).entryInfoList({ "*.bin" }, QDir::Files);
+
+    qint64 totalSize = 0;
+    for (const QFileInfo& entry : entries)
+        totalSize += entry.size();
+
+    if (totalSize <= maxSize)
+        return;
+
+    // least recently used first
+    std::sort(entries.begin(), entries.end(), [](const QFileInfo& lhs, const QFileInfo& rhs) {
+        return lhs.lastRead() < rhs.lastRead();
+        });
+
+    for (const QFileInfo& entry : entries) {
+        if (totalSize <= maxSize)
+            break;
+
+        if (QFile::remove(entry.absoluteFilePath()))
+            totalSize -= entry.size();
+    }
+}
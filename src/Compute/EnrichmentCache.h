@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+// Content-addressed cache for enrichment results
+// Entries are keyed by a fingerprint of the (sorted) query, the (sorted) background, the species and the method, and belong to
+// the data version of the service (e.g. the Ensembl and GO release of g:Profiler): a new data version hides all older entries
+// They are kept in memory (the most recently used ones) and written as one compressed file per entry to the cache directory,
+// entries older than the maximum age are not used and the least recently used files are removed beyond the maximum size
+class EnrichmentCache
+{
+public:
+    static constexpr qint64 defaultMaxSize = 64LL * 1024 * 1024; // 64 MB, a result is a few kB
+
+    // uses <AppDataLocation>/DualView/EnrichmentCache as cache directory
+    EnrichmentCache();
+
+    // compute the fingerprint of a gene list, independent of the order of the genes
+    static QByteArray fingerprint(const QStringList& genes);
+
+    // compute the fingerprint of an enrichment query, the background is passed as its (precomputed) fingerprint
+    static QByteArray fingerprint(const QStringList& query, const QByteArray& backgroundFingerprint, const QString& species, const QString& method);
+
+    // look up a result in memory and then on disk, returns false if the fingerprint is unknown
+    // an empty result is a valid entry and means that the query has no enriched terms
+    bool lookup(const QByteArray& key, QVariantList& result);
+
+    // store a result in memory and on disk
+    void insert(const QByteArray& key, const QVariantList& result);
+
+    // remove all entries from memory and disk
+    void clear();
+
+    // data version of the service, set from its replies, persisted in the cache directory
+    QString getDataVersion() const { return _dataVersion; }
+    void setDataVersion(const QString& dataVersion);
+
+    // maximum total size of the entry files in bytes, 0 disables the disk store
+    qint64 getMaxSize() const { return _maxSize; }
+    void setMaxSize(qint64 maxSize);
+
+    // entries older than this are looked up again
+    int getMaxAgeDays() const { return _maxAgeDays; }
+    void setMaxAgeDays(int maxAgeDays) { _maxAgeDays = maxAgeDays; }
+
+    QString getCacheDirectory() const { return _cacheDirectory; }
+    void setCacheDirectory(const QString& cacheDirectory);
+
+private:
+    QString entryFilePath(const QByteArray& key) const;
+
+    // remove the least recently used entry files until the total size fits maxSize
+    void evict(qint64 maxSize) const;
+
+private:
+    QString                            _cacheDirectory;    // directory of the on-disk store, empty disables the disk store
+    QString                            _dataVersion;       // data version of the service the entries belong to
+    qint64                             _maxSize;           // maximum total size of the entry files in bytes
+    int                                _maxAgeDays;        // maximum age of an entry
+    QCache<QByteArray, QVariantList>   _entries;           // most recently used entries of the current data version
+};
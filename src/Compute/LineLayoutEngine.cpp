@@ -0,0 +1,65 @@
+#include "LineLayoutEngine.h"
+
+#include "CrossingMinimization.h"
+#include "PerformanceTrace.h"
+
+#include <memory>
+
+namespace
+{
+    struct LineLayoutJob
+    {
+        std::vector<float>          sourceValues;
+        std::vector<float>          destinationValues;
+        std::vector<kernels::Line>  lines;
+        std::uint64_t               crossingsBefore = 0;
+        std::uint64_t               crossingsAfter = 0;
+    };
+}
+
+LineLayoutEngine::LineLayoutEngine(QObject* parent) :
+    QObject(parent),
+    _jobs(this)
+{
+}
+
+void LineLayoutEngine::compute(std::vector<float> sourceValues, std::vector<float> destinationValues, std::vector<std::pair<std::uint32_t, std::uint32_t>> lines)
+{
+    auto job = std::make_shared<LineLayoutJob>();
+    job->sourceValues = std::move(sourceValues);
+    job->destinationValues = std::move(destinationValues);
+    job->lines = std::move(lines);
+
+    _jobs.start(0, "Line layout computation", [this, job](const kernels::CancelFlag& cancelled) -> BackgroundJobs::Publish {
+        TRACE_JOB("LineLayoutEngine::compute");
+
+        // lines of a previous layout may refer to nodes that no longer exist
+        const std::size_t numSources = job->sourceValues.size();
+        const std::size_t numDestinations = job->destinationValues.size();
+        std::erase_if(job->lines, [numSources, numDestinations](const kernels::Line& line) { return line.first >= numSources || line.second >= numDestinations; });
+
+        std::vector<std::uint32_t> sourceRanks, destinationRanks;
+        kernels::valueRanks(job->sourceValues, sourceRanks);
+        kernels::valueRanks(job->destinationValues, destinationRanks);
+
+        kernels::CrossingMinimizationSettings settings;
+        settings.cancelled = &cancelled;
+
+        job->crossingsBefore = kernels::countCrossings(job->lines, sourceRanks, destinationRanks);
+        job->crossingsAfter = kernels::minimizeCrossings(job->lines, sourceRanks, destinationRanks, settings);
+
+        std::vector<float> rankedValues;
+        kernels::valuesByRank(job->sourceValues, sourceRanks, rankedValues);
+        job->sourceValues.swap(rankedValues);
+
+        kernels::valuesByRank(job->destinationValues, destinationRanks, rankedValues);
+        job->destinationValues.swap(rankedValues);
+
+        return [this, job]() { emit finished(job->sourceValues, job->destinationValues, job->crossingsBefore, job->crossingsAfter); };
+    });
+}
+
+void LineLayoutEngine::cancel()
+{
+    _jobs.cancel(0);
+}
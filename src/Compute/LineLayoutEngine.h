@@ -0,0 +1,33 @@
+#pragma once
+
+#include "BackgroundJobs.h"
+
+#include <QObject>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Reorders both axes of the lines view on a worker thread to reduce line crossings, see kernels::minimizeCrossings
+// The axes keep their values (the 1D embedding coordinates), only the nodes they belong to are permuted
+// Only the latest job is reported with finished, superseded or cancelled jobs stop at the next barycenter sweep
+class LineLayoutEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LineLayoutEngine(QObject* parent = nullptr);
+
+    // start reordering the source (A) and destination (B) axis values along the lines, supersedes the running job
+    void compute(std::vector<float> sourceValues, std::vector<float> destinationValues, std::vector<std::pair<std::uint32_t, std::uint32_t>> lines);
+
+    // stop the running job, its result is discarded
+    void cancel();
+
+signals:
+    // emitted on the thread of the engine with the reordered axis values and the number of crossings before and after
+    void finished(const std::vector<float>& sourceValues, const std::vector<float>& destinationValues, quint64 crossingsBefore, quint64 crossingsAfter);
+
+private:
+    BackgroundJobs      _jobs;      // a single lane
+};
@@ -0,0 +1,378 @@
+#include "LocalEnrichment.h"
+
+#include "ComputeKernels.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QVariantMap>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace
+{
+    inline bool testBit(const std::vector<std::uint64_t>& mask, std::uint32_t index)
+    {
+        return (mask[index >> 6] >> (index & 63)) & 1u;
+    }
+
+    inline void setBit(std::vector<std::uint64_t>& mask, std::uint32_t index)
+    {
+        mask[index >> 6] |= std::uint64_t(1) << (index & 63);
+    }
+
+    inline double logChoose(std::uint32_t n, std::uint32_t k)
+    {
+        return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+    }
+
+    // P(X >= k) for X ~ Hypergeometric(population N, successes K, draws n)
+    double hypergeometricUpperTail(std::uint32_t k, std::uint32_t N, std::uint32_t K, std::uint32_t n)
+    {
+        const std::uint32_t maxK = std::min(K, n);
+
+        if (k == 0)
+            return 1.0;
+
+        if (k > maxK)
+            return 0.0;
+
+        const double logTotal = logChoose(N, n);
+
+        // sum relative to the first (largest) term of the tail for numerical stability
+        const double logFirst = logChoose(K, k) + logChoose(N - K, n - k) - logTotal;
+
+        double sum = 0.0;
+        for (std::uint32_t i = k; i <= maxK; ++i) {
+            if (n - i > N - K)
+                continue;
+
+            sum += std::exp(logChoose(K, i) + logChoose(N - K, n - i) - logTotal - logFirst);
+        }
+
+        return std::min(1.0, std::exp(logFirst) * sum);
+    }
+
+    QString sourceFromNamespace(const QString& goNamespace)
+    {
+        if (goNamespace == "biological_process")
+            return "GO:BP";
+        if (goNamespace == "molecular_function")
+            return "GO:MF";
+        if (goNamespace == "cellular_component")
+            return "GO:CC";
+
+        return "GO";
+    }
+}
+
+bool LocalEnrichment::loadGmt(const QString& filePath)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "LocalEnrichment::loadGmt: cannot open" << filePath;
+        return false;
+    }
+
+    _gmtFilePath = filePath;
+    _geneSymbols.clear();
+    _geneIndices.clear();
+    _terms.clear();
+    _background.clear();
+    _backgroundMask.clear();
+    _termBackgroundSizes.clear();
+    _backgroundSize = 0;
+
+    QTextStream stream(&file);
+
+    while (!stream.atEnd()) {
+        const QStringList fields = stream.readLine().split('\t');
+
+        // term id, description and at least one gene
+        if (fields.size() < 3)
+            continue;
+
+        GeneSet geneSet;
+        geneSet.id = fields[0].trimmed();
+        geneSet.description = fields[1].trimmed();
+        geneSet.genes.reserve(fields.size() - 2);
+
+        for (int i = 2; i < fields.size(); ++i) {
+            const QString symbol = fields[i].trimmed();
+
+            if (symbol.isEmpty())
+                continue;
+
+            const QString key = symbol.toUpper();
+            auto it = _geneIndices.constFind(key);
+
+            if (it == _geneIndices.constEnd()) {
+                it = _geneIndices.insert(key, static_cast<std::uint32_t>(_geneSymbols.size()));
+                _geneSymbols.append(symbol);
+            }
+
+            geneSet.genes.push_back(it.value());
+        }
+
+        std::sort(geneSet.genes.begin(), geneSet.genes.end());
+        geneSet.genes.erase(std::unique(geneSet.genes.begin(), geneSet.genes.end()), geneSet.genes.end());
+
+        if (!geneSet.genes.empty())
+            _terms.push_back(std::move(geneSet));
+    }
+
+    qDebug() << "LocalEnrichment::loadGmt:" << _terms.size() << "gene sets with" << _geneSymbols.size() << "genes loaded from" << filePath;
+
+    return isLoaded();
+}
+
+bool LocalEnrichment::loadObo(const QString& filePath)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "LocalEnrichment::loadObo: cannot open" << filePath;
+        return false;
+    }
+
+    _oboFilePath = filePath;
+    _oboTerms.clear();
+
+    QTextStream stream(&file);
+
+    bool inTerm = false;
+    QString id, name, goNamespace;
+
+    auto storeTerm = [&]() {
+        if (inTerm && !id.isEmpty())
+            _oboTerms.insert(id, { name, goNamespace });
+
+        id.clear();
+        name.clear();
+        goNamespace.clear();
+    };
+
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+
+        if (line.startsWith('[')) {
+            storeTerm();
+            inTerm = (line == "[Term]");
+            continue;
+        }
+
+        if (!inTerm)
+            continue;
+
+        if (line.startsWith("id: "))
+            id = line.mid(4);
+        else if (line.startsWith("name: "))
+            name = line.mid(6);
+        else if (line.startsWith("namespace: "))
+            goNamespace = line.mid(11);
+    }
+
+    storeTerm();
+
+    qDebug() << "LocalEnrichment::loadObo:" << _oboTerms.size() << "terms loaded from" << filePath;
+
+    return !_oboTerms.isEmpty();
+}
+
+void LocalEnrichment::takeLoaded(LocalEnrichment&& loaded)
+{
+    if (!loaded._gmtFilePath.isEmpty()) {
+        _gmtFilePath = std::move(loaded._gmtFilePath);
+        _geneSymbols = std::move(loaded._geneSymbols);
+        _geneIndices = std::move(loaded._geneIndices);
+        _terms = std::move(loaded._terms);
+
+        // the background mask belongs to the previous genes
+        _background.clear();
+        _backgroundMask.clear();
+        _termBackgroundSizes.clear();
+        _backgroundSize = 0;
+    }
+
+    if (!loaded._oboFilePath.isEmpty()) {
+        _oboFilePath = std::move(loaded._oboFilePath);
+        _oboTerms = std::move(loaded._oboTerms);
+    }
+}
+
+QStringList LocalEnrichment::getTermGenes(const QString& termId) const
+{
+    QStringList genes;
+
+    const auto term = std::find_if(_terms.begin(), _terms.end(), [&termId](const GeneSet& geneSet) { return geneSet.id == termId; });
+
+    if (term == _terms.end())
+        return genes;
+
+    genes.reserve(static_cast<qsizetype>(term->genes.size()));
+    for (const auto gene : term->genes)
+        genes.append(_geneSymbols[gene]);
+
+    return genes;
+}
+
+std::uint32_t LocalEnrichment::buildMask(const QStringList& symbols, std::vector<std::uint64_t>& mask) const
+{
+    mask.assign((_geneSymbols.size() + 63) / 64, 0);
+
+    for (const QString& symbol : symbols) {
+        auto it = _geneIndices.constFind(symbol.toUpper());
+
+        if (it != _geneIndices.constEnd())
+            setBit(mask, it.value());
+    }
+
+    std::uint32_t count = 0;
+    for (const auto word : mask)
+        count += std::popcount(word);
+
+    return count;
+}
+
+void LocalEnrichment::updateBackground(const QStringList& background)
+{
+    if (!_termBackgroundSizes.empty() && background == _background)
+        return;
+
+    _background = background;
+
+    if (background.isEmpty()) {
+        // all annotated genes
+        _backgroundMask.assign((_geneSymbols.size() + 63) / 64, ~std::uint64_t(0));
+        _backgroundSize = static_cast<std::uint32_t>(_geneSymbols.size());
+    }
+    else {
+        _backgroundSize = buildMask(background, _backgroundMask);
+    }
+
+    _termBackgroundSizes.resize(_terms.size());
+
+#pragma omp parallel for
+    for (int t = 0; t < static_cast<int>(_terms.size()); ++t) {
+        std::uint32_t size = 0;
+        for (const auto gene : _terms[t].genes)
+            size += testBit(_backgroundMask, gene);
+
+        _termBackgroundSizes[t] = size;
+    }
+}
+
+QVariantList LocalEnrichment::enrich(const QStringList& query, const QStringList& background, const QString& method, double threshold)
+{
+    QVariantList outputList;
+
+    if (!isLoaded())
+        return outputList;
+
+    updateBackground(background);
+
+    // query genes that are annotated and part of the background
+    std::vector<std::uint64_t> queryMask;
+    buildMask(query, queryMask);
+
+    std::uint32_t querySize = 0;
+    for (std::size_t i = 0; i < queryMask.size(); ++i) {
+        queryMask[i] &= _backgroundMask[i];
+        querySize += std::popcount(queryMask[i]);
+    }
+
+    if (querySize == 0 || _backgroundSize == 0)
+        return outputList;
+
+    const int numTerms = static_cast<int>(_terms.size());
+
+    std::vector<std::uint32_t> overlaps(numTerms, 0);
+    std::vector<double> pValues(numTerms, 1.0);
+
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int t = 0; t < numTerms; ++t) {
+        std::uint32_t overlap = 0;
+        for (const auto gene : _terms[t].genes)
+            overlap += testBit(queryMask, gene);
+
+        overlaps[t] = overlap;
+
+        if (overlap > 0)
+            pValues[t] = hypergeometricUpperTail(overlap, _backgroundSize, _termBackgroundSizes[t], querySize);
+    }
+
+    // multiple testing correction over all terms that have genes in the background
+    const auto numTested = static_cast<double>(std::count_if(_termBackgroundSizes.begin(), _termBackgroundSizes.end(), [](std::uint32_t size) { return size > 0; }));
+
+    std::vector<double> adjusted(numTerms, 1.0);
+
+    if (method == "fdr") {
+        // Benjamini-Hochberg step-up, ranked among the tested terms only: untested terms must not shift the ranks
+        std::vector<int> testedTerms;
+        std::vector<double> testedPValues;
+        for (int t = 0; t < numTerms; ++t) {
+            if (_termBackgroundSizes[t] == 0)
+                continue;
+
+            testedTerms.push_back(t);
+            testedPValues.push_back(pValues[t]);
+        }
+
+        std::vector<double> testedAdjusted(testedTerms.size());
+        kernels::benjaminiHochberg(testedPValues, numTested, testedAdjusted);
+
+        for (std::size_t i = 0; i < testedTerms.size(); ++i)
+            adjusted[testedTerms[i]] = testedAdjusted[i];
+    }
+    else {
+        // bonferroni, also used for g:Profiler's g_SCS which is not available offline
+        for (int t = 0; t < numTerms; ++t)
+            adjusted[t] = std::min(1.0, pValues[t] * numTested);
+    }
+
+    std::vector<int> significant;
+    for (int t = 0; t < numTerms; ++t) {
+        if (overlaps[t] > 0 && adjusted[t] < threshold)
+            significant.push_back(t);
+    }
+
+    std::sort(significant.begin(), significant.end(), [&adjusted](int a, int b) { return adjusted[a] < adjusted[b]; });
+
+    outputList.reserve(static_cast<qsizetype>(significant.size()));
+
+    for (const int t : significant) {
+        const GeneSet& geneSet = _terms[t];
+
+        QString source = QFileInfo(_gmtFilePath).completeBaseName();
+        QString termName = geneSet.description;
+
+        if (auto it = _oboTerms.constFind(geneSet.id); it != _oboTerms.constEnd()) {
+            termName = it.value().first;
+            source = sourceFromNamespace(it.value().second);
+        }
+        else if (geneSet.id.startsWith("GO:")) {
+            source = "GO";
+        }
+
+        QStringList geneSymbols;
+        for (const auto gene : geneSet.genes) {
+            if (testBit(queryMask, gene))
+                geneSymbols.append(_geneSymbols[gene]);
+        }
+
+        QVariantMap dataMap;
+        dataMap["Source"] = source;
+        dataMap["Term ID"] = geneSet.id;
+        dataMap["Term Name"] = termName;
+        dataMap["Padj"] = adjusted[t];
+        dataMap["Highlight"] = false;
+        dataMap["Symbol"] = geneSymbols.join(",");
+        outputList.append(dataMap);
+    }
+
+    return outputList;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+#include <cstdint>
+#include <vector>
+
+// Offline GO enrichment from gene set (GMT) files, optionally annotated with term names from a GO OBO file
+// Each term stores the sorted indices of its genes, queries and backgrounds are bit masks over all annotated genes
+// Terms are tested in parallel with a one-sided hypergeometric test and corrected with Bonferroni or Benjamini-Hochberg
+class LocalEnrichment
+{
+public:
+    LocalEnrichment() = default;
+
+    // load gene sets from a GMT file (term id, description, genes... separated by tabs), replaces previously loaded sets
+    bool loadGmt(const QString& filePath);
+
+    // load term names and namespaces from a GO OBO file, used for the "Term Name" and "Source" of GO terms
+    bool loadObo(const QString& filePath);
+
+    bool isLoaded() const { return !_terms.empty(); }
+
+    // replace the gene sets and/or the ontology with those loaded into another object (e.g. on a worker thread)
+    void takeLoaded(LocalEnrichment&& loaded);
+
+    // genes of a term, empty if the term is not in the gene set file
+    QStringList getTermGenes(const QString& termId) const;
+
+    QString getGmtFilePath() const { return _gmtFilePath; }
+    QString getOboFilePath() const { return _oboFilePath; }
+
+    // run the enrichment analysis, an empty background uses all annotated genes
+    // method is one of "bonferroni", "fdr" or "g_SCS" (approximated with bonferroni)
+    // returns the significant terms sorted by adjusted p-value, in the same format as EnrichmentAnalysis::enrichmentDataReady
+    QVariantList enrich(const QStringList& query, const QStringList& background, const QString& method, double threshold = 0.05);
+
+private:
+    struct GeneSet
+    {
+        QString                     id;
+        QString                     description;
+        std::vector<std::uint32_t>  genes;          // sorted indices into _geneSymbols
+    };
+
+    // update the background mask and the per term background sizes if the background changed
+    void updateBackground(const QStringList& background);
+
+    // build a bit mask over all annotated genes from a list of symbols, returns the number of set bits
+    std::uint32_t buildMask(const QStringList& symbols, std::vector<std::uint64_t>& mask) const;
+
+private:
+    QString                                 _gmtFilePath;           // currently loaded gene set file
+    QString                                 _oboFilePath;           // currently loaded ontology file
+    QStringList                             _geneSymbols;           // all annotated genes
+    QHash<QString, std::uint32_t>           _geneIndices;           // upper case gene symbol to index in _geneSymbols
+    std::vector<GeneSet>                    _terms;                 // gene sets
+    QHash<QString, QPair<QString, QString>> _oboTerms;              // GO term id to term name and namespace
+
+    // cached per background
+    QStringList                             _background;            // background the mask was built for
+    std::vector<std::uint64_t>              _backgroundMask;        // annotated genes in the background
+    std::uint32_t                           _backgroundSize = 0;    // number of annotated genes in the background
+    std::vector<std::uint32_t>              _termBackgroundSizes;   // number of genes of each term in the background
+};
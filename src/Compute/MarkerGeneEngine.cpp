@@ -0,0 +1,66 @@
+#include "MarkerGeneEngine.h"
+
+#include "PerformanceTrace.h"
+
+namespace
+{
+    struct MarkerGeneJob
+    {
+        kernels::GroupColumnMoments                         clusterMoments;
+        std::vector<std::vector<kernels::GeneStatistics>>   markers;
+    };
+}
+
+MarkerGeneEngine::MarkerGeneEngine(QObject* parent) :
+    QObject(parent),
+    _jobs(this)
+{
+}
+
+void MarkerGeneEngine::compute(const QByteArray& clustersKey, kernels::GroupColumnMoments clusterMoments, std::size_t topK)
+{
+    auto moments = std::make_shared<kernels::GroupColumnMoments>(std::move(clusterMoments));
+
+    start(clustersKey, topK, false, [moments](kernels::GroupColumnMoments& clusterMoments, const kernels::CancelFlag&) {
+        clusterMoments = std::move(*moments);
+    });
+}
+
+void MarkerGeneEngine::start(const QByteArray& clustersKey, std::size_t topK, bool momentsComputed, ComputeMoments computeMoments)
+{
+    _jobs.start(0, "Marker gene ranking", [this, clustersKey, topK, momentsComputed, computeMoments](const kernels::CancelFlag& cancelled) -> BackgroundJobs::Publish {
+        TRACE_JOB("MarkerGeneEngine::compute");
+
+        auto job = std::make_shared<MarkerGeneJob>();
+        computeMoments(job->clusterMoments, cancelled);
+
+        if (kernels::isCancelled(&cancelled))
+            return {};
+
+        kernels::rankMarkerGenes(job->clusterMoments, topK, job->markers, &cancelled);
+
+        return [this, clustersKey, momentsComputed, job]() { emit finished(clustersKey, job->clusterMoments, momentsComputed, job->markers); };
+    });
+}
+
+void MarkerGeneEngine::cancel()
+{
+    _jobs.cancel(0);
+}
+
+void MarkerGeneEngine::startRankIndex(const QString& key, std::function<void(kernels::GeneRankIndex& index)> build)
+{
+    _jobs.start(1, "Gene rank index", [this, key, build](const kernels::CancelFlag&) -> BackgroundJobs::Publish {
+        TRACE_JOB("MarkerGeneEngine::buildRankIndex");
+
+        auto index = std::make_shared<kernels::GeneRankIndex>();
+        build(*index);
+
+        return [this, key, index]() { emit rankIndexBuilt(key, index); };
+    });
+}
+
+void MarkerGeneEngine::cancelRankIndex()
+{
+    _jobs.cancel(1);
+}
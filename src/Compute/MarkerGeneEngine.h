@@ -0,0 +1,80 @@
+#pragma once
+
+#include "BackgroundJobs.h"
+#include "DifferentialExpression.h"
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Computes the moments of every cluster (the cluster summary) and ranks the marker genes of every cluster vs the rest of the
+// cells on a worker thread, see kernels::groupColumnMoments and kernels::rankMarkerGenes
+// The moments are computed from a copy of the expression matrix, the dataset may change while the job runs; the copy is
+// released when the job is done. With a restored cluster summary only the ranking runs
+// Only the latest job is reported with finished, superseded or cancelled jobs stop before the next block of genes or cluster
+// In a second lane it builds the rank index of the expression matrix for the tests of selections, also from a copy
+class MarkerGeneEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MarkerGeneEngine(QObject* parent = nullptr);
+
+    // start ranking the marker genes of the clusters with the given moments, supersedes the running job
+    // clustersKey identifies the clusters and their cells, it is passed on with the result, topK as in kernels::rankMarkerGenes
+    void compute(const QByteArray& clustersKey, kernels::GroupColumnMoments clusterMoments, std::size_t topK);
+
+    // the same, computing the moments of the clusters (rows of the matrix) first
+    template <typename T>
+    void compute(const QByteArray& clustersKey, const kernels::MatrixView<T>& matrix, std::vector<std::vector<std::uint32_t>> clusterCells, std::size_t topK)
+    {
+        auto values = std::make_shared<const std::vector<T>>(matrix.data.begin(), matrix.data.end());
+        auto cells = std::make_shared<const std::vector<std::vector<std::uint32_t>>>(std::move(clusterCells));
+        const kernels::MatrixView<T> copy(*values, matrix.numRows, matrix.numColumns, matrix.rowStride);
+
+        start(clustersKey, topK, true, [values, cells, copy](kernels::GroupColumnMoments& clusterMoments, const kernels::CancelFlag& cancelled) {
+            kernels::groupColumnMoments(copy, *cells, clusterMoments, &cancelled);
+        });
+    }
+
+    // stop the running job, its result is discarded
+    void cancel();
+
+    // start building the rank index of an expression matrix, supersedes the running build, key identifies the matrix and
+    // is passed on with the result
+    template <typename T>
+    void buildRankIndex(const QString& key, const kernels::MatrixView<T>& matrix)
+    {
+        auto values = std::make_shared<const std::vector<T>>(matrix.data.begin(), matrix.data.end());
+        const kernels::MatrixView<T> copy(*values, matrix.numRows, matrix.numColumns, matrix.rowStride);
+
+        startRankIndex(key, [values, copy](kernels::GeneRankIndex& index) {
+            index.build(copy);
+        });
+    }
+
+    // stop the running build, its result is discarded
+    void cancelRankIndex();
+
+signals:
+    // emitted on the thread of the engine with the moments of the clusters and the marker genes of every cluster, by descending score
+    // momentsComputed is false if the moments were given, i.e. restored
+    void finished(const QByteArray& clustersKey, const kernels::GroupColumnMoments& clusterMoments, bool momentsComputed, const std::vector<std::vector<kernels::GeneStatistics>>& markers);
+
+    // emitted on the thread of the engine with the rank index of the matrix with the key
+    void rankIndexBuilt(const QString& key, const std::shared_ptr<const kernels::GeneRankIndex>& index);
+
+private:
+    using ComputeMoments = std::function<void(kernels::GroupColumnMoments& clusterMoments, const kernels::CancelFlag& cancelled)>;
+
+    void start(const QByteArray& clustersKey, std::size_t topK, bool momentsComputed, ComputeMoments computeMoments);
+
+    void startRankIndex(const QString& key, std::function<void(kernels::GeneRankIndex& index)> build);
+
+private:
+    BackgroundJobs      _jobs;      // lane 0 ranks the marker genes, lane 1 builds the rank index
+};
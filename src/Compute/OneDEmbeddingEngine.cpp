@@ -0,0 +1,48 @@
+#include "OneDEmbeddingEngine.h"
+
+#include "PerformanceTrace.h"
+#include "SpectralOrdering.h"
+
+#include <memory>
+
+namespace
+{
+    int lane(bool isA)
+    {
+        return isA ? 0 : 1;
+    }
+}
+
+OneDEmbeddingEngine::OneDEmbeddingEngine(QObject* parent) :
+    QObject(parent),
+    _jobs(this)
+{
+}
+
+void OneDEmbeddingEngine::compute(bool isA, const QString& datasetId, const std::vector<mv::Vector2f>& positions)
+{
+    // the worker gets its own copy of the positions, they may change while it runs
+    auto points = std::make_shared<std::vector<float>>(2 * positions.size());
+    for (std::size_t i = 0; i < positions.size(); i++)
+    {
+        (*points)[2 * i] = positions[i].x;
+        (*points)[2 * i + 1] = positions[i].y;
+    }
+
+    _jobs.start(lane(isA), "1D embedding computation", [this, isA, datasetId, points](const kernels::CancelFlag& cancelled) -> BackgroundJobs::Publish {
+        TRACE_JOB("OneDEmbeddingEngine::compute");
+
+        kernels::SpectralOrderingSettings settings;
+        settings.cancelled = &cancelled;
+
+        auto coordinates = std::make_shared<std::vector<float>>();
+        kernels::spectralOrdering(*points, *coordinates, settings);
+
+        return [this, isA, datasetId, coordinates]() { emit finished(isA, datasetId, *coordinates); };
+    });
+}
+
+void OneDEmbeddingEngine::cancel(bool isA)
+{
+    _jobs.cancel(lane(isA));
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "BackgroundJobs.h"
+
+#include <graphics/Vector2f.h>
+
+#include <QObject>
+#include <QString>
+
+#include <vector>
+
+// Computes a 1D embedding (see kernels::spectralOrdering) of the 2D embedding A or B on a worker thread
+// Only the latest job per side is reported with finished, superseded or cancelled jobs stop at the next power iteration
+class OneDEmbeddingEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OneDEmbeddingEngine(QObject* parent = nullptr);
+
+    // start computing the 1D embedding of the positions of embedding A or B, supersedes the running job of that side
+    // datasetId identifies the embedding dataset of the positions, it is passed on with the result
+    void compute(bool isA, const QString& datasetId, const std::vector<mv::Vector2f>& positions);
+
+    // stop the running job of embedding A or B, its result is discarded
+    void cancel(bool isA);
+
+signals:
+    // emitted on the thread of the engine with one coordinate in [0, 1] per position
+    void finished(bool isA, const QString& datasetId, const std::vector<float>& coordinates);
+
+private:
+    BackgroundJobs      _jobs;      // one lane per side
+};
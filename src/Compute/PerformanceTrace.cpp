@@ -0,0 +1,254 @@
+#include "PerformanceTrace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace
+{
+    // nesting depth of the open spans on this thread
+    thread_local int traceDepth = 0;
+
+    std::atomic_int nextThreadId = 0;
+}
+
+namespace trace
+{
+    Tracer& Tracer::instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    Tracer::Tracer() :
+        _enabled(false),
+        _maxNumEvents(2'000'000),
+        _numDroppedEvents(0),
+        _counters(),
+        _lastJob(),
+        _selectionTimestamp(-1)
+    {
+        _clock.start();
+    }
+
+    void Tracer::setEnabled(bool enabled)
+    {
+        _enabled.store(enabled, std::memory_order_relaxed);
+
+        qDebug() << "Tracer: tracing" << (enabled ? "enabled" : "disabled") << "," << getNumEvents() << "events recorded";
+    }
+
+    std::int64_t Tracer::now() const
+    {
+        return _clock.nsecsElapsed() / 1000;
+    }
+
+    int Tracer::currentThreadId()
+    {
+        thread_local const int threadId = nextThreadId.fetch_add(1);
+        return threadId;
+    }
+
+    void Tracer::addComplete(const char* name, const char* category, std::int64_t start, std::int64_t duration, int depth)
+    {
+        addEvent({ name, category, 'X', start, duration, 0, currentThreadId(), depth });
+    }
+
+    void Tracer::addAsyncBegin(const char* name, const char* category, std::uint64_t id)
+    {
+        addEvent({ name, category, 'b', now(), 0, id, currentThreadId(), 0 });
+    }
+
+    void Tracer::addAsyncEnd(const char* name, const char* category, std::uint64_t id)
+    {
+        addEvent({ name, category, 'e', now(), 0, id, currentThreadId(), 0 });
+    }
+
+    void Tracer::setCounter(const char* name, double value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_counterMutex);
+            _counters[name] = value;
+        }
+
+        if (isEnabled())
+            addEvent({ name, "Counter", 'C', now(), 0, 0, currentThreadId(), 0, value });
+    }
+
+    double Tracer::getCounter(const char* name, double defaultValue) const
+    {
+        std::lock_guard<std::mutex> lock(_counterMutex);
+
+        const auto it = _counters.find(name);
+        return it != _counters.end() ? it->second : defaultValue;
+    }
+
+    void Tracer::setLastJob(const char* name, double milliseconds)
+    {
+        std::lock_guard<std::mutex> lock(_counterMutex);
+
+        _lastJob = { name, milliseconds };
+    }
+
+    JobTiming Tracer::getLastJob() const
+    {
+        std::lock_guard<std::mutex> lock(_counterMutex);
+
+        return _lastJob;
+    }
+
+    void Tracer::addEvent(const TraceEvent& event)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_events.size() >= _maxNumEvents)
+        {
+            _numDroppedEvents++;
+            return;
+        }
+
+        _events.push_back(event);
+    }
+
+    void Tracer::clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _events.clear();
+        _numDroppedEvents = 0;
+    }
+
+    std::size_t Tracer::getNumEvents() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        return _events.size();
+    }
+
+    bool Tracer::exportChromeTrace(const QString& filePath) const
+    {
+        std::vector<TraceEvent> events;
+        std::size_t numDroppedEvents = 0;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            events = _events;
+            numDroppedEvents = _numDroppedEvents;
+        }
+
+        const qint64 processId = QCoreApplication::applicationPid();
+
+        QJsonArray traceEvents;
+
+        // name the threads, the first thread that traced is the GUI thread in practice
+        int maxThreadId = -1;
+        for (const auto& event : events)
+            maxThreadId = std::max(maxThreadId, event.threadId);
+
+        for (int threadId = 0; threadId <= maxThreadId; threadId++)
+        {
+            traceEvents.append(QJsonObject{
+                { "name", "thread_name" },
+                { "ph", "M" },
+                { "pid", processId },
+                { "tid", threadId },
+                { "args", QJsonObject{ { "name", threadId == 0 ? QString("Main") : QString("Worker %1").arg(threadId) } } }
+            });
+        }
+
+        for (const auto& event : events)
+        {
+            QJsonObject traceEvent{
+                { "name", event.name },
+                { "cat", event.category },
+                { "ph", QString(QLatin1Char(event.phase)) },
+                { "ts", static_cast<qint64>(event.timestamp) },
+                { "pid", processId },
+                { "tid", event.threadId }
+            };
+
+            if (event.phase == 'X')
+            {
+                traceEvent["dur"] = static_cast<qint64>(event.duration);
+                traceEvent["args"] = QJsonObject{ { "depth", event.depth } };
+            }
+            else if (event.phase == 'C')
+            {
+                traceEvent["args"] = QJsonObject{ { "value", event.value } };
+            }
+            else
+            {
+                traceEvent["id"] = QString::number(event.id);
+            }
+
+            traceEvents.append(traceEvent);
+        }
+
+        QJsonObject trace{
+            { "traceEvents", traceEvents },
+            { "displayTimeUnit", "ms" },
+            { "otherData", QJsonObject{ { "droppedEvents", static_cast<qint64>(numDroppedEvents) } } }
+        };
+
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "Tracer: cannot open" << filePath << "for writing:" << file.errorString();
+            return false;
+        }
+
+        file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+
+        if (!file.commit())
+        {
+            qDebug() << "Tracer: cannot write" << filePath << ":" << file.errorString();
+            return false;
+        }
+
+        qDebug() << "Tracer: exported" << events.size() << "events to" << filePath;
+        return true;
+    }
+
+    ScopedTrace::ScopedTrace(const char* name, const char* category) :
+        _name(name),
+        _category(category),
+        _start(-1),
+        _depth(0)
+    {
+        if (!Tracer::instance().isEnabled())
+            return;
+
+        _start = Tracer::instance().now();
+        _depth = traceDepth++;
+    }
+
+    ScopedTrace::~ScopedTrace()
+    {
+        if (_start < 0)
+            return;
+
+        traceDepth--;
+
+        // spans that were still open when tracing got disabled are dropped
+        auto& tracer = Tracer::instance();
+        if (tracer.isEnabled())
+            tracer.addComplete(_name, _category, _start, tracer.now() - _start, _depth);
+    }
+
+    ScopedJob::ScopedJob(const char* name, const char* category) :
+        _trace(name, category),
+        _name(name),
+        _start(Tracer::instance().now())
+    {
+    }
+
+    ScopedJob::~ScopedJob()
+    {
+        auto& tracer = Tracer::instance();
+        tracer.setLastJob(_name, static_cast<double>(tracer.now() - _start) / 1000.0);
+    }
+}
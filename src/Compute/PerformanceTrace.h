@@ -0,0 +1,148 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lightweight hot path tracing
+// Scoped spans (name, thread, nesting depth) and asynchronous spans (e.g. network round trips) are recorded while
+// tracing is enabled and can be exported as Chrome trace JSON (chrome://tracing, https://ui.perfetto.dev)
+// When tracing is disabled a span costs one relaxed atomic load
+// Counters and the last analytics job timing are always kept, they feed the performance HUD of the views
+namespace trace
+{
+    // one recorded event, names and categories must be string literals (they are stored by pointer)
+    struct TraceEvent
+    {
+        const char*     name;
+        const char*     category;
+        char            phase;          // 'X' complete span, 'b'/'e' asynchronous span begin/end, 'C' counter
+        std::int64_t    timestamp;      // microseconds since the tracer was created
+        std::int64_t    duration;       // microseconds, complete spans only
+        std::uint64_t   id;             // asynchronous spans only
+        int             threadId;
+        int             depth;          // nesting depth of the span on its thread
+        double          value = 0.0;    // counters only
+    };
+
+    // duration of the last finished analytics job, see TRACE_JOB
+    struct JobTiming
+    {
+        const char*     name = nullptr;
+        double          milliseconds = 0.0;
+    };
+
+    class Tracer
+    {
+    public:
+        static Tracer& instance();
+
+        bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+        void setEnabled(bool enabled);
+
+        // microseconds since the tracer was created
+        std::int64_t now() const;
+
+        void addComplete(const char* name, const char* category, std::int64_t start, std::int64_t duration, int depth);
+        void addAsyncBegin(const char* name, const char* category, std::uint64_t id);
+        void addAsyncEnd(const char* name, const char* category, std::uint64_t id);
+
+        // latest value of a named counter, counters are always kept (for the performance HUD) and recorded while tracing
+        void setCounter(const char* name, double value);
+        double getCounter(const char* name, double defaultValue = 0.0) const;
+
+        void setLastJob(const char* name, double milliseconds);
+        JobTiming getLastJob() const;
+
+        // mark that the user changed a selection, views use it to measure the latency until they are updated
+        void markSelection() { _selectionTimestamp.store(now(), std::memory_order_relaxed); }
+        std::int64_t getSelectionTimestamp() const { return _selectionTimestamp.load(std::memory_order_relaxed); }
+
+        // write all recorded events as Chrome trace JSON, returns false if the file could not be written
+        bool exportChromeTrace(const QString& filePath) const;
+
+        void clear();
+        std::size_t getNumEvents() const;
+
+        // small, stable id of the calling thread (0 is the thread that first used the tracer, normally the GUI thread)
+        static int currentThreadId();
+
+    private:
+        Tracer();
+
+        void addEvent(const TraceEvent& event);
+
+    private:
+        std::atomic_bool            _enabled;           // whether events are recorded
+        QElapsedTimer               _clock;             // time base of all events
+        mutable std::mutex          _mutex;             // guards _events
+        std::vector<TraceEvent>     _events;            // recorded events
+        std::size_t                 _maxNumEvents;      // events beyond this are dropped, bounds the memory of a long recording
+        std::size_t                 _numDroppedEvents;  // number of dropped events since the last clear
+        mutable std::mutex          _counterMutex;      // guards _counters and _lastJob
+        std::unordered_map<std::string, double> _counters;  // latest counter values
+        JobTiming                   _lastJob;           // last finished analytics job
+        std::atomic<std::int64_t>   _selectionTimestamp;    // time of the last selection change, -1 if none
+    };
+
+    // records a complete span from construction to destruction
+    class ScopedTrace
+    {
+    public:
+        explicit ScopedTrace(const char* name, const char* category = "DualView");
+        ~ScopedTrace();
+
+        ScopedTrace(const ScopedTrace&) = delete;
+        ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+    private:
+        const char*     _name;
+        const char*     _category;
+        std::int64_t    _start;     // -1 if tracing was disabled at construction
+        int             _depth;
+    };
+
+    // a traced span that also reports its duration as the last analytics job, names must be string literals
+    class ScopedJob
+    {
+    public:
+        explicit ScopedJob(const char* name, const char* category = "DualView");
+        ~ScopedJob();
+
+        ScopedJob(const ScopedJob&) = delete;
+        ScopedJob& operator=(const ScopedJob&) = delete;
+
+    private:
+        ScopedTrace     _trace;
+        const char*     _name;
+        std::int64_t    _start;
+    };
+
+    // asynchronous spans may begin and end in different call stacks, they are matched by name and id
+    inline void beginAsync(const char* name, std::uint64_t id, const char* category = "DualView")
+    {
+        if (Tracer::instance().isEnabled())
+            Tracer::instance().addAsyncBegin(name, category, id);
+    }
+
+    inline void endAsync(const char* name, std::uint64_t id, const char* category = "DualView")
+    {
+        if (Tracer::instance().isEnabled())
+            Tracer::instance().addAsyncEnd(name, category, id);
+    }
+}
+
+#define DUALVIEW_TRACE_CONCAT_IMPL(a, b) a##b
+#define DUALVIEW_TRACE_CONCAT(a, b) DUALVIEW_TRACE_CONCAT_IMPL(a, b)
+
+// trace the enclosing scope, name must be a string literal
+#define TRACE_SCOPE(name) trace::ScopedTrace DUALVIEW_TRACE_CONCAT(_traceScope, __LINE__)(name)
+
+// trace the enclosing scope and report it as the last analytics job, name must be a string literal
+#define TRACE_JOB(name) trace::ScopedJob DUALVIEW_TRACE_CONCAT(_traceJob, __LINE__)(name)
@@ -0,0 +1,743 @@
+#include "SpectralOrdering.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+    // uniform grid over the bounding box of the points with a few points per occupied cell
+    struct PointGrid
+    {
+        float                       minX = 0.f, minY = 0.f;
+        float                       cellSize = 1.f;
+        std::int32_t                numColumns = 1, numRows = 1;
+        std::vector<std::uint32_t>  cellOffsets;        // start of every cell in cellPoints, numColumns * numRows + 1 entries
+        std::vector<std::uint32_t>  cellPoints;         // point indices sorted by cell
+        std::vector<float>          cellCoordinates;    // interleaved point coordinates sorted by cell, for memory locality
+
+        std::int32_t column(float x) const { return std::clamp(static_cast<std::int32_t>((x - minX) / cellSize), 0, numColumns - 1); }
+        std::int32_t row(float y) const { return std::clamp(static_cast<std::int32_t>((y - minY) / cellSize), 0, numRows - 1); }
+    };
+
+    // sort the points into cells of the given size, returns the number of occupied cells
+    std::size_t fillGrid(std::span<const float> points, float width, float height, float cellSize, PointGrid& grid)
+    {
+        constexpr std::int32_t maxCellsPerAxis = 16384;
+
+        const std::size_t numPoints = points.size() / 2;
+
+        // cells must cover the whole bounding box at the maximum grid resolution
+        grid.cellSize = std::max(cellSize, std::max(width, height) / (maxCellsPerAxis - 1));
+        grid.numColumns = std::clamp(static_cast<std::int32_t>(width / grid.cellSize) + 1, 1, maxCellsPerAxis);
+        grid.numRows = std::clamp(static_cast<std::int32_t>(height / grid.cellSize) + 1, 1, maxCellsPerAxis);
+
+        const std::size_t numCells = static_cast<std::size_t>(grid.numColumns) * grid.numRows;
+
+        std::vector<std::uint32_t> pointCells(numPoints);
+        grid.cellOffsets.assign(numCells + 1, 0);
+
+        for (std::size_t i = 0; i < numPoints; i++)
+        {
+            pointCells[i] = static_cast<std::uint32_t>(grid.row(points[2 * i + 1]) * grid.numColumns + grid.column(points[2 * i]));
+            grid.cellOffsets[pointCells[i] + 1]++;
+        }
+
+        const std::size_t numOccupiedCells = numCells - std::count(grid.cellOffsets.begin() + 1, grid.cellOffsets.end(), 0u);
+
+        std::partial_sum(grid.cellOffsets.begin(), grid.cellOffsets.end(), grid.cellOffsets.begin());
+
+        std::vector<std::uint32_t> cellFill(grid.cellOffsets.begin(), grid.cellOffsets.end() - 1);
+        grid.cellPoints.resize(numPoints);
+        grid.cellCoordinates.resize(2 * numPoints);
+
+        for (std::size_t i = 0; i < numPoints; i++)
+        {
+            const std::uint32_t position = cellFill[pointCells[i]]++;
+
+            grid.cellPoints[position] = static_cast<std::uint32_t>(i);
+            grid.cellCoordinates[2 * position] = points[2 * i];
+            grid.cellCoordinates[2 * position + 1] = points[2 * i + 1];
+        }
+
+        return numOccupiedCells;
+    }
+
+    PointGrid buildGrid(std::span<const float> points)
+    {
+        constexpr float pointsPerCell = 2.f;
+
+        PointGrid grid;
+
+        const std::size_t numPoints = points.size() / 2;
+
+        float maxX = std::numeric_limits<float>::lowest(), maxY = std::numeric_limits<float>::lowest();
+        grid.minX = grid.minY = std::numeric_limits<float>::max();
+
+        for (std::size_t i = 0; i < numPoints; i++)
+        {
+            grid.minX = std::min(grid.minX, points[2 * i]);
+            grid.minY = std::min(grid.minY, points[2 * i + 1]);
+            maxX = std::max(maxX, points[2 * i]);
+            maxY = std::max(maxY, points[2 * i + 1]);
+        }
+
+        const float width = maxX - grid.minX;
+        const float height = maxY - grid.minY;
+        const float area = std::max(width * height, std::max(width, height) * std::max(width, height) * 1e-3f);
+
+        float cellSize = std::sqrt(pointsPerCell * area / static_cast<float>(numPoints));
+
+        if (!(cellSize > 0.f) || !std::isfinite(cellSize))
+            cellSize = 1.f;
+
+        const std::size_t numOccupiedCells = fillGrid(points, width, height, cellSize, grid);
+
+        // embeddings are mostly clustered, refine the grid once so that the occupied cells hold about pointsPerCell points,
+        // with at most four cells per point
+        const float occupancy = static_cast<float>(numPoints) / static_cast<float>(std::max<std::size_t>(numOccupiedCells, 1));
+        const float maxRefinement = std::sqrt(4.f * static_cast<float>(numPoints) / static_cast<float>(grid.cellOffsets.size() - 1));
+        const float refinement = std::min(std::sqrt(occupancy / pointsPerCell), maxRefinement);
+
+        if (refinement > 2.f)
+            fillGrid(points, width, height, cellSize / refinement, grid);
+
+        return grid;
+    }
+
+    // symmetric sparse matrix in compressed row format
+    struct SparseGraph
+    {
+        std::vector<std::uint32_t>  rowOffsets;
+        std::vector<std::uint32_t>  columns;
+        std::vector<float>          weights;
+    };
+
+    struct Edge
+    {
+        std::uint32_t   from;
+        std::uint32_t   to;
+        float           weight;
+    };
+
+    SparseGraph buildGraph(std::size_t numPoints, const std::vector<Edge>& edges)
+    {
+        SparseGraph graph;
+        graph.rowOffsets.assign(numPoints + 1, 0);
+
+        for (const Edge& edge : edges)
+        {
+            graph.rowOffsets[edge.from + 1]++;
+            graph.rowOffsets[edge.to + 1]++;
+        }
+
+        std::partial_sum(graph.rowOffsets.begin(), graph.rowOffsets.end(), graph.rowOffsets.begin());
+
+        graph.columns.resize(graph.rowOffsets.back());
+        graph.weights.resize(graph.rowOffsets.back());
+
+        std::vector<std::uint32_t> rowFill(graph.rowOffsets.begin(), graph.rowOffsets.end() - 1);
+
+        for (const Edge& edge : edges)
+        {
+            graph.columns[rowFill[edge.from]] = edge.to;
+            graph.weights[rowFill[edge.from]++] = edge.weight;
+            graph.columns[rowFill[edge.to]] = edge.from;
+            graph.weights[rowFill[edge.to]++] = edge.weight;
+        }
+
+        return graph;
+    }
+
+    // projection of the points on their principal axis
+    void principalAxisProjection(std::span<const float> points, std::vector<double>& projection)
+    {
+        const std::size_t numPoints = points.size() / 2;
+
+        double meanX = 0.0, meanY = 0.0;
+        for (std::size_t i = 0; i < numPoints; i++)
+        {
+            meanX += points[2 * i];
+            meanY += points[2 * i + 1];
+        }
+        meanX /= static_cast<double>(numPoints);
+        meanY /= static_cast<double>(numPoints);
+
+        double covXX = 0.0, covXY = 0.0, covYY = 0.0;
+        for (std::size_t i = 0; i < numPoints; i++)
+        {
+            const double dx = points[2 * i] - meanX;
+            const double dy = points[2 * i + 1] - meanY;
+            covXX += dx * dx;
+            covXY += dx * dy;
+            covYY += dy * dy;
+        }
+
+        // eigenvector of the largest eigenvalue of the 2x2 covariance matrix
+        const double angle = 0.5 * std::atan2(2.0 * covXY, covXX - covYY);
+        const double axisX = std::cos(angle);
+        const double axisY = std::sin(angle);
+
+        projection.resize(numPoints);
+        for (std::size_t i = 0; i < numPoints; i++)
+            projection[i] = (points[2 * i] - meanX) * axisX + (points[2 * i + 1] - meanY) * axisY;
+    }
+
+    // remove the component along the unit vector and normalize, returns false if nothing is left
+    bool orthonormalize(std::vector<double>& vector, const std::vector<double>& unitVector)
+    {
+        const std::int64_t size = static_cast<std::int64_t>(vector.size());
+
+        double dot = 0.0;
+#pragma omp parallel for reduction(+:dot)
+        for (std::int64_t i = 0; i < size; i++)
+            dot += vector[i] * unitVector[i];
+
+        double norm = 0.0;
+#pragma omp parallel for reduction(+:norm)
+        for (std::int64_t i = 0; i < size; i++)
+        {
+            vector[i] -= dot * unitVector[i];
+            norm += vector[i] * vector[i];
+        }
+
+        norm = std::sqrt(norm);
+
+        if (norm < 1e-30)
+            return false;
+
+#pragma omp parallel for
+        for (std::int64_t i = 0; i < size; i++)
+            vector[i] /= norm;
+
+        return true;
+    }
+
+    // point indices sorted along the principal axis, projection receives the projection of every point
+    std::vector<std::uint32_t> principalAxisOrder(std::span<const float> points, std::vector<double>& projection)
+    {
+        principalAxisProjection(points, projection);
+
+        std::vector<std::uint32_t> order(projection.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&projection](std::uint32_t lhs, std::uint32_t rhs) { return projection[lhs] < projection[rhs]; });
+
+        return order;
+    }
+
+    // kNN graph of the points with Gaussian weights scaled by the local point density
+    // separate components are joined by an edge between consecutive points along order (the principal axis order), without
+    // them separate clusters would each get their own, arbitrary, ordering
+    SparseGraph buildNeighborhoodGraph(std::span<const float> points, std::span<const std::uint32_t> order, std::int32_t numNeighbors)
+    {
+        const std::size_t numPoints = points.size() / 2;
+
+        std::vector<std::uint32_t> neighbors;
+        std::vector<float> squaredDistances;
+        kernels::nearestNeighbors2D(points, numNeighbors, neighbors, squaredDistances);
+
+        const std::size_t k = neighbors.size() / numPoints;
+
+        // local scale per point: distance to its k-th neighbour
+        std::vector<float> scales(numPoints);
+        float meanScale = 0.f;
+        for (std::size_t i = 0; i < numPoints; i++)
+        {
+            scales[i] = std::sqrt(squaredDistances[i * k + k - 1]);
+            meanScale += scales[i] / static_cast<float>(numPoints);
+        }
+
+        const float minScale = std::max(meanScale * 1e-3f, std::numeric_limits<float>::min());
+        for (float& scale : scales)
+            scale = std::max(scale, minScale);
+
+        std::vector<Edge> edges;
+        edges.reserve(numPoints * (k + 1));
+
+        double meanWeight = 0.0;
+        for (std::size_t i = 0; i < numPoints; i++)
+        {
+            for (std::size_t n = 0; n < k; n++)
+            {
+                const std::uint32_t j = neighbors[i * k + n];
+                const float weight = std::exp(-squaredDistances[i * k + n] / (scales[i] * scales[j]));
+
+                edges.push_back({ static_cast<std::uint32_t>(i), j, weight });
+                meanWeight += weight;
+            }
+        }
+        meanWeight /= static_cast<double>(edges.size());
+
+        std::vector<std::uint32_t> components(numPoints);
+        std::iota(components.begin(), components.end(), 0u);
+
+        const auto findComponent = [&components](std::uint32_t index) {
+            while (components[index] != index)
+                index = components[index] = components[components[index]];
+
+            return index;
+        };
+
+        for (const Edge& edge : edges)
+            components[findComponent(edge.from)] = findComponent(edge.to);
+
+        for (std::size_t i = 1; i < numPoints; i++)
+        {
+            const std::uint32_t previous = findComponent(order[i - 1]);
+            const std::uint32_t current = findComponent(order[i]);
+
+            if (previous == current)
+                continue;
+
+            edges.push_back({ order[i - 1], order[i], static_cast<float>(meanWeight) });
+            components[previous] = current;
+        }
+
+        return buildGraph(numPoints, edges);
+    }
+
+    // pair every node with its unmatched neighbour of largest weight (heavy edge matching), returns the number of pairs
+    // parents receives the pair index of every node, nodes without unmatched neighbour join the pair of their neighbour
+    // of largest weight, so that paths and stars coarsen as well
+    std::uint32_t matchNodes(const SparseGraph& graph, std::vector<std::uint32_t>& parents)
+    {
+        constexpr std::uint32_t unmatched = std::numeric_limits<std::uint32_t>::max();
+
+        const std::size_t numNodes = graph.rowOffsets.size() - 1;
+
+        parents.assign(numNodes, unmatched);
+
+        std::uint32_t numPairs = 0;
+        for (std::size_t i = 0; i < numNodes; i++)
+        {
+            if (parents[i] != unmatched)
+                continue;
+
+            std::uint32_t match = unmatched;
+            float matchWeight = 0.f;
+
+            for (std::uint32_t e = graph.rowOffsets[i]; e < graph.rowOffsets[i + 1]; e++)
+            {
+                const std::uint32_t j = graph.columns[e];
+
+                if (j != i && parents[j] == unmatched && graph.weights[e] > matchWeight)
+                {
+                    match = j;
+                    matchWeight = graph.weights[e];
+                }
+            }
+
+            if (match == unmatched)
+                continue;
+
+            parents[i] = numPairs;
+            parents[match] = numPairs;
+            numPairs++;
+        }
+
+        for (std::size_t i = 0; i < numNodes; i++)
+        {
+            if (parents[i] != unmatched)
+                continue;
+
+            float neighborWeight = 0.f;
+
+            for (std::uint32_t e = graph.rowOffsets[i]; e < graph.rowOffsets[i + 1]; e++)
+            {
+                if (graph.columns[e] != i && parents[graph.columns[e]] != unmatched && graph.weights[e] > neighborWeight)
+                {
+                    parents[i] = parents[graph.columns[e]];
+                    neighborWeight = graph.weights[e];
+                }
+            }
+
+            if (parents[i] == unmatched)
+                parents[i] = numPairs++;
+        }
+
+        return numPairs;
+    }
+
+    // graph of the node pairs, the weight between two pairs is the sum of the weights between their nodes
+    SparseGraph coarsenGraph(const SparseGraph& graph, std::span<const std::uint32_t> parents, std::uint32_t numPairs)
+    {
+        const std::size_t numNodes = parents.size();
+
+        std::vector<std::uint32_t> childOffsets(numPairs + 1, 0);
+        for (const std::uint32_t parent : parents)
+            childOffsets[parent + 1]++;
+
+        std::partial_sum(childOffsets.begin(), childOffsets.end(), childOffsets.begin());
+
+        std::vector<std::uint32_t> children(numNodes);
+        std::vector<std::uint32_t> childFill(childOffsets.begin(), childOffsets.end() - 1);
+        for (std::size_t i = 0; i < numNodes; i++)
+            children[childFill[parents[i]]++] = static_cast<std::uint32_t>(i);
+
+        SparseGraph coarse;
+        coarse.rowOffsets.assign(numPairs + 1, 0);
+        coarse.columns.reserve(graph.columns.size());
+        coarse.weights.reserve(graph.weights.size());
+
+        std::vector<std::pair<std::uint32_t, float>> row;
+
+        for (std::uint32_t pair = 0; pair < numPairs; pair++)
+        {
+            row.clear();
+
+            for (std::uint32_t c = childOffsets[pair]; c < childOffsets[pair + 1]; c++)
+                for (std::uint32_t e = graph.rowOffsets[children[c]]; e < graph.rowOffsets[children[c] + 1]; e++)
+                    row.emplace_back(parents[graph.columns[e]], graph.weights[e]);
+
+            std::sort(row.begin(), row.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+            for (std::size_t r = 0; r < row.size(); r++)
+            {
+                if (r > 0 && row[r].first == row[r - 1].first)
+                {
+                    coarse.weights.back() += row[r].second;
+                    continue;
+                }
+
+                coarse.columns.push_back(row[r].first);
+                coarse.weights.push_back(row[r].second);
+            }
+
+            coarse.rowOffsets[pair + 1] = static_cast<std::uint32_t>(coarse.columns.size());
+        }
+
+        return coarse;
+    }
+
+    // refine vector towards the Fiedler vector of the graph, with at most maxIterations power iterations
+    void refineFiedlerVector(const SparseGraph& graph, float tolerance, std::int32_t maxIterations, const kernels::CancelFlag* cancelled, std::vector<double>& vector)
+    {
+        const std::size_t numNodes = graph.rowOffsets.size() - 1;
+
+        std::vector<double> inverseSqrtDegrees(numNodes);
+        std::vector<double> trivial(numNodes);              // sqrt of the degrees, the leading eigenvector of the normalized graph
+        double trivialNorm = 0.0;
+
+        for (std::size_t i = 0; i < numNodes; i++)
+        {
+            double degree = 0.0;
+            for (std::uint32_t e = graph.rowOffsets[i]; e < graph.rowOffsets[i + 1]; e++)
+                degree += graph.weights[e];
+
+            trivial[i] = std::sqrt(degree);
+            inverseSqrtDegrees[i] = 1.0 / trivial[i];
+            trivialNorm += degree;
+        }
+
+        trivialNorm = std::sqrt(trivialNorm);
+        for (double& value : trivial)
+            value /= trivialNorm;
+
+        // power iteration on (I + D^-1/2 W D^-1/2) / 2 orthogonal to its leading eigenvector, in the normalized basis
+        std::vector<double> current(numNodes);
+        for (std::size_t i = 0; i < numNodes; i++)
+            current[i] = vector[i] * trivial[i];
+
+        if (!orthonormalize(current, trivial))
+            return;
+
+        std::vector<double> next(numNodes);
+        const std::int64_t size = static_cast<std::int64_t>(numNodes);
+
+        for (std::int32_t iteration = 0; iteration < maxIterations && !kernels::isCancelled(cancelled); iteration++)
+        {
+#pragma omp parallel for schedule(dynamic, 1024)
+            for (std::int64_t i = 0; i < size; i++)
+            {
+                double sum = 0.0;
+                for (std::uint32_t e = graph.rowOffsets[i]; e < graph.rowOffsets[i + 1]; e++)
+                    sum += graph.weights[e] * inverseSqrtDegrees[graph.columns[e]] * current[graph.columns[e]];
+
+                next[i] = 0.5 * (current[i] + inverseSqrtDegrees[i] * sum);
+            }
+
+            if (!orthonormalize(next, trivial))
+                break;
+
+            double change = 0.0;
+#pragma omp parallel for reduction(+:change)
+            for (std::int64_t i = 0; i < size; i++)
+                change += (next[i] - current[i]) * (next[i] - current[i]);
+
+            current.swap(next);
+
+            if (std::sqrt(change) < tolerance)
+                break;
+        }
+
+        for (std::size_t i = 0; i < numNodes; i++)
+            vector[i] = current[i] * inverseSqrtDegrees[i];
+    }
+
+    // exact Fiedler vector of a small graph, from the eigen decomposition (cyclic Jacobi) of D^-1/2 W D^-1/2
+    void denseFiedlerVector(const SparseGraph& graph, std::vector<double>& vector)
+    {
+        const std::size_t numNodes = graph.rowOffsets.size() - 1;
+
+        std::vector<double> inverseSqrtDegrees(numNodes);
+        for (std::size_t i = 0; i < numNodes; i++)
+        {
+            double degree = 0.0;
+            for (std::uint32_t e = graph.rowOffsets[i]; e < graph.rowOffsets[i + 1]; e++)
+                degree += graph.weights[e];
+
+            inverseSqrtDegrees[i] = 1.0 / std::sqrt(degree);
+        }
+
+        std::vector<double> matrix(numNodes * numNodes, 0.0);
+        for (std::size_t i = 0; i < numNodes; i++)
+            for (std::uint32_t e = graph.rowOffsets[i]; e < graph.rowOffsets[i + 1]; e++)
+                matrix[i * numNodes + graph.columns[e]] += graph.weights[e] * inverseSqrtDegrees[i] * inverseSqrtDegrees[graph.columns[e]];
+
+        std::vector<double> eigenvectors(numNodes * numNodes, 0.0);
+        for (std::size_t i = 0; i < numNodes; i++)
+            eigenvectors[i * numNodes + i] = 1.0;
+
+        for (std::int32_t sweep = 0; sweep < 50; sweep++)
+        {
+            double offDiagonal = 0.0;
+            for (std::size_t p = 0; p < numNodes; p++)
+                for (std::size_t q = p + 1; q < numNodes; q++)
+                    offDiagonal += matrix[p * numNodes + q] * matrix[p * numNodes + q];
+
+            if (offDiagonal < 1e-24)
+                break;
+
+            for (std::size_t p = 0; p < numNodes; p++)
+            {
+                for (std::size_t q = p + 1; q < numNodes; q++)
+                {
+                    const double apq = matrix[p * numNodes + q];
+
+                    if (std::abs(apq) < 1e-300)
+                        continue;
+
+                    const double theta = (matrix[q * numNodes + q] - matrix[p * numNodes + p]) / (2.0 * apq);
+                    const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                    const double c = 1.0 / std::sqrt(t * t + 1.0);
+                    const double s = t * c;
+
+                    // rotate rows and columns p and q of the matrix and the columns of the eigenvectors
+                    for (std::size_t k = 0; k < numNodes; k++)
+                    {
+                        const double akp = matrix[k * numNodes + p];
+                        const double akq = matrix[k * numNodes + q];
+                        matrix[k * numNodes + p] = c * akp - s * akq;
+                        matrix[k * numNodes + q] = s * akp + c * akq;
+                    }
+
+                    for (std::size_t k = 0; k < numNodes; k++)
+                    {
+                        const double apk = matrix[p * numNodes + k];
+                        const double aqk = matrix[q * numNodes + k];
+                        matrix[p * numNodes + k] = c * apk - s * aqk;
+                        matrix[q * numNodes + k] = s * apk + c * aqk;
+                    }
+
+                    for (std::size_t k = 0; k < numNodes; k++)
+                    {
+                        const double vkp = eigenvectors[k * numNodes + p];
+                        const double vkq = eigenvectors[k * numNodes + q];
+                        eigenvectors[k * numNodes + p] = c * vkp - s * vkq;
+                        eigenvectors[k * numNodes + q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+
+        // the largest eigenvalue belongs to the trivial eigenvector, the second largest to the Fiedler vector
+        std::vector<std::size_t> order(numNodes);
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) { return matrix[lhs * numNodes + lhs] > matrix[rhs * numNodes + rhs]; });
+
+        const std::size_t fiedler = order[1];
+
+        vector.resize(numNodes);
+        for (std::size_t i = 0; i < numNodes; i++)
+            vector[i] = eigenvectors[i * numNodes + fiedler] * inverseSqrtDegrees[i];
+    }
+
+    // Fiedler vector of the graph, computed from coarse to fine: on long, thin structures plain power iteration needs a
+    // number of iterations quadratic in the number of nodes, whereas every level here only has to fix details at its own
+    // scale. Falls back to power iteration from the initial vector when the graph can not be coarsened far enough
+    void multilevelFiedlerVector(const SparseGraph& graph, const std::vector<double>& initial, const kernels::SpectralOrderingSettings& settings, std::vector<double>& vector)
+    {
+        constexpr std::size_t coarsestSize = 128;
+
+        const std::size_t numNodes = graph.rowOffsets.size() - 1;
+
+        if (numNodes > coarsestSize)
+        {
+            std::vector<std::uint32_t> parents;
+            const std::uint32_t numPairs = matchNodes(graph, parents);
+
+            // stop coarsening when hardly any nodes were matched (star like graphs)
+            if (numPairs * 10 < numNodes * 9)
+            {
+                std::vector<double> coarseInitial(numPairs, 0.0);
+                for (std::size_t i = 0; i < numNodes; i++)
+                    coarseInitial[parents[i]] += initial[i];
+
+                std::vector<double> coarseVector;
+                multilevelFiedlerVector(coarsenGraph(graph, parents, numPairs), coarseInitial, settings, coarseVector);
+
+                if (kernels::isCancelled(settings.cancelled))
+                    return;
+
+                vector.resize(numNodes);
+                for (std::size_t i = 0; i < numNodes; i++)
+                    vector[i] = coarseVector[parents[i]];
+
+                refineFiedlerVector(graph, settings.tolerance, settings.maxIterations, settings.cancelled, vector);
+                return;
+            }
+        }
+
+        if (numNodes <= coarsestSize)
+        {
+            denseFiedlerVector(graph, vector);
+            return;
+        }
+
+        vector = initial;
+        refineFiedlerVector(graph, settings.tolerance, settings.maxIterations, settings.cancelled, vector);
+    }
+}
+
+namespace kernels
+{
+    void nearestNeighbors2D(std::span<const float> points, std::int32_t numNeighbors, std::vector<std::uint32_t>& neighbors, std::vector<float>& squaredDistances)
+    {
+        const std::int64_t numPoints = static_cast<std::int64_t>(points.size() / 2);
+        const std::int32_t k = static_cast<std::int32_t>(std::min<std::int64_t>(numNeighbors, numPoints - 1));
+
+        neighbors.clear();
+        squaredDistances.clear();
+
+        if (k <= 0)
+            return;
+
+        neighbors.resize(static_cast<std::size_t>(numPoints) * k);
+        squaredDistances.resize(static_cast<std::size_t>(numPoints) * k);
+
+        const PointGrid grid = buildGrid(points);
+
+#pragma omp parallel for schedule(dynamic, 256)
+        for (std::int64_t i = 0; i < numPoints; i++)
+        {
+            const float x = points[2 * i];
+            const float y = points[2 * i + 1];
+            const std::int32_t column = grid.column(x);
+            const std::int32_t row = grid.row(y);
+
+            std::uint32_t* nearest = neighbors.data() + i * k;
+            float* nearestDistances = squaredDistances.data() + i * k;
+            std::int32_t numFound = 0;
+
+            // visit the grid in square rings around the cell of the point, a ring can only contain points closer than the
+            // current k-th neighbour if its inner edge is closer than that neighbour
+            const std::int32_t maxRing = std::max(grid.numColumns, grid.numRows);
+            for (std::int32_t ring = 0; ring <= maxRing; ring++)
+            {
+                if (numFound == k)
+                {
+                    const float ringDistance = (ring - 1) * grid.cellSize;
+                    if (ringDistance * ringDistance > nearestDistances[k - 1])
+                        break;
+                }
+
+                for (std::int32_t r = row - ring; r <= row + ring; r++)
+                {
+                    if (r < 0 || r >= grid.numRows)
+                        continue;
+
+                    // interior rows of the ring only contribute their first and last cell
+                    const bool edgeRow = (r == row - ring) || (r == row + ring);
+                    const std::int32_t step = edgeRow ? 1 : std::max(2 * ring, 1);
+
+                    for (std::int32_t c = column - ring; c <= column + ring; c += step)
+                    {
+                        if (c < 0 || c >= grid.numColumns)
+                            continue;
+
+                        const std::size_t cell = static_cast<std::size_t>(r) * grid.numColumns + c;
+
+                        for (std::uint32_t p = grid.cellOffsets[cell]; p < grid.cellOffsets[cell + 1]; p++)
+                        {
+                            const std::uint32_t j = grid.cellPoints[p];
+
+                            if (j == static_cast<std::uint32_t>(i))
+                                continue;
+
+                            const float dx = grid.cellCoordinates[2 * p] - x;
+                            const float dy = grid.cellCoordinates[2 * p + 1] - y;
+                            const float distance = dx * dx + dy * dy;
+
+                            if (numFound == k && distance >= nearestDistances[k - 1])
+                                continue;
+
+                            // insertion into the sorted list of the nearest neighbours found so far
+                            std::int32_t position = (numFound == k) ? k - 1 : numFound++;
+                            for (; position > 0 && nearestDistances[position - 1] > distance; position--)
+                            {
+                                nearestDistances[position] = nearestDistances[position - 1];
+                                nearest[position] = nearest[position - 1];
+                            }
+
+                            nearestDistances[position] = distance;
+                            nearest[position] = j;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+
+    void spectralOrdering(std::span<const float> points, std::vector<float>& coordinates, const SpectralOrderingSettings& settings)
+    {
+        const std::size_t numPoints = points.size() / 2;
+
+        coordinates.assign(numPoints, 0.f);
+
+        if (numPoints < 2)
+            return;
+
+        std::vector<double> projection;
+        std::vector<std::uint32_t> order = principalAxisOrder(points, projection);
+
+        std::vector<double> fiedler;
+        multilevelFiedlerVector(buildNeighborhoodGraph(points, order, settings.numNeighbors), projection, settings, fiedler);
+
+        if (isCancelled(settings.cancelled))
+            return;
+
+        double correlation = 0.0;
+        for (std::size_t i = 0; i < numPoints; i++)
+            correlation += fiedler[i] * projection[i];
+
+        const double sign = correlation < 0.0 ? -1.0 : 1.0;
+
+        // ties are broken by the principal axis order
+        std::vector<std::uint32_t> rank(numPoints);
+        for (std::size_t i = 0; i < numPoints; i++)
+            rank[order[i]] = static_cast<std::uint32_t>(i);
+
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](std::uint32_t lhs, std::uint32_t rhs) {
+            const double left = sign * fiedler[lhs];
+            const double right = sign * fiedler[rhs];
+            return left < right || (left == right && rank[lhs] < rank[rhs]);
+        });
+
+        const float scale = 1.f / static_cast<float>(numPoints - 1);
+        for (std::size_t i = 0; i < numPoints; i++)
+            coordinates[order[i]] = static_cast<float>(i) * scale;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ComputeKernels.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 1D ordering of 2D embedding points, used as 1D embedding when the data has none
+// The points are ordered along the Fiedler vector of their symmetric kNN graph, so neighbours in the 2D embedding stay
+// close in the 1D ordering. The Fiedler vector is computed on a hierarchy of coarsened graphs, exactly on the coarsest
+// one and refined with a few power iterations on every finer one. Like the kernels in ComputeKernels.h this needs no
+// running ManiVault core and is safe to run on a worker thread
+namespace kernels
+{
+    struct SpectralOrderingSettings
+    {
+        std::int32_t        numNeighbors    = 15;       // neighbours per point in the kNN graph
+        std::int32_t        maxIterations   = 50;       // power iterations per level of the multilevel Fiedler vector computation
+        float               tolerance       = 1e-5f;    // stop when the Fiedler vector changes less than this (L2)
+        const CancelFlag*   cancelled       = nullptr;  // checked between power iterations, a cancelled ordering is left unfinished
+    };
+
+    // the numNeighbors nearest neighbours of every point (excluding the point itself), sorted by distance
+    // points are interleaved x, y pairs, neighbors and squaredDistances hold numNeighbors entries per point
+    // neighbours are searched in a uniform grid, so the cost is linear in the number of points for evenly spread embeddings
+    void nearestNeighbors2D(std::span<const float> points, std::int32_t numNeighbors, std::vector<std::uint32_t>& neighbors, std::vector<float>& squaredDistances);
+
+    // coordinate in [0, 1] per point, the rank of the point along the ordering divided by (numPoints - 1)
+    // points are interleaved x, y pairs, the ordering is oriented along the principal axis of the points
+    // when cancelled the coordinates are all 0
+    void spectralOrdering(std::span<const float> points, std::vector<float>& coordinates, const SpectralOrderingSettings& settings = {});
+}
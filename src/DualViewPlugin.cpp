@@ -3,12 +3,17 @@
 //#include "ChartWidget.h"
 #include "ScatterplotWidget.h"
 #include "EmbeddingLinesWidget.h"
+#include "Compute/PerformanceTrace.h"
 
+#include <AbstractProjectManager.h>
 #include <DatasetsMimeData.h>
 
 #include <vector>
 #include <random>
 #include <unordered_set>
+#include <numeric>
+#include <utility>
+#include <span>
 
 #include <QString>
 #include <QStringList>
@@ -17,11 +22,12 @@
 #include <QVariantMap>
 #include <QMimeData>
 #include <QDebug>
+#include <QCryptographicHash>
 #include <QTableWidget>
+#include <QTimer>
 
 #include <actions/ViewPluginSamplerAction.h>
 
-#include <chrono>
 
 //#include <QWebEnginePage>
 //#include <QWebEngineView>
@@ -92,6 +98,7 @@ DualViewPlugin::DualViewPlugin(const PluginFactory* factory) :
 
     // toolbar line widget
     _linesToolbarAction.addAction(&_settingsAction.getLineSettingsAction());
+    _linesToolbarAction.addAction(&_settingsAction.getPerformanceSettingsAction());
 
     // context menu
     connect(_embeddingWidgetA, &ScatterplotWidget::customContextMenuRequested, this, [this](const QPoint& point) {
@@ -200,10 +207,8 @@ DualViewPlugin::DualViewPlugin(const PluginFactory* factory) :
                 }
                 else {
 
-                    // Use the clusters set for points color
+                    // Use the clusters set for points color, the points are colored once the changed handler of the metadata marked them stale
                     dropRegions << new DropWidget::DropRegion(this, "Color", description, "palette", true, [this, candidateDataset]() {
-                        _settingsAction.getColoringActionA().setCurrentColorDataset(candidateDataset);
-
                         _metaDatasetA = candidateDataset;
                         qDebug() << "DropWidget metaDatasetA is set to " << _metaDatasetA->getGuiName();
                         });
@@ -299,10 +304,8 @@ DualViewPlugin::DualViewPlugin(const PluginFactory* factory) :
                 }
                 else {
 
-                    // Use the clusters set for points color
+                    // Use the clusters set for points color, the points are colored once the changed handler of the metadata marked them stale
                     dropRegions << new DropWidget::DropRegion(this, "Color", description, "palette", true, [this, candidateDataset]() {
-                        _settingsAction.getColoringActionB().setCurrentColorDataset(candidateDataset);
-
                         _metaDatasetB = candidateDataset;
                         qDebug() << "DropWidget metaDatasetB is set to " << _metaDatasetB->getGuiName();
 
@@ -359,23 +362,24 @@ DualViewPlugin::DualViewPlugin(const PluginFactory* factory) :
         retrieveGOtermGenes(goTermID);
         });
 
-    getSamplerAction().setWidgetViewGeneratorFunction([this](const ViewPluginSamplerAction::SampleContext& toolTipContext) -> QWidget* { //, widgetSampleScope
-
-        QString html = toolTipContext["GeneInfo"].toString();
+    // (Re-)send the cached sections once the page has connected to the web channel
+    connect(_sampleScopeCommObject, &ChartCommObject::notifyJsBridgeIsAvailable, this, [this]() {
+        _sampleScopeReady = true;
+        for (auto it = _sampleScopeSections.constBegin(); it != _sampleScopeSections.constEnd(); ++it)
+            emit _sampleScopeCommObject->qt_js_setSampleScopeSection(it.key(), it.value().toMap());
+        });
 
-        if (toolTipContext.contains("EnrichmentTable"))
-        {
-            QString tableHtml = toolTipContext["EnrichmentTable"].toString();
-            html += tableHtml;
-        }
+    getSamplerAction().setWidgetViewGeneratorFunction([this](const ViewPluginSamplerAction::SampleContext& toolTipContext) -> QWidget* {
 
-        html += "</body></html>";
+        // the page template is loaded once, afterwards only the changed sections are pushed
+        if (_sampleScopeWidget->url().isEmpty())
+            _sampleScopeWidget->setUrl(QUrl("qrc:/dual_view/sample_scope/sample_scope.html"));
 
-        qDebug() << "_sampleScopewidget " << _sampleScopeWidget;
+        // sections that are missing from the context are hidden
+        for (const QString& section : { QStringLiteral("Selection"), QStringLiteral("Enrichment") })
+            pushSampleScopeSection(section, toolTipContext.value(section).toMap());
 
-        _sampleScopeWidget->setHtml(html);
         return _sampleScopeWidget;
-        //return widgetSampleScope;
         });
 
     getSamplerAction().getEnabledAction().setChecked(false);
@@ -468,6 +472,8 @@ void DualViewPlugin::init()
     connect(&_embeddingDatasetB, &Dataset<Points>::changed, this, &DualViewPlugin::embeddingDatasetBChanged);
 
     connect(&_embeddingDatasetA, &Dataset<Points>::dataSelectionChanged, this, [this]() {
+        TRACE_SCOPE("DualViewPlugin::embeddingDatasetASelectionChanged");
+
         if (!_embeddingDatasetA.isValid() || !_embeddingDatasetB.isValid())
             return;
 
@@ -475,30 +481,27 @@ void DualViewPlugin::init()
         //qDebug() << "embeddingDatasetA dataSelectionChanged" << test;
 
         _isEmbeddingASelected = true;
-        highlightSelectedLines(_embeddingDatasetA);
-        highlightSelectedEmbeddings(_embeddingWidgetA, _embeddingDatasetA);
+        std::uint32_t products = Highlights;
 
         if (_embeddingDatasetA->getSelection<Points>()->indices.size() != 0)
-        {
-            updateEmbeddingBSize();//if selected in embedding A and coloring/sizing embedding B by the mean expression of the selected genes     
-            sendDataToSampleScope();
-        }
+            products |= SizeB | SampleScope; //if selected in embedding A and coloring/sizing embedding B by the mean expression of the selected genes
+
+        markStale(products);
 
         });
 
     connect(&_embeddingDatasetB, &Dataset<Points>::dataSelectionChanged, this, [this]() {
+        TRACE_SCOPE("DualViewPlugin::embeddingDatasetBSelectionChanged");
+
         if (!_embeddingDatasetA.isValid() || !_embeddingDatasetB.isValid())
             return;
         _isEmbeddingASelected = false;
+        std::uint32_t products = Highlights;
 
         if (_embeddingDatasetB->getSelection<Points>()->indices.size() != 0)
-        {
-            updateEmbeddingASize();//if selected in embedding B and coloring/sizing embedding A by the number of connected cells
-            sendDataToSampleScope();
-        }
+            products |= SizeA | SampleScope; //if selected in embedding B and coloring/sizing embedding A by the number of connected cells
 
-        highlightSelectedLines(_embeddingDatasetB); // need to be put after updateEmbeddingASize if use diffselectionvsall for highlighting
-        highlightSelectedEmbeddings(_embeddingWidgetB, _embeddingDatasetB);
+        markStale(products);
         });
 
     // TEMP: hard code the isNotifyDuringSelection to false
@@ -537,22 +540,17 @@ void DualViewPlugin::init()
     // selection in embedding lines widget
     connect(&_embeddingLinesWidget->getPixelSelectionTool(), &PixelSelectionTool::areaChanged, [this]() {
         if (_embeddingLinesWidget->getPixelSelectionTool().isNotifyDuringSelection()) {
-            std::vector<mv::Vector2f> both1DEmbeddingPositions;
-            both1DEmbeddingPositions.reserve(_embedding_src.size() + _embedding_dst.size());
-            both1DEmbeddingPositions.insert(both1DEmbeddingPositions.end(), _embedding_src.begin(), _embedding_src.end());
-            both1DEmbeddingPositions.insert(both1DEmbeddingPositions.end(), _embedding_dst.begin(), _embedding_dst.end());
-            selectPoints(_embeddingLinesWidget, both1DEmbeddingPositions);
+            // the shared buffer already has both 1D embeddings in the layout of the lines widget
+            const SharedOneDEmbeddingPositions positions = _oneDEmbeddingPositions;
+            selectPoints(_embeddingLinesWidget, positions->points);
         }
         });
     connect(&_embeddingLinesWidget->getPixelSelectionTool(), &PixelSelectionTool::ended, [this]() {
         if (_embeddingLinesWidget->getPixelSelectionTool().isNotifyDuringSelection())
             return;
 
-        std::vector<mv::Vector2f> both1DEmbeddingPositions;
-        both1DEmbeddingPositions.reserve(_embedding_src.size() + _embedding_dst.size());
-        both1DEmbeddingPositions.insert(both1DEmbeddingPositions.end(), _embedding_src.begin(), _embedding_src.end());
-        both1DEmbeddingPositions.insert(both1DEmbeddingPositions.end(), _embedding_dst.begin(), _embedding_dst.end());
-        selectPoints(_embeddingLinesWidget, both1DEmbeddingPositions);
+        const SharedOneDEmbeddingPositions positions = _oneDEmbeddingPositions;
+        selectPoints(_embeddingLinesWidget, positions->points);
 
         });
 
@@ -565,58 +563,39 @@ void DualViewPlugin::init()
         });
 
     connect(&_oneDEmbeddingDatasetA, &Dataset<Points>::dataChanged, this, [this]() {
-        update1DEmbeddingPositions(true);
+        markStale(OneDPositionsA);
         });
 
     connect(&_oneDEmbeddingDatasetB, &Dataset<Points>::dataChanged, this, [this]() {
-        update1DEmbeddingPositions(false);
+        markStale(OneDPositionsB);
         });
 
-    // update the dropped metadata for coloring 1D embeddings
-    connect(&_metaDatasetA, &Dataset<Cluster>::dataChanged, this, [this]() {
-        update1DEmbeddingColors(true);
+    // publish the computed 1D embeddings of embeddings without one
+    connect(&_oneDEmbeddingEngine, &OneDEmbeddingEngine::finished, this, &DualViewPlugin::oneDEmbeddingComputed);
 
-        _settingsAction.getColoringActionA().updateScatterPlotWidgetColors();// update color in 2D embedding A
+    // show the 1D embeddings in the crossing minimizing order
+    connect(&_lineLayoutEngine, &LineLayoutEngine::finished, this, &DualViewPlugin::lineLayoutComputed);
 
-        qDebug() << "metaDatasetA dataChanged";
+    // keep the marker genes of the clusters of B for selections of a whole cluster
+    connect(&_markerGeneEngine, &MarkerGeneEngine::finished, this, &DualViewPlugin::clusterMarkersComputed);
+    connect(&_markerGeneEngine, &MarkerGeneEngine::rankIndexBuilt, this, &DualViewPlugin::geneRankIndexBuilt);
+
+    // update the dropped metadata for coloring the 1D and 2D embeddings
+    connect(&_metaDatasetA, &Dataset<Cluster>::dataChanged, this, [this]() {
+        markStale(ColorsA | OneDColorsA);
         });
 
     connect(&_metaDatasetA, &Dataset<Cluster>::changed, this, [this]() {
-        update1DEmbeddingColors(true);
-
-        if (_metaDatasetA.isValid())
-        {
-            _settingsAction.getColoringActionA().setCurrentColorDataset(_metaDatasetA);
-        }
-        else
-            qDebug() << "_metaDatasetA changed: metaDatasetA is not valid";
-
+        markStale(ColorsA | OneDColorsA);
         });
 
+    // the top cluster for each gene follows the clusters of B as well
     connect(&_metaDatasetB, &Dataset<Cluster>::dataChanged, this, [this]() {
-        update1DEmbeddingColors(false);
-
-        _settingsAction.getColoringActionB().updateScatterPlotWidgetColors();// update color in 2D embedding B
-
-        qDebug() << "metaDatasetB dataChanged";
+        markStale(ColorsB | OneDColorsB | TopCells);
         });
 
     connect(&_metaDatasetB, &Dataset<Cluster>::changed, this, [this]() {
-        update1DEmbeddingColors(false);
-
-        if (_metaDatasetB.isValid())
-        {
-            _settingsAction.getColoringActionB().setCurrentColorDataset(_metaDatasetB);
-        }
-        else
-            qDebug() << "_metaDatasetB changed: metaDatasetB is not valid";
-
-        // FIXME: this is a hack to update the top cell types of each gene
-        if (!_loadingFromProject)
-        {
-            computeTopCellForEachGene();
-        }
-
+        markStale(ColorsB | OneDColorsB | TopCells);
         });
 
     connect(&getSamplerAction(), &ViewPluginSamplerAction::sampleContextRequested, this, &DualViewPlugin::samplePoints);
@@ -633,74 +612,210 @@ void DualViewPlugin::init()
     connect(_client, &EnrichmentAnalysis::enrichmentDataNotExists, this, &DualViewPlugin::noDataEnrichmentTable);
 
     connect(_client, &EnrichmentAnalysis::genesFromGOtermDataReady, this, &DualViewPlugin::highlightGOTermGenesInEmbedding);
+    connect(_client, &EnrichmentAnalysis::localGeneSetsLoaded, this, &DualViewPlugin::getEnrichmentAnalysis);
+
+    // the enrichment results on disk are switched off and cleared together with the derived data cache
+    auto& cacheSizeAction = _settingsAction.getPerformanceSettingsAction().getCacheSizeAction();
+    const auto updateEnrichmentCacheSize = [this](std::int32_t cacheSize) {
+        _client->getCache().setMaxSize(cacheSize > 0 ? EnrichmentCache::defaultMaxSize : 0);
+    };
+
+    updateEnrichmentCacheSize(cacheSizeAction.getValue());
+    connect(&cacheSizeAction, &IntegralAction::valueChanged, this, updateEnrichmentCacheSize);
+
+    connect(&_settingsAction.getPerformanceSettingsAction().getClearCacheAction(), &TriggerAction::triggered, this, [this]() {
+        _client->getCache().clear();
+        });
+
+    // stale products are computed once the project finished loading or the view is shown
+    connect(&mv::projects(), &mv::AbstractProjectManager::projectOpened, this, &DualViewPlugin::scheduleStaleProductsUpdate);
+    getWidget().installEventFilter(this);
 }
 
-void DualViewPlugin::update1DEmbeddingPositions(bool isA)
+bool DualViewPlugin::eventFilter(QObject* target, QEvent* event)
 {
-    QString embeddingName = isA ? "A" : "B";
-    //qDebug() << "<<<<< update1DEmbeddingPositions " << embeddingName;
-
-    if (isA)
-    {   // A
-        std::vector<mv::Vector2f> embedding_src;
-        // FIXME: _oneDEmbeddingDatasetA could be not updated, i.e. the 1D embedding can be from the previous 2D embedding dataset, maybe add check numPoints; 
-        // FIXME: or if _oneDEmbeddingDatasetA is cleared in embeddingDatasetChanged, then do not need to check numPoints
-        if (_oneDEmbeddingDatasetA.isValid())
-        {
-            std::vector<float> yValuesA;
-            _oneDEmbeddingDatasetA->extractDataForDimension(yValuesA, 0);
-            //qDebug() << "yValuesA.size()" << yValuesA.size();
+    if (target == &getWidget() && event->type() == QEvent::Show)
+        scheduleStaleProductsUpdate();
 
-            embedding_src.reserve(yValuesA.size());
-            for (const float& yValue : yValuesA) {
-                embedding_src.emplace_back(1.0f, yValue);
-            }
+    return ViewPlugin::eventFilter(target, event);
+}
+
+void DualViewPlugin::markStale(std::uint32_t products)
+{
+    // products that are computed from a stale product are stale as well
+    static const std::vector<std::pair<DerivedProduct, std::uint32_t>> dependents = {
+        { ColumnStatisticsB,    LineConnections | TopCells },
+        { OneDPositionsA,       OneDColorsA | OneDColorsB | LineLayout },  // setting the 1D positions resets the colors of both sides
+        { OneDPositionsB,       OneDColorsA | OneDColorsB | LineLayout },
+        { LineConnections,      Highlights | LineLayout },                 // setting the lines clears the highlights
+    };
+
+    // the table is in dependency order, so a single pass reaches all dependents
+    for (const auto& [product, productDependents] : dependents)
+        if (products & product)
+            products |= productDependents;
+
+    _staleProducts |= products;
+
+    scheduleStaleProductsUpdate();
+}
+
+void DualViewPlugin::scheduleStaleProductsUpdate()
+{
+    if (_staleProducts == 0 || _staleProductsUpdateScheduled)
+        return;
+
+    // all changes of this event loop turn are coalesced, e.g. both embeddings being set at once
+    _staleProductsUpdateScheduled = true;
+    QTimer::singleShot(0, this, &DualViewPlugin::updateStaleProducts);
+}
+
+void DualViewPlugin::updateStaleProducts()
+{
+    _staleProductsUpdateScheduled = false;
+
+    // while a project opens, datasets and settings change several times: only the final state is computed,
+    // and a hidden view is only computed when it is shown
+    if (_staleProducts == 0 || _loadingFromProject || mv::projects().isOpeningProject() || !getWidget().isVisible())
+        return;
+
+    TRACE_SCOPE("DualViewPlugin::updateStaleProducts");
+
+    // products marked stale while updating are handled in a next turn
+    const std::uint32_t products = std::exchange(_staleProducts, 0u);
+
+    if (products & ColumnStatisticsB)
+        updateColumnStatisticsB();
+
+    // computed on a worker thread, see clusterMarkersComputed
+    if (products & TopCells)
+        computeTopCellForEachGene();
+
+    // both sides are uploaded at once
+    if (products & (OneDPositionsA | OneDPositionsB))
+        update1DEmbeddingPositions(products & OneDPositionsA, products & OneDPositionsB);
+
+    if (products & ColorsA)
+        updateEmbeddingColors(true);
+
+    if (products & ColorsB)
+        updateEmbeddingColors(false);
+
+    if (products & OneDColorsA)
+        update1DEmbeddingColors(true);
+
+    if (products & OneDColorsB)
+        update1DEmbeddingColors(false);
+
+    if (products & LineConnections)
+        updateLineConnections();
+
+    // computed on a worker thread from the current positions and lines, see lineLayoutComputed
+    if (products & LineLayout)
+        updateLineLayout();
+
+    // the sizes are updated before the highlights, highlighting the lines of a selection in B uses the
+    // selection vs all differences computed by updateEmbeddingASize
+    if (products & SizeA)
+        updateEmbeddingASize();
+
+    if (products & SizeB)
+        updateEmbeddingBSize();
+
+    if (products & Highlights)
+    {
+        if (_isEmbeddingASelected)
+        {
+            highlightSelectedLines(_embeddingDatasetA);
+            highlightSelectedEmbeddings(_embeddingWidgetA, _embeddingDatasetA);
         }
         else
         {
-            qDebug() << "_oneDEmbeddingDatasetA not valid, use projection";
-            embedding_src = _embeddingPositionsA;
+            highlightSelectedLines(_embeddingDatasetB);
+            highlightSelectedEmbeddings(_embeddingWidgetB, _embeddingDatasetB);
         }
+    }
+
+    if (products & SampleScope)
+        sendDataToSampleScope();
+}
 
-        normalizeYValues(embedding_src);
+void DualViewPlugin::updateEmbeddingColors(bool isA)
+{
+    const auto& metaDataset = isA ? _metaDatasetA : _metaDatasetB;
+    auto& coloringAction = isA ? _settingsAction.getColoringActionA() : _settingsAction.getColoringActionB();
 
-        projectToVerticalAxis(embedding_src, 0.0f);
-        _embedding_src = embedding_src;
+    if (!metaDataset.isValid())
+    {
+        qDebug() << "updateEmbeddingColors: metaDataset" << (isA ? "A" : "B") << "is not valid";
+        return;
     }
+
+    // setting the color dataset recolors the points as well
+    if (coloringAction.getCurrentColorDataset() == metaDataset)
+        coloringAction.updateScatterPlotWidgetColors();
     else
-    {   // B
-        std::vector<mv::Vector2f> embedding_dst;
-        if (_oneDEmbeddingDatasetB.isValid())
+        coloringAction.setCurrentColorDataset(metaDataset);
+}
+
+void DualViewPlugin::update1DEmbeddingPositions(bool updateA, bool updateB)
+{
+    TRACE_SCOPE("DualViewPlugin::update1DEmbeddingPositions");
+
+    // FIXME: the 1D embedding can be from the previous 2D embedding dataset, maybe add check numPoints
+    const auto numPositions = [](const mv::Dataset<Points>& oneDEmbeddingDataset, const std::vector<mv::Vector2f>& embeddingPositions) -> std::size_t {
+        return oneDEmbeddingDataset.isValid() ? oneDEmbeddingDataset->getNumPoints() : embeddingPositions.size();
+    };
+
+    // the 1D embedding (or the projection of the 2D embedding) normalized on a vertical axis at x
+    const auto computePositions = [](const mv::Dataset<Points>& oneDEmbeddingDataset, const std::vector<mv::Vector2f>& embeddingPositions, float x, std::span<mv::Vector2f> positions) {
+        if (oneDEmbeddingDataset.isValid())
         {
-            std::vector<float> yValuesB;
-            _oneDEmbeddingDatasetB->extractDataForDimension(yValuesB, 0);
-            //qDebug() << "yValuesB.size()" << yValuesB.size();
+            std::vector<float> yValues;
+            oneDEmbeddingDataset->extractDataForDimension(yValues, 0);
 
-            embedding_dst.reserve(yValuesB.size());
-            for (const float& yValue : yValuesB) {
-                embedding_dst.emplace_back(1.0f, yValue);
-            }
+            for (std::size_t i = 0; i < positions.size() && i < yValues.size(); i++)
+                positions[i] = mv::Vector2f(x, yValues[i]);
         }
         else
         {
-            qDebug() << "_oneDEmbeddingDatasetB not valid, use projection";
-            embedding_dst = _embeddingPositionsB;
+            qDebug() << "1D embedding not valid, use projection";
+            std::copy(embeddingPositions.begin(), embeddingPositions.end(), positions.begin());
         }
 
-        normalizeYValues(embedding_dst);
-        projectToVerticalAxis(embedding_dst, 1.0f); // TODO : make this value dynamic
-        _embedding_dst = embedding_dst;
-    }
+        normalizeYValues(positions);
+        projectToVerticalAxis(positions, x); // TODO : make this value dynamic
+    };
+
+    // a shared buffer is never modified, the side that did not change is taken over from the previous one
+    const SharedOneDEmbeddingPositions previous = _oneDEmbeddingPositions;
+
+    auto positions = std::make_shared<OneDEmbeddingPositions>();
+    positions->numSrc = updateA ? numPositions(_oneDEmbeddingDatasetA, _embeddingPositionsA) : previous->numSrc;
+    positions->points.resize(positions->numSrc + (updateB ? numPositions(_oneDEmbeddingDatasetB, _embeddingPositionsB) : previous->numDst()));
+
+    const std::span<mv::Vector2f> src = std::span<mv::Vector2f>(positions->points).first(positions->numSrc);
+    const std::span<mv::Vector2f> dst = std::span<mv::Vector2f>(positions->points).subspan(positions->numSrc);
 
-    _embeddingLinesWidget->setData(_embedding_src, _embedding_dst);
+    if (updateA)
+        computePositions(_oneDEmbeddingDatasetA, _embeddingPositionsA, 0.0f, src);
+    else
+        std::copy(previous->src().begin(), previous->src().end(), src.begin());
+
+    if (updateB)
+        computePositions(_oneDEmbeddingDatasetB, _embeddingPositionsB, 1.0f, dst);
+    else
+        std::copy(previous->dst().begin(), previous->dst().end(), dst.begin());
 
-    update1DEmbeddingColors(true);
-    update1DEmbeddingColors(false);
+    _oneDEmbeddingPositions = std::move(positions);
 
+    _embeddingLinesWidget->setData(_oneDEmbeddingPositions);
 }
 
 void DualViewPlugin::update1DEmbeddingColors(bool isA)
 {
+    TRACE_SCOPE("DualViewPlugin::update1DEmbeddingColors");
+
     QString embeddingName = isA ? "A" : "B";
 
     auto positionDataset = isA ? _embeddingDatasetA : _embeddingDatasetB;
@@ -709,47 +824,33 @@ void DualViewPlugin::update1DEmbeddingColors(bool isA)
     if (!metaDataset.isValid() || !positionDataset.isValid())
         return;
 
-    std::vector<std::uint32_t> globalIndices;
-    positionDataset->getGlobalIndices(globalIndices);
-
-    int totalNumPoints = positionDataset->isDerivedData()
-        ? positionDataset->getSourceDataset<Points>()->getFullDataset<Points>()->getNumPoints()
-        : positionDataset->getFullDataset<Points>()->getNumPoints();
-
-    std::vector<Vector3f> globalColors(totalNumPoints, Vector3f(0.0f, 0.0f, 0.0f));
-    std::vector<Vector3f> localColors(positionDataset->getNumPoints());
-
-    for (const auto& cluster : metaDataset.get<Clusters>()->getClusters())
-    {
-        const auto& color = Vector3f(cluster.getColor().redF(), cluster.getColor().greenF(), cluster.getColor().blueF());
-        for (const auto& index : cluster.getIndices())
-            globalColors[index] = color;
-    }
-
-#pragma omp parallel for
-    for (int i = 0; i < globalIndices.size(); i++)
-    {
-        localColors[i] = globalColors[globalIndices[i]];
-    }
+    // points in no cluster are black
+    auto& clusterColorCache = getClusterColorCache(isA);
+    if (!clusterColorCache.update(metaDataset, positionDataset, Vector3f(0.0f, 0.0f, 0.0f)))
+        return;
 
-    if (isA)
-        _embeddingLinesWidget->setPointColorA(localColors);
-    else
-        _embeddingLinesWidget->setPointColorB(localColors);
+    _embeddingLinesWidget->setPointLabels(isA, clusterColorCache.getLabels(), clusterColorCache.getPalette());
 }
 
 void DualViewPlugin::updateLineConnections()
 {
-    if (_embedding_src.empty() || _embedding_dst.empty())
+    TRACE_JOB("DualViewPlugin::updateLineConnections");
+
+    if (_oneDEmbeddingPositions->numSrc == 0 || _oneDEmbeddingPositions->numDst() == 0)
     {
         qDebug() << "Both 1D embedding positions must be assigned before connecting lines";
         return;
     }
 
+    // at an HSNE scale a landmark is connected to the genes by the mean expression over its area of influence, the membership is
+    // read when embedding B changes, see updateLandmarkMembershipB
+    if (!_landmarkMembershipB.empty())
+    {
+        updateLandmarkLineConnections();
+        return;
+    }
+
     // define lines - assume embedding A is dimension embedding, embedding B is observation embedding
-    const int64_t numDimensions = _embeddingSourceDatasetB->getNumDimensions(); // Assume the number of points in A is the same as the number of dimensions in B
-    const int64_t numDimensionsFull = _embeddingSourceDatasetB->getNumDimensions(); // FIXME: is this needed??
-    const int64_t numPoints = _embeddingSourceDatasetB->getNumPoints(); // num of points in source dataset B
     const int64_t numPointsLocal = _embeddingDatasetB->getNumPoints(); // num of points in the embedding B
 
     std::vector<std::uint32_t> localGlobalIndicesB;
@@ -757,26 +858,124 @@ void DualViewPlugin::updateLineConnections()
 
     _lines.clear();
 
-    // Iterate over each row and column in the subset to generate lines
-    auto start2 = std::chrono::high_resolution_clock::now();
-    for (int64_t cellLocalIndex = 0; cellLocalIndex < numPointsLocal; cellLocalIndex++) {
-        for (int64_t dimIdx = 0; dimIdx < numDimensions; dimIdx++) {
+    if (localGlobalIndicesB.empty())
+    {
+        _embeddingLinesWidget->setLines(_lines);
+        return;
+    }
 
-            int64_t cellGlobalIdx = static_cast<int64_t>(localGlobalIndicesB[cellLocalIndex]);
-            float expression = _embeddingSourceDatasetB->getValueAt(cellGlobalIdx * numDimensionsFull + dimIdx);
+    const auto cellGlobalIndices = std::span<const std::uint32_t>(localGlobalIndicesB).first(std::min<std::size_t>(numPointsLocal, localGlobalIndicesB.size()));
 
-            //if (expression != columnMins[dimLocalIdx]) { // only draw lines for cells whose expression are not at the minimum
-            if (expression > (_columnMins[dimIdx] + _thresholdLines * _columnRanges[dimIdx])) { // draw lines for cells whose expression are above the thresholdvalue
-                _lines.emplace_back(static_cast<uint32_t>(dimIdx), static_cast<uint32_t>(cellLocalIndex));
-            }
-        }
+    // lines of the same cells at the same threshold may be restored from the project or the disk cache
+    const QByteArray cellsKey = QByteArray::number(static_cast<qulonglong>(kernels::hashBytes(std::as_bytes(cellGlobalIndices))), 16);
+    if (_derivedStatistics.getLines(cellsKey, _thresholdLines, _lines))
+    {
+        qDebug() << "updateLineConnections: restored" << _lines.size() << "lines";
+        trace::Tracer::instance().setCounter("Lines", static_cast<double>(_lines.size()));
+        _embeddingLinesWidget->setLines(_lines);
+        return;
     }
-    auto end2 = std::chrono::high_resolution_clock::now();
-    auto duration2 = std::chrono::duration_cast<std::chrono::milliseconds>(end2 - start2);
-    qDebug() << "Iterate over each row and column in the subset to generate lines took " << duration2.count() << "ms";
+
+    const int64_t numRowsFull = static_cast<int64_t>(*std::max_element(localGlobalIndicesB.begin(), localGlobalIndicesB.end())) + 1;
+
+    // Iterate over each row and column in the subset to generate lines, draw lines for cells whose expression are above the threshold value
+    const bool computed = visitExpressionMatrix(_embeddingSourceDatasetB, numRowsFull, [&](const auto& matrix) {
+        kernels::lineConnections(matrix, cellGlobalIndices, _columnMins, _columnRanges, _thresholdLines, _lines);
+    });
+    if (!computed)
+        qDebug() << "updateLineConnections: no data for" << numRowsFull << "cells in" << _embeddingSourceDatasetB->getGuiName();
+    else if (!_derivedStatistics.getSourceHash().isEmpty())
+        _derivedStatistics.setLines(cellsKey, _thresholdLines, _lines);
 
     //qDebug() << "DualViewPlugin::updateLineConnections() _lines size" << _lines.size();
 
+    trace::Tracer::instance().setCounter("Lines", static_cast<double>(_lines.size()));
+
+    _embeddingLinesWidget->setLines(_lines);
+}
+
+void DualViewPlugin::updateLandmarkMembershipB()
+{
+    TRACE_SCOPE("DualViewPlugin::updateLandmarkMembershipB");
+
+    const LandmarkMembership previousMembership = std::move(_landmarkMembershipB);
+    _landmarkMembershipB = LandmarkMembership();
+
+    // the cells of the clusters and the lines both depend on the landmarks of B
+    const auto markStaleIfChanged = [this, &previousMembership]() {
+        if (_landmarkMembershipB.offsets != previousMembership.offsets || _landmarkMembershipB.points != previousMembership.points)
+            markStale(TopCells | LineConnections);
+    };
+
+    if (!_embeddingDatasetB.isValid() || !_embeddingSourceDatasetB.isValid())
+    {
+        markStaleIfChanged();
+        return;
+    }
+
+    const std::size_t numLandmarks = _embeddingDatasetB->getNumPoints();
+    const auto fullDatasetB = _embeddingSourceDatasetB->getFullDataset<Points>();
+
+    // the HSNE analysis links every landmark of a scale to the data points in its area of influence, other embeddings have no
+    // links into the expression matrix
+    for (const mv::LinkedData& linkedData : _embeddingDatasetB->getLinkedData())
+    {
+        const auto target = linkedData.getTargetDataset();
+        if (!target.isValid() || target->getFullDataset<Points>()->getId() != fullDatasetB->getId())
+            continue;
+
+        const auto& mapping = linkedData.getMapping().getMap();
+        if (mapping.empty())
+            continue;
+
+        _landmarkMembershipB.offsets.assign(numLandmarks + 1, 0);
+        for (const auto& [landmark, points] : mapping)
+            if (landmark < numLandmarks)
+                _landmarkMembershipB.offsets[landmark + 1] = static_cast<std::uint32_t>(points.size());
+
+        std::partial_sum(_landmarkMembershipB.offsets.begin(), _landmarkMembershipB.offsets.end(), _landmarkMembershipB.offsets.begin());
+
+        _landmarkMembershipB.points.resize(_landmarkMembershipB.offsets.back());
+        for (const auto& [landmark, points] : mapping)
+            if (landmark < numLandmarks)
+                std::copy(points.begin(), points.end(), _landmarkMembershipB.points.begin() + _landmarkMembershipB.offsets[landmark]);
+
+        qDebug() << "updateLandmarkMembershipB:" << numLandmarks << "landmarks represent" << _landmarkMembershipB.points.size() << "points of" << fullDatasetB->getGuiName();
+        break;
+    }
+
+    markStaleIfChanged();
+}
+
+void DualViewPlugin::updateLandmarkLineConnections()
+{
+    TRACE_SCOPE("DualViewPlugin::updateLandmarkLineConnections");
+
+    // the lines of every scale are cached by its landmarks, so drilling in and out of a hierarchy only computes the lines of a scale once
+    const auto offsetsHash = kernels::hashBytes(std::as_bytes(std::span<const std::uint32_t>(_landmarkMembershipB.offsets)));
+    const auto pointsHash = kernels::hashBytes(std::as_bytes(std::span<const std::uint32_t>(_landmarkMembershipB.points)));
+    const QByteArray landmarksKey = "landmarks-" + QByteArray::number(static_cast<qulonglong>(offsetsHash), 16) + "-" + QByteArray::number(static_cast<qulonglong>(pointsHash), 16);
+
+    if (_derivedStatistics.getLines(landmarksKey, _thresholdLines, _lines))
+    {
+        qDebug() << "updateLandmarkLineConnections: restored" << _lines.size() << "lines";
+    }
+    else
+    {
+        const int64_t numRowsFull = static_cast<int64_t>(*std::max_element(_landmarkMembershipB.points.begin(), _landmarkMembershipB.points.end())) + 1;
+
+        const bool computed = visitExpressionMatrix(_embeddingSourceDatasetB, numRowsFull, [&](const auto& matrix) {
+            kernels::groupLineConnections(matrix, _landmarkMembershipB.offsets, _landmarkMembershipB.points, _columnMins, _columnRanges, _thresholdLines, _lines);
+        });
+
+        if (!computed)
+            qDebug() << "updateLandmarkLineConnections: no data for" << numRowsFull << "cells in" << _embeddingSourceDatasetB->getGuiName();
+        else if (!_derivedStatistics.getSourceHash().isEmpty())
+            _derivedStatistics.setLines(landmarksKey, _thresholdLines, _lines);
+    }
+
+    trace::Tracer::instance().setCounter("Lines", static_cast<double>(_lines.size()));
+
     _embeddingLinesWidget->setLines(_lines);
 }
 
@@ -796,10 +995,14 @@ void DualViewPlugin::updateEmbeddingDataB()
 
     _embeddingDatasetB->extractDataForDimensions(_embeddingPositionsB, 0, 1);
     _embeddingWidgetB->setData(&_embeddingPositionsB);
+
+    updateLandmarkMembershipB();
 }
 
 void DualViewPlugin::embeddingDatasetAChanged()
 {
+    TRACE_SCOPE("DualViewPlugin::embeddingDatasetAChanged");
+
     _embeddingDropWidgetA->setShowDropIndicator(!_embeddingDatasetA.isValid());
 
     if (!_embeddingDatasetA.isValid())
@@ -839,31 +1042,30 @@ void DualViewPlugin::embeddingDatasetAChanged()
         {
             _oneDEmbeddingDatasetA = child;
             oneDEmbeddingExists = true;
-            update1DEmbeddingPositions(true);
-            updateLineConnections();
 
             break;
         }
     }
 
-    if (!oneDEmbeddingExists)
+    if (oneDEmbeddingExists)
+    {
+        _oneDEmbeddingEngine.cancel(true);
+    }
+    else
     {
-        //compute1DEmbedding(_embeddingDatasetA, _oneDEmbeddingDatasetA);
-        qDebug() << "1D embedding A does not exist";
-        // TODO: clear  _oneDEmbeddingDatasetB and then use projection, and then need to assign the positions to the embedding dataset for selectPoints()
+        // the projection is shown until the computed 1D embedding is published as child, see oneDEmbeddingComputed()
+        qDebug() << "1D embedding A does not exist, computing it";
         _oneDEmbeddingDatasetA = nullptr;
-        update1DEmbeddingPositions(true);
-        updateLineConnections();
+        _oneDEmbeddingEngine.compute(true, _embeddingDatasetA->getId(), _embeddingPositionsA);
     }
 
-    // initialize 
-    // Avoid crash when no selection on A has been made & selection is empty
-    _diffSelectionvsAll.resize(_embeddingSourceDatasetA->getFullDataset<Points>()->getNumPoints(), 0.0f);
-
+    markStale(OneDPositionsA | LineConnections);
 }
 
 void DualViewPlugin::embeddingDatasetBChanged()
 {
+    TRACE_SCOPE("DualViewPlugin::embeddingDatasetBChanged");
+
     _embeddingDropWidgetB->setShowDropIndicator(!_embeddingDatasetB.isValid());
 
     if (!_embeddingDatasetB.isValid())
@@ -882,49 +1084,32 @@ void DualViewPlugin::embeddingDatasetBChanged()
     _metaDatasetB = nullptr;
     qDebug() << "embeddingDatasetBChanged(): metaDatasetB removed";
 
-    // if HSNE, _embeddingSourceDatasetB is a helper (subset of whole data)
-    mv::Dataset<Points> fullDatasetB;
-    if (_embeddingSourceDatasetB->isDerivedData())
-    {
-        qDebug() << "_embeddingSourceDatasetB is derived data";
-        fullDatasetB = _embeddingSourceDatasetB->getSourceDataset<Points>()->getFullDataset<Points>();
-    }
-    else
-    {
-        qDebug() << "_embeddingSourceDatasetB is not derived data";
-        fullDatasetB = _embeddingSourceDatasetB->getFullDataset<Points>();
-    }
-    qDebug() << "fullDatasetB gui name" << fullDatasetB->getGuiName();
-
-    // precompute the data range
-    //computeDataRange(_embeddingSourceDatasetB, _columnMins, _columnRanges);
-    computeDataRange(fullDatasetB, _columnMins, _columnRanges);
-    qDebug() << "Data range computed" << _columnMins.size() << _columnRanges.size() << _columnMins[0] << _columnRanges[0];
+    // before the stale products run, the cells of the clusters and the lines of an HSNE scale come from its landmarks
+    updateLandmarkMembershipB();
 
-    // precompute the mean expression for each gene // TODO: check if recompute is needed
-    //computeMeanExpressionForAllCells(_embeddingSourceDatasetB, _meanExpressionForAllCells);
-    computeMeanExpressionForAllCells(fullDatasetB, _meanExpressionForAllCells);
-    qDebug() << "Mean expression for all cells computed" << _meanExpressionForAllCells.size();
+    // the statistics of the expression matrix are computed with the other stale products
+    markStale(ColumnStatisticsB);
 
-    // set the background gene names for the enrichment analysis
-    if (_embeddingSourceDatasetB->getDimensionNames().size() < 20000) // FIXME: hard code the threshold for the number of genes
+    // set the background gene names for the enrichment analysis, the client prepares them once for all later queries
     {
-        if (_backgroundGeneNames.size() == _embeddingSourceDatasetB->getDimensionNames().size())
+        QStringList backgroundGeneNames;
+        const auto dimNames = _embeddingSourceDatasetB->getDimensionNames();
+        backgroundGeneNames.reserve(static_cast<qsizetype>(dimNames.size()));
+        for (const auto& name : dimNames) {
+            backgroundGeneNames.append(name);
+        }
+
+        if (backgroundGeneNames == _backgroundGeneNames)
         {
             qDebug() << "Background gene names already set";
         }
         else
         {
-            _backgroundGeneNames.clear();
-            auto dimNames = _embeddingSourceDatasetB->getDimensionNames();
-            for (const auto& name : dimNames) {
-                _backgroundGeneNames.append(name);
-            }
+            _backgroundGeneNames = backgroundGeneNames;
+            _client->setBackground(_backgroundGeneNames);
             qDebug() << _backgroundGeneNames.size() << " background gene names set";
         }
     }
-    else
-        qDebug() << "Background gene names not set: genes at least 20000";
 
     // update 1D embedding
     bool oneDEmbeddingExists = false;
@@ -934,26 +1119,156 @@ void DualViewPlugin::embeddingDatasetBChanged()
         {
             _oneDEmbeddingDatasetB = child;
             oneDEmbeddingExists = true;
-            update1DEmbeddingPositions(false);
-            updateLineConnections();
 
             break;
         }
     }
 
-    if (!oneDEmbeddingExists)
+    if (oneDEmbeddingExists)
     {
-        //compute1DEmbedding(_embeddingDatasetB, _oneDEmbeddingDatasetB);
-        qDebug() << "1D embedding B does not exist";
-        // TODO: clear  _oneDEmbeddingDatasetB and then use projection, and then need to assign the positions to the embedding dataset for selectPoints()
+        _oneDEmbeddingEngine.cancel(false);
+    }
+    else
+    {
+        // the projection is shown until the computed 1D embedding is published as child, see oneDEmbeddingComputed()
+        qDebug() << "1D embedding B does not exist, computing it";
         _oneDEmbeddingDatasetB = nullptr;
-        update1DEmbeddingPositions(false);
-        updateLineConnections();
+        _oneDEmbeddingEngine.compute(false, _embeddingDatasetB->getId(), _embeddingPositionsB);
+    }
+
+    markStale(OneDPositionsB | LineConnections);
+}
+
+void DualViewPlugin::oneDEmbeddingComputed(bool isA, const QString& datasetId, const std::vector<float>& coordinates)
+{
+    TRACE_SCOPE("DualViewPlugin::oneDEmbeddingComputed");
+
+    auto& embeddingDataset = getEmbeddingDataset(isA);
+
+    // the embedding may have been replaced or changed while the 1D embedding was computed
+    if (!embeddingDataset.isValid() || embeddingDataset->getId() != datasetId || embeddingDataset->getNumPoints() != coordinates.size())
+    {
+        qDebug() << "oneDEmbeddingComputed(): embedding" << (isA ? "A" : "B") << "changed, 1D embedding discarded";
+        return;
     }
+
+    // a derived child of the embedding, like the 1D embeddings of the analysis, so it is found when the embedding is loaded again
+    auto oneDEmbeddingDataset = mv::data().createDerivedDataset<Points>("1D Embedding", embeddingDataset, embeddingDataset);
+    events().notifyDatasetAdded(oneDEmbeddingDataset);
+
+    oneDEmbeddingDataset->setData<float>(coordinates.data(), coordinates.size(), 1);
+
+    (isA ? _oneDEmbeddingDatasetA : _oneDEmbeddingDatasetB) = oneDEmbeddingDataset;
+    events().notifyDatasetDataChanged(oneDEmbeddingDataset);
+
+    markStale((isA ? OneDPositionsA : OneDPositionsB) | LineConnections);
+}
+
+void DualViewPlugin::updateLineLayout()
+{
+    TRACE_SCOPE("DualViewPlugin::updateLineLayout");
+
+    if (!_settingsAction.getLineSettingsAction().getMinimizeCrossingsAction().isChecked())
+    {
+        _lineLayoutEngine.cancel();
+        return;
+    }
+
+    if (_lines.empty() || _oneDEmbeddingPositions->numSrc == 0 || _oneDEmbeddingPositions->numDst() == 0)
+        return;
+
+    // the axis values are the y coordinates, the x coordinate only separates A and B
+    std::vector<float> sourceValues(_oneDEmbeddingPositions->numSrc);
+    std::vector<float> destinationValues(_oneDEmbeddingPositions->numDst());
+
+    std::transform(_oneDEmbeddingPositions->src().begin(), _oneDEmbeddingPositions->src().end(), sourceValues.begin(), [](const mv::Vector2f& position) { return position.y; });
+    std::transform(_oneDEmbeddingPositions->dst().begin(), _oneDEmbeddingPositions->dst().end(), destinationValues.begin(), [](const mv::Vector2f& position) { return position.y; });
+
+    _lineLayoutEngine.compute(std::move(sourceValues), std::move(destinationValues), _lines);
+}
+
+void DualViewPlugin::lineLayoutComputed(const std::vector<float>& sourceValues, const std::vector<float>& destinationValues, quint64 crossingsBefore, quint64 crossingsAfter)
+{
+    TRACE_SCOPE("DualViewPlugin::lineLayoutComputed");
+
+    // the positions or lines may have changed while the layout was computed, a new layout is started then
+    if (sourceValues.size() != _oneDEmbeddingPositions->numSrc || destinationValues.size() != _oneDEmbeddingPositions->numDst())
+    {
+        qDebug() << "lineLayoutComputed(): 1D embeddings changed, line layout discarded";
+        return;
+    }
+
+    qDebug() << "lineLayoutComputed(): line crossings reduced from" << crossingsBefore << "to" << crossingsAfter;
+    trace::Tracer::instance().setCounter("Line crossings", static_cast<double>(crossingsAfter));
+
+    // a shared buffer is never modified, the reordered positions are a new one
+    auto positions = std::make_shared<OneDEmbeddingPositions>(*_oneDEmbeddingPositions);
+
+    for (std::size_t i = 0; i < sourceValues.size(); i++)
+        positions->points[i].y = sourceValues[i];
+
+    for (std::size_t i = 0; i < destinationValues.size(); i++)
+        positions->points[positions->numSrc + i].y = destinationValues[i];
+
+    _oneDEmbeddingPositions = std::move(positions);
+
+    _embeddingLinesWidget->setData(_oneDEmbeddingPositions);
+
+    // setting the positions resets the colors and highlights of the lines view
+    markStale(OneDColorsA | OneDColorsB | Highlights);
+}
+
+void DualViewPlugin::updateColumnStatisticsB()
+{
+    TRACE_JOB("DualViewPlugin::updateColumnStatisticsB");
+
+    if (!_embeddingSourceDatasetB.isValid())
+        return;
+
+    // if HSNE, _embeddingSourceDatasetB is a helper (subset of whole data)
+    mv::Dataset<Points> fullDatasetB;
+    if (_embeddingSourceDatasetB->isDerivedData())
+    {
+        qDebug() << "_embeddingSourceDatasetB is derived data";
+        fullDatasetB = _embeddingSourceDatasetB->getSourceDataset<Points>()->getFullDataset<Points>();
+    }
+    else
+    {
+        qDebug() << "_embeddingSourceDatasetB is not derived data";
+        fullDatasetB = _embeddingSourceDatasetB->getFullDataset<Points>();
+    }
+    qDebug() << "fullDatasetB gui name" << fullDatasetB->getGuiName();
+
+    // the derived statistics are restored from the project, the disk cache (or kept from before) if the expression matrix did not change
+    _derivedStatistics.setSourceHash(DerivedStatistics::computeSourceHash(fullDatasetB));
+
+    if (_derivedStatistics.getColumnStatistics(_columnMins, _columnRanges, _meanExpressionForAllCells))
+    {
+        qDebug() << "Data range and mean expression restored for" << _columnMins.size() << "genes";
+    }
+    else
+    {
+        // precompute the data range
+        //computeDataRange(_embeddingSourceDatasetB, _columnMins, _columnRanges);
+        computeDataRange(fullDatasetB, _columnMins, _columnRanges);
+        qDebug() << "Data range computed" << _columnMins.size() << _columnRanges.size();
+
+        // precompute the mean expression for each gene
+        //computeMeanExpressionForAllCells(_embeddingSourceDatasetB, _meanExpressionForAllCells);
+        computeMeanExpressionForAllCells(fullDatasetB, _meanExpressionForAllCells);
+        qDebug() << "Mean expression for all cells computed" << _meanExpressionForAllCells.size();
+
+        _derivedStatistics.setColumnStatistics(_columnMins, _columnRanges, _meanExpressionForAllCells);
+    }
+
+    // the rank index is ready by the time a selection in B is tested
+    requestGeneRankIndex();
 }
 
 void DualViewPlugin::highlightSelectedLines(mv::Dataset<Points> dataset)
 {
+    TRACE_SCOPE("DualViewPlugin::highlightSelectedLines");
+
     if (!dataset.isValid())
         return;
 
@@ -983,12 +1298,11 @@ void DualViewPlugin::highlightSelectedLines(mv::Dataset<Points> dataset)
         //_embeddingLinesWidget->setHighlights(localSelectionIndices, false); //true: A, false: B
 
 
-        // Experiment selectionvsAll: highlight lines based on diff AND the global defined connected lines
-        //const float log2FC_threshold = 1.0f;
-        std::vector<bool> enrichedGenes(_diffSelectionvsAll.size(), false);
-        for (int i = 0; i < _diffSelectionvsAll.size(); ++i) {
-            if (_diffSelectionvsAll[i] > _log2FCThreshold)
-                enrichedGenes[i] = true;
+        // Experiment selectionvsAll: highlight the connected lines of the genes enriched in the selection
+        std::vector<bool> enrichedGenes(_embeddingSourceDatasetB->getNumDimensions(), false);
+        for (const auto& gene : _selectionGeneStatistics) {
+            if (gene.gene < enrichedGenes.size() && isEnrichedInSelection(gene))
+                enrichedGenes[gene.gene] = true;
         }
 
         std::vector<std::pair<int, int>> enrichedHighlightedLines;
@@ -999,7 +1313,7 @@ void DualViewPlugin::highlightSelectedLines(mv::Dataset<Points> dataset)
             int cellIdx = line.second;
 
             if (cellIdx >= 0 && cellIdx < selected.size() &&
-                selected[cellIdx] && enrichedGenes[geneIdx])
+                selected[cellIdx] && geneIdx < enrichedGenes.size() && enrichedGenes[geneIdx])
             {
                 enrichedHighlightedLines.emplace_back(geneIdx, cellIdx);
                 highlightedCellSet.insert(cellIdx);
@@ -1014,6 +1328,8 @@ void DualViewPlugin::highlightSelectedLines(mv::Dataset<Points> dataset)
 
 void DualViewPlugin::highlightInputGenes(const QStringList& dimensionNames)
 {
+    TRACE_SCOPE("DualViewPlugin::highlightInputGenes");
+
     if (dimensionNames.isEmpty() || !_embeddingSourceDatasetB.isValid())
         return;
 
@@ -1109,6 +1425,8 @@ void DualViewPlugin::highlightInputGenes(const QStringList& dimensionNames)
 
 void DualViewPlugin::highlightSelectedEmbeddings(ScatterplotWidget*& widget, mv::Dataset<Points> dataset)
 {
+    TRACE_SCOPE("DualViewPlugin::highlightSelectedEmbeddings");
+
     if (!dataset.isValid())
         return;
 
@@ -1130,6 +1448,8 @@ void DualViewPlugin::highlightSelectedEmbeddings(ScatterplotWidget*& widget, mv:
 
 void DualViewPlugin::sendDataToSampleScope()
 {
+    TRACE_JOB("DualViewPlugin::sendDataToSampleScope");
+
     if (getSamplerAction().getEnabledAction().isChecked() == false)
         return;
     qDebug() << "DualViewPlugin::sendDataToSampleScope()";
@@ -1283,25 +1603,14 @@ void DualViewPlugin::sendDataToSampleScope()
         //    _currentGeneSymbols.append(geneSymbol);
         //}
 
-        // Experiment: output genes based on fold change threshold
-        //const float log2FC_threshold = 1.0f;
-        std::vector<std::pair<float, int>> filteredGenes;
-
-        for (int i = 0; i < _diffSelectionvsAll.size(); ++i) {
-            if (_diffSelectionvsAll[i] > _log2FCThreshold) {
-                filteredGenes.emplace_back(_diffSelectionvsAll[i], i);
-            }
-        }
-        // Sort by descending log2FC - TODO: if needed?
-        std::sort(filteredGenes.begin(), filteredGenes.end(), std::greater<std::pair<float, int>>());
+        // output the genes enriched in the selection, by descending test score
+        const auto dimensionNames = _embeddingSourceDatasetB->getDimensionNames();
 
         _currentGeneSymbols.clear();
-        _currentGeneSymbols.reserve(filteredGenes.size());
 
-        for (int i = 0; i < filteredGenes.size(); ++i) {
-            int geneIndex = filteredGenes[i].second;
-            QString geneSymbol = _embeddingSourceDatasetB->getDimensionNames()[geneIndex];
-            _currentGeneSymbols.append(geneSymbol);
+        for (const auto& gene : _selectionGeneStatistics) {
+            if (gene.gene < dimensionNames.size() && isEnrichedInSelection(gene))
+                _currentGeneSymbols.append(dimensionNames[gene.gene]);
         }
     }
 
@@ -1327,29 +1636,24 @@ void DualViewPlugin::sendDataToSampleScope()
         colorDatasetName = mv::data().getDataset(colorDatasetID)->getGuiName();
 
 
-    QString html = buildHtmlForSelection(_isEmbeddingASelected, colorDatasetName, _currentGeneSymbols, labels, data, backgroundColors);
-
+    // kept for the enrichment replies, they are shown together with the selection they belong to
+    _selectionPayload = buildSelectionPayload(_isEmbeddingASelected, colorDatasetName, _currentGeneSymbols, labels, data, backgroundColors);
 
     getSamplerAction().setSampleContext({
-        { "GeneInfo", html}
+        { "Selection", _selectionPayload }
         });
 
-    // cache
-    _currentHtmlGeneInfo.clear();
-    _currentHtmlGeneInfo = html;
     qDebug() << "DualViewPlugin::sendDataToSampleScope() finished.";
 }
 
 void DualViewPlugin::updateEmbeddingBSize()
 {
+    TRACE_JOB("DualViewPlugin::updateEmbeddingBSize");
+
     if (!_embeddingDatasetA.isValid() || !_embeddingDatasetB.isValid())
         return;
 
-    auto start1 = std::chrono::high_resolution_clock::now();
     updateSelectedGeneMeanExpression();
-    auto end1 = std::chrono::high_resolution_clock::now();
-    auto duration1 = std::chrono::duration_cast<std::chrono::milliseconds>(end1 - start1);
-    qDebug() << "updateSelectedGeneMeanExpression() took " << duration1.count() << "ms";
 
     if (_selectedGeneMeanExpression.size() != _embeddingDatasetB->getNumPoints())
     {
@@ -1358,7 +1662,7 @@ void DualViewPlugin::updateEmbeddingBSize()
     }
 
     std::vector<float> selectedGeneMeanExpression;
-    float ptSize = _settingsAction.getEmbeddingBPointPlotAction().getPointPlotActionB().getSizeAction().getMagnitudeAction().getValue();
+    float ptSize = _settingsAction.getEmbeddingBPointPlotAction().getPointPlotAction().getSizeAction().getMagnitudeAction().getValue();
     scaleDataRange(_selectedGeneMeanExpression, selectedGeneMeanExpression, _reversePointSizeB, ptSize);
 
     _embeddingWidgetB->setPointSizeScalars(selectedGeneMeanExpression);
@@ -1379,7 +1683,7 @@ void DualViewPlugin::reversePointSizeB(bool reversePointSizeB)
     }
 
     std::vector<float> selectedGeneMeanExpression;
-    float ptSize = _settingsAction.getEmbeddingBPointPlotAction().getPointPlotActionB().getSizeAction().getMagnitudeAction().getValue();
+    float ptSize = _settingsAction.getEmbeddingBPointPlotAction().getPointPlotAction().getSizeAction().getMagnitudeAction().getValue();
     scaleDataRange(_selectedGeneMeanExpression, selectedGeneMeanExpression, _reversePointSizeB, ptSize);
 
     _embeddingWidgetB->setPointSizeScalars(selectedGeneMeanExpression);
@@ -1387,6 +1691,8 @@ void DualViewPlugin::reversePointSizeB(bool reversePointSizeB)
 
 void DualViewPlugin::updateEmbeddingASize()
 {
+    TRACE_JOB("DualViewPlugin::updateEmbeddingASize");
+
     if (!_embeddingDatasetA.isValid() || !_embeddingDatasetB.isValid())
         return;
 
@@ -1464,35 +1770,18 @@ void DualViewPlugin::updateEmbeddingASize()
 
     // test2 - end
 
-    // test 3 rescale point size of embedding A using the diff between selected cells in B and all cells in B
-    // compute genes of cell selection vs all - start
-    std::vector<float> selectedCellMeanExpression;
-    computeSelectedCellMeanExpression(_embeddingSourceDatasetB, selectedCellMeanExpression);
-    qDebug() << "selectedCellMeanExpression size" << selectedCellMeanExpression.size();
-
-    // selection vs all
-    std::vector<float> diffSelectionvsAll(selectedCellMeanExpression.size(), 0.0f);
-#pragma omp parallel for
-    for (int i = 0; i < selectedCellMeanExpression.size(); i++)
-    {
-        //diffSelectionvsAll[i] = selectedCellMeanExpression[i] - _meanExpressionForAllCells[i]; // difference between selected cells and all cells
-        
-        // log2 ratio 
-        float log2FC = std::log2((selectedCellMeanExpression[i] + 0.05) / (_meanExpressionForAllCells[i] + 0.05)); // log2 ratio between selected cells and all cells
-        //diffSelectionvsAll[i] = std::log2((selectedCellMeanExpression[i]+0.05) / (_meanExpressionForAllCells[i] + 0.05)); // log2 ratio between selected cells and all cells
+    // test 3 rescale point size of embedding A using the test score of the selected cells in B vs the other cells in B
+    // genes that are not significantly higher in the selection keep the smallest size
+    computeSelectionDifferentialExpression();
 
-        diffSelectionvsAll[i] = std::max(0.0f, log2FC);  // suppress downregulated
-
-        if (selectedCellMeanExpression[i] < 0.1f && _meanExpressionForAllCells[i] < 0.1f) // suppress genes with low expression in both selected and all cells
-            diffSelectionvsAll[i] = 0.0f;
+    const float maxAdjustedPValue = _settingsAction.getLineSettingsAction().getFdrThresholdAction().getValue();
 
+    _connectedCellsPerGene.assign(_embeddingSourceDatasetB->getNumDimensions(), 0.0f);
+    for (const auto& gene : _selectionGeneStatistics)
+    {
+        if (gene.gene < _connectedCellsPerGene.size() && gene.adjustedPValue <= maxAdjustedPValue)
+            _connectedCellsPerGene[gene.gene] = std::max(0.0f, gene.score);
     }
-    qDebug() << "diffSelectionvsAll size" << diffSelectionvsAll.size();
-
-    // test to set connectedcellspergene using diffSelectionvsAll
-    //_connectedCellsPerGene.clear();
-    _connectedCellsPerGene = diffSelectionvsAll;
-    _diffSelectionvsAll = diffSelectionvsAll; // FIXME: store for later use, remove later, only keep one or _connectedCellsPerGene
 
     std::vector<float> scaledConnectedCellsPerGene;
     float ptSize = _settingsAction.getEmbeddingAPointPlotAction().getPointPlotAction().getSizeAction().getMagnitudeAction().getValue();
@@ -1513,6 +1802,8 @@ void DualViewPlugin::updateEmbeddingASize()
 
 void DualViewPlugin::samplePoints()
 {
+    TRACE_SCOPE("DualViewPlugin::samplePoints");
+
 
     // for now only for embedding A
     auto& samplerPixelSelectionTool = _embeddingWidgetA->getSamplerPixelSelectionTool();
@@ -1607,6 +1898,11 @@ void DualViewPlugin::samplePoints()
 
 void DualViewPlugin::selectPoints(ScatterplotWidget* widget, mv::Dataset<Points> embeddingDataset, const std::vector<mv::Vector2f>& embeddingPositions)
 {
+    TRACE_SCOPE("DualViewPlugin::selectPoints");
+
+    // the views measure the time from here until they are repainted
+    trace::Tracer::instance().markSelection();
+
     //if (getSettingsAction().getSelectionAction().getFreezeSelectionAction().isChecked())
     //    return;
 
@@ -1728,6 +2024,11 @@ void DualViewPlugin::selectPoints(ScatterplotWidget* widget, mv::Dataset<Points>
 
 void DualViewPlugin::selectPoints(EmbeddingLinesWidget* widget, const std::vector<mv::Vector2f>& embeddingPositions)
 {
+    TRACE_SCOPE("DualViewPlugin::selectLines");
+
+    // the views measure the time from here until they are repainted
+    trace::Tracer::instance().markSelection();
+
     // Only proceed with a valid points position dataset and when the pixel selection tool is active
     /*if (!_oneDEmbeddingDatasetA.isValid() || !_oneDEmbeddingDatasetB.isValid() || !widget->getPixelSelectionTool().isActive())
     {
@@ -1839,6 +2140,8 @@ void DualViewPlugin::selectPoints(EmbeddingLinesWidget* widget, const std::vecto
 
 void DualViewPlugin::updateSelectedGeneMeanExpression()
 {
+    TRACE_JOB("DualViewPlugin::updateSelectedGeneMeanExpression");
+
     std::vector<float> selectedGeneMeanExpressionFull;
     computeSelectedGeneMeanExpression(_embeddingSourceDatasetB, _embeddingDatasetA, selectedGeneMeanExpressionFull);
 
@@ -1873,34 +2176,189 @@ void DualViewPlugin::updateThresholdLines()
     //_thresholdLines = _settingsAction.getThresholdLinesAction().getValue();
     _thresholdLines = _settingsAction.getLineSettingsAction().getThresholdLinesAction().getValue();
 
-    updateLineConnections();
+    // the highlights are reapplied to the new lines
+    markStale(LineConnections);
+}
 
-    if (_isEmbeddingASelected)
+void DualViewPlugin::updateLog2FCThreshold()
+{
+    _log2FCThreshold = _settingsAction.getLineSettingsAction().getlog2FCThresholdAction().getValue();
+
+    // update the diffSelectionvsAll based on the new threshold
+    if (!_isEmbeddingASelected)
+        markStale(Highlights | SampleScope);
+}
+
+void DualViewPlugin::updateMinimizeCrossings()
+{
+    if (_settingsAction.getLineSettingsAction().getMinimizeCrossingsAction().isChecked())
     {
-        highlightSelectedLines(_embeddingDatasetA);
-        highlightSelectedEmbeddings(_embeddingWidgetA, _embeddingDatasetA);
+        markStale(LineLayout);
     }
     else
     {
-        highlightSelectedLines(_embeddingDatasetB);
-        highlightSelectedEmbeddings(_embeddingWidgetB, _embeddingDatasetB);
+        // the 1D positions are recomputed in the order of the 1D embeddings
+        _lineLayoutEngine.cancel();
+        markStale(OneDPositionsA | OneDPositionsB);
     }
 }
 
-void DualViewPlugin::updateLog2FCThreshold()
+void DualViewPlugin::updateDifferentialExpressionSettings()
 {
-    _log2FCThreshold = _settingsAction.getLineSettingsAction().getlog2FCThresholdAction().getValue();
+    // the marker genes of the clusters are ranked for the top genes setting
+    if (!_clusterMarkersKey.isEmpty() && getNumTopGenes() != _clusterMarkersTopK)
+        markStale(TopCells);
 
-    // update the diffSelectionvsAll based on the new threshold
+    // the sizes, the highlighted lines and the genes of the sample scope are computed from the test of a selection in B
     if (!_isEmbeddingASelected)
+        markStale(SizeA | Highlights | SampleScope);
+}
+
+std::size_t DualViewPlugin::getNumTopGenes()
+{
+    return static_cast<std::size_t>(std::max(0, _settingsAction.getLineSettingsAction().getTopGenesAction().getValue()));
+}
+
+void DualViewPlugin::computeSelectionDifferentialExpression()
+{
+    TRACE_JOB("DualViewPlugin::computeSelectionDifferentialExpression");
+
+    _selectionGeneStatistics.clear();
+
+    auto fullDataset = _embeddingSourceDatasetB->getFullDataset<Points>();
+    const std::int64_t numCells = fullDataset->getNumPoints();
+
+    auto selection = fullDataset->getSelection<Points>();
+    std::vector<bool> selected;
+    fullDataset->selectedLocalIndices(selection->indices, selected);
+
+    std::vector<std::uint32_t> selectedIndices;
+    for (std::uint32_t i = 0; i < selected.size(); ++i)
+    {
+        if (selected[i])
+            selectedIndices.push_back(i);
+    }
+
+    auto& lineSettingsAction = _settingsAction.getLineSettingsAction();
+
+    kernels::DifferentialExpressionSettings settings;
+    settings.test = lineSettingsAction.getTestAction().getCurrentIndex() == 1 ? kernels::DifferentialExpressionTest::WelchTTest : kernels::DifferentialExpressionTest::WilcoxonRankSum;
+    settings.topK = getNumTopGenes();
+
+    // a selection of exactly the cells of a cluster gets the precomputed marker genes of that cluster, they are the result of the
+    // Welch test with the same top genes setting
+    const bool useClusterMarkers = settings.test == kernels::DifferentialExpressionTest::WelchTTest && settings.topK == _clusterMarkersTopK;
+
+    for (std::size_t cluster = 0; useClusterMarkers && cluster < _clusterMarkers.size() && cluster < _clusterMarkerCells.size(); cluster++)
+    {
+        const auto& cells = _clusterMarkerCells[cluster];
+        if (cells.size() != selectedIndices.size() || !std::equal(cells.begin(), cells.end(), selectedIndices.begin()))
+            continue;
+
+        _selectionGeneStatistics = _clusterMarkers[cluster];
+
+        qDebug() << "computeSelectionDifferentialExpression: selection is cluster" << cluster << "," << _selectionGeneStatistics.size() << "precomputed marker genes";
+        return;
+    }
+
+    // the rank index is built once per expression matrix in the background, the test of every later selection only visits its
+    // non-zero values, a selection made before it is ready is tested when it is, see geneRankIndexBuilt
+    if (!requestGeneRankIndex())
     {
-        highlightSelectedLines(_embeddingDatasetB);
-        sendDataToSampleScope(); 
+        qDebug() << "computeSelectionDifferentialExpression: waiting for the rank index of" << fullDataset->getGuiName();
+        return;
     }
+
+    visitExpressionMatrix(fullDataset, numCells, [&](const auto& matrix) {
+        kernels::differentialExpression(matrix, *_geneRankIndexB, selectedIndices, settings, _selectionGeneStatistics);
+    });
+
+    const auto numEnriched = std::count_if(_selectionGeneStatistics.begin(), _selectionGeneStatistics.end(), [this](const auto& gene) { return isEnrichedInSelection(gene); });
+    qDebug() << "computeSelectionDifferentialExpression:" << selectedIndices.size() << "selected cells," << numEnriched << "enriched genes";
+}
+
+bool DualViewPlugin::requestGeneRankIndex()
+{
+    if (!_embeddingSourceDatasetB.isValid())
+        return false;
+
+    auto fullDataset = _embeddingSourceDatasetB->getFullDataset<Points>();
+
+    const QString rankIndexKey = fullDataset->getId() + QString::fromLatin1(_derivedStatistics.getSourceHash());
+    if (_geneRankIndexB && rankIndexKey == _geneRankIndexKey)
+        return true;
+
+    if (rankIndexKey == _geneRankIndexBuildKey)
+        return false;
+
+    // the index of the previous matrix is of no use for the new one
+    _geneRankIndexB.reset();
+    _geneRankIndexKey.clear();
+
+    const bool started = visitExpressionMatrix(fullDataset, fullDataset->getNumPoints(), [&](const auto& matrix) {
+        _markerGeneEngine.buildRankIndex(rankIndexKey, matrix);
+    });
+
+    if (!started)
+    {
+        qDebug() << "requestGeneRankIndex: dataset" << fullDataset->getGuiName() << "has no data";
+        _markerGeneEngine.cancelRankIndex();
+        _geneRankIndexBuildKey.clear();
+        return false;
+    }
+
+    _geneRankIndexBuildKey = rankIndexKey;
+
+    return false;
+}
+
+void DualViewPlugin::geneRankIndexBuilt(const QString& key, const std::shared_ptr<const kernels::GeneRankIndex>& index)
+{
+    TRACE_SCOPE("DualViewPlugin::geneRankIndexBuilt");
+
+    // expression matrix B may have changed while the index was built
+    if (key != _geneRankIndexBuildKey)
+    {
+        qDebug() << "geneRankIndexBuilt(): expression matrix changed, rank index discarded";
+        return;
+    }
+
+    _geneRankIndexB = index;
+    _geneRankIndexKey = key;
+    _geneRankIndexBuildKey.clear();
+
+    qDebug() << "geneRankIndexBuilt(): rank index of" << index->getNumGenes() << "genes and" << index->getNumCells() << "cells";
+
+    // a selection in B made in the meantime is tested now
+    if (!_isEmbeddingASelected)
+        markStale(SizeA | Highlights | SampleScope);
+}
+
+bool DualViewPlugin::isEnrichedInSelection(const kernels::GeneStatistics& gene)
+{
+    const float maxAdjustedPValue = _settingsAction.getLineSettingsAction().getFdrThresholdAction().getValue();
+
+    return gene.score > 0.0f && gene.adjustedPValue <= maxAdjustedPValue && gene.log2FoldChange > _log2FCThreshold;
+}
+
+void DualViewPlugin::setPerformanceHudEnabled(bool enabled)
+{
+    _embeddingWidgetA->setShowPerformanceHud(enabled);
+    _embeddingWidgetB->setShowPerformanceHud(enabled);
+    _embeddingLinesWidget->setShowPerformanceHud(enabled);
 }
 
 void DualViewPlugin::computeTopCellForEachGene()
 {
+    TRACE_JOB("DualViewPlugin::computeTopCellForEachGene");
+
+    // the marker genes belong to the previous clusters
+    _markerGeneEngine.cancel();
+    _clusterMarkersKey.clear();
+    _clusterMarkerCells.clear();
+    _clusterMarkers.clear();
+    _topClusterForEachGene.clear();
+
     if (!_embeddingDatasetA.isValid() || !_embeddingDatasetB.isValid() || !_metaDatasetB.isValid())
     {
         //qDebug() << "DualViewPlugin: embeddingDatasetA or embeddingDatasetB or metaDatasetB is not valid";
@@ -1911,161 +2369,176 @@ void DualViewPlugin::computeTopCellForEachGene()
 
     size_t numGene = _embeddingDatasetA->getNumPoints(); // number of genes in the current gene embedding  
 
-    // TEST 2: use the cell type with max avg expression for each gene - START
-
     auto fullDatasetB = _embeddingDatasetB->getSourceDataset<Points>()->getFullDataset<Points>();
 
-    std::vector<std::vector<float>> avgExpressionForEachGeneForEachCluster; // cluster is stored in the same order as in the meta dataset
+    const auto& clusters = _metaDatasetB.get<Clusters>()->getClusters();
+    if (clusters.empty())
+    {
+        qDebug() << "computeTopCellForEachGene(): no clusters in " << _metaDatasetB->getGuiName();
+        return;
+    }
 
-    auto start1 = std::chrono::high_resolution_clock::now();
-    // FIXME: this would return if embedding B is the overview scale of HSNE, do we want this?
-    if (_embeddingDatasetB->getNumPoints() != _embeddingDatasetA->getSourceDataset<Points>()->getNumDimensions())
+    const int64_t numDimensionsFullB = fullDatasetB->getNumDimensions();
+    if (static_cast<int64_t>(numGene) > numDimensionsFullB)
     {
-        //qDebug() << "computeTopCellForEachGene(): num of pt in embeddingDatasetB is different from num of dimensions in embedding A source dataset";
-        //qDebug() << "embeddingDatasetB->getNumPoints() = " << _embeddingDatasetB->getNumPoints() << "sourceDatasetA->getNumDimensions() = " << _embeddingDatasetA->getSourceDataset<Points>()->getNumDimensions();
-        qDebug() << "WARNING: embedding A and embedding B is not corresponded, use the full expression matrix to compute top cell type";
+        qDebug() << "computeTopCellForEachGene(): " << numGene << " genes in embedding A, but only " << numDimensionsFullB << " dimensions in " << fullDatasetB->getGuiName();
+        return;
+    }
 
-        // if not correspond, use the full expression matrix + give a warning      
+    std::vector<std::vector<std::uint32_t>> cellsForEachCluster; // global cell indices, cluster is stored in the same order as in the meta dataset
+    cellsForEachCluster.reserve(clusters.size());
 
-        for (const auto& cluster : _metaDatasetB.get<Clusters>()->getClusters())
+    if (!_landmarkMembershipB.empty())
+    {
+        // at an HSNE scale the cells are those in the area of influence of its landmarks
+        std::vector<bool> representedCells;
+        for (const std::uint32_t cell : _landmarkMembershipB.points)
         {
-            // for this cluster, compute the avg expression for each gene
-            std::vector<float> avgExpressionForEachGene(numGene, 0.0f);
-            int count = 0;
-            for (const int64_t& index : cluster.getIndices()) // index is the global index of the cell in embedding B
-            {
+            if (cell >= representedCells.size())
+                representedCells.resize(cell + 1, false);
+            representedCells[cell] = true;
+        }
 
-                int64_t offset = index * numGene;
-                for (int64_t i = 0; i < numGene; i++)
-                {
-                    avgExpressionForEachGene[i] += fullDatasetB->getValueAt(offset + i);
-                }
-                count++;
+        for (const auto& cluster : clusters)
+        {
+            std::vector<std::uint32_t> cells;
+            for (const auto& globalCellIndex : cluster.getIndices())
+            {
+                if (globalCellIndex < representedCells.size() && representedCells[globalCellIndex])
+                    cells.push_back(globalCellIndex);
             }
 
-            if (count == 0)
-            {
+            if (cells.empty())
                 qDebug() << "No valid indices in cluster " << cluster.getName();
-                //continue;
-                for (int i = 0; i < numGene; i++) {
-                    avgExpressionForEachGene[i] = -100.0f; // TODO: this cluster is actually invalid, FIXME: Keep a separate boolean vector to indicate invalid clusters when choosing top cluster
-                }
-            }
-            else
-            {
-                for (int i = 0; i < numGene; i++)
-                {
-                    avgExpressionForEachGene[i] /= static_cast<float>(count); // better use static_cast<float>(count) ?
-                }
-            }
 
-            avgExpressionForEachGeneForEachCluster.push_back(avgExpressionForEachGene);
+            cellsForEachCluster.push_back(std::move(cells));
+        }
+    }
+    else if (_embeddingDatasetB->getNumPoints() != _embeddingDatasetA->getSourceDataset<Points>()->getNumDimensions())
+    {
+        //qDebug() << "computeTopCellForEachGene(): num of pt in embeddingDatasetB is different from num of dimensions in embedding A source dataset";
+        //qDebug() << "embeddingDatasetB->getNumPoints() = " << _embeddingDatasetB->getNumPoints() << "sourceDatasetA->getNumDimensions() = " << _embeddingDatasetA->getSourceDataset<Points>()->getNumDimensions();
+        qDebug() << "WARNING: embedding A and embedding B is not corresponded, use the full expression matrix to compute top cell type";
+
+        // if not correspond, use the full expression matrix + give a warning      
+        for (const auto& cluster : clusters)
+        {
+            const auto& indices = cluster.getIndices(); // index is the global index of the cell in embedding B
+            cellsForEachCluster.emplace_back(indices.begin(), indices.end());
+
+            if (indices.empty())
+                qDebug() << "No valid indices in cluster " << cluster.getName();
         }
     }
     else // if correspond
     {
-        // map global indices to local indices in embedding B
+        // global indices of the points of embedding B
         std::vector<std::uint32_t> localGlobalIndicesB;
         _embeddingDatasetB->getGlobalIndices(localGlobalIndicesB);
-        //qDebug() << "localGlobalIndicesB.size() = " << localGlobalIndicesB.size();
 
-        // Build a map from global indices to local indices
-        std::unordered_map<std::uint32_t, std::uint32_t> globalToLocalIndexMapB;
-        for (std::uint32_t localIndexB = 0; localIndexB < localGlobalIndicesB.size(); ++localIndexB) {
-            globalToLocalIndexMapB[localGlobalIndicesB[localIndexB]] = localIndexB;
-        }
-        //qDebug() << "globalToLocalIndexMapB.size() = " << globalToLocalIndexMapB.size();
+        // global indices that are part of the local embedding B
+        std::unordered_set<std::uint32_t> globalIndicesB(localGlobalIndicesB.begin(), localGlobalIndicesB.end());
 
-        // compute the avg expression of each gene for each cell type
-
-        for (const auto& cluster : _metaDatasetB.get<Clusters>()->getClusters())
+        for (const auto& cluster : clusters)
         {
-            // for this cluster, compute the avg expression for each gene
-            std::vector<float> avgExpressionForEachGene(numGene, 0.0f);
-            int count = 0;
-
-            for (const size_t& globalCellIndex : cluster.getIndices()) // global cell index in embedding B
+            std::vector<std::uint32_t> cells;
+            for (const auto& globalCellIndex : cluster.getIndices()) // global cell index in embedding B
             {
-                // Check if this global index exists in the local embedding B
-                auto it = globalToLocalIndexMapB.find(globalCellIndex);
-                if (it == globalToLocalIndexMapB.end()) {
-                    // Global index not found in local embedding, skip
-                    continue;
-                }
-
-                // Extract gene expression for this cell from fullDatasetB using global indices
-                //std::vector<float> geneExpression(numGene, 0.0f);
-                //for (int64_t i = 0; i < numGene; i++)
-                //{
-                //    // and getValueAt(row * numGene + col) retrieves the value:
-                //    geneExpression[i] = fullDatasetB->getValueAt((globalCellIndex * numGene) + i);
-                //}
-
-                //qDebug() << "extracted from fullDataA geneExpression.size() = " << geneExpression.size();
-
-                int64_t offset = globalCellIndex * numGene;
-                for (int64_t i = 0; i < numGene; i++)
-                {
-                    //avgExpressionForEachGene[i] += geneExpression[i];
-                    avgExpressionForEachGene[i] += fullDatasetB->getValueAt(offset + i);
-                }
-                count++;
+                // keep the cells of the cluster that are in embedding B, they stay global indices (rows of the full expression matrix)
+                if (globalIndicesB.contains(globalCellIndex))
+                    cells.push_back(globalCellIndex);
             }
 
-            if (count == 0)
-            {
+            if (cells.empty())
                 qDebug() << "No valid indices in cluster " << cluster.getName();
-                //continue;
-                for (int i = 0; i < numGene; i++) {
-                    avgExpressionForEachGene[i] = -100.0f; // TODO: this cluster is actually invalid, FIXME: Keep a separate boolean vector to indicate invalid clusters when choosing top cluster
-                }
-            }
-            else
-            {
-                for (int i = 0; i < numGene; i++)
-                {
-                    avgExpressionForEachGene[i] /= static_cast<float>(count);
-                }
-            }
-            //qDebug() << "avgExpressionForEachGene.size() = " << avgExpressionForEachGene.size();
 
-            avgExpressionForEachGeneForEachCluster.push_back(avgExpressionForEachGene);
-            qDebug() << "In this subset: " << cluster.getName() << " count = " << count;
+            qDebug() << "In this subset: " << cluster.getName() << " count = " << cells.size();
+            cellsForEachCluster.push_back(std::move(cells));
         }
     }
 
-    auto end1 = std::chrono::high_resolution_clock::now();
-    auto duration1 = std::chrono::duration_cast<std::chrono::milliseconds>(end1 - start1);
-    qDebug() << "compute avg expression for each gene for each cell type took " << duration1.count() << " ms";
+    // the summary is keyed by the genes and the cells of each cluster, so it may be restored from the project or the disk cache
+    QCryptographicHash clustersHash(QCryptographicHash::Sha256);
+    clustersHash.addData(QByteArray::number(static_cast<qulonglong>(numDimensionsFullB)));
+    for (const auto& cells : cellsForEachCluster)
+        clustersHash.addData(QByteArray::number(static_cast<qulonglong>(kernels::hashBytes(std::as_bytes(std::span<const std::uint32_t>(cells)))), 16) + "\n");
+    const QByteArray clustersKey = clustersHash.result().toHex();
 
+    // a selection of all cells of a cluster then shows its markers right away, when they are ranked with the selected test
+    _clusterMarkersKey = clustersKey;
+    _clusterMarkersTopK = getNumTopGenes();
+    _clusterMarkerCells = cellsForEachCluster;
+    for (auto& cells : _clusterMarkerCells)
+    {
+        std::sort(cells.begin(), cells.end());
+        cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    }
 
-    // find the cell type with max avg expression for each gene
-    std::vector<int> topCellTypeForEachLocalGene(numGene, -1);
+    // the moments of the clusters and the marker genes are computed in the background, see clusterMarkersComputed
+    kernels::GroupColumnMoments clusterMoments;
 
-    for (int i = 0; i < numGene; i++)
+    if (_derivedStatistics.getClusterSummary(clustersKey, clusterMoments))
     {
-        float maxAvgExpression = avgExpressionForEachGeneForEachCluster[0][i];
-        int maxAvgExpressionIndex = 0;
-        for (int j = 0; j < avgExpressionForEachGeneForEachCluster.size(); j++)
-        {
-            if (avgExpressionForEachGeneForEachCluster[j][i] > maxAvgExpression)
-            {
-                maxAvgExpression = avgExpressionForEachGeneForEachCluster[j][i];
-                maxAvgExpressionIndex = j;
-            }
-        }
-        topCellTypeForEachLocalGene[i] = maxAvgExpressionIndex;
+        qDebug() << "computeTopCellForEachGene(): cluster summary restored";
+        _markerGeneEngine.compute(clustersKey, std::move(clusterMoments), _clusterMarkersTopK);
+        return;
+    }
+
+    // the moments cover all genes of the matrix, so the marker genes are adjusted over the same genes as the test of a selection
+    const bool started = visitExpressionMatrix(fullDatasetB, fullDatasetB->getNumPoints(), [&](const auto& matrix) {
+        _markerGeneEngine.compute(clustersKey, matrix, std::move(cellsForEachCluster), _clusterMarkersTopK);
+    });
+
+    if (!started)
+    {
+        qDebug() << "computeTopCellForEachGene(): no expression data in " << fullDatasetB->getGuiName();
+        _clusterMarkersKey.clear();
+    }
+}
+
+void DualViewPlugin::clusterMarkersComputed(const QByteArray& clustersKey, const kernels::GroupColumnMoments& clusterMoments, bool momentsComputed, const std::vector<std::vector<kernels::GeneStatistics>>& markers)
+{
+    TRACE_SCOPE("DualViewPlugin::clusterMarkersComputed");
+
+    // the clusters may have changed while the markers were ranked
+    if (clustersKey != _clusterMarkersKey || !_metaDatasetB.isValid() || !_embeddingDatasetA.isValid())
+    {
+        qDebug() << "clusterMarkersComputed(): clusters changed, marker genes discarded";
+        return;
     }
-    //qDebug() << "topCellTypeForEachLocalGene.size() = " << topCellTypeForEachLocalGene.size();
 
+    if (momentsComputed && !_derivedStatistics.getSourceHash().isEmpty())
+        _derivedStatistics.setClusterSummary(clustersKey, clusterMoments);
+
+    _clusterMarkers = markers;
+
+    qDebug() << "clusterMarkersComputed(): marker genes of" << _clusterMarkers.size() << "clusters ranked";
+
+    // the cell type with max avg expression for each gene, empty clusters get -100
+    // TODO: an empty cluster is actually invalid, FIXME: Keep a separate boolean vector to indicate invalid clusters when choosing top cluster
+    std::vector<std::vector<float>> avgExpressionForEachGeneForEachCluster;
+    kernels::groupMeans(clusterMoments, avgExpressionForEachGeneForEachCluster, -100.0f);
+    kernels::topGroupPerColumn(avgExpressionForEachGeneForEachCluster, _topClusterForEachGene);
+
+    updateTopCellForEachGeneDataset();
+}
+
+void DualViewPlugin::updateTopCellForEachGeneDataset()
+{
+    const auto& clusters = _metaDatasetB.get<Clusters>()->getClusters();
+
+    // only the first numGene columns are genes of the current gene embedding
+    const std::size_t numGene = std::min<std::size_t>(_embeddingDatasetA->getNumPoints(), _topClusterForEachGene.size());
+
+    if (numGene == 0 || clusters.empty())
+        return;
 
     // extract the colors and cluster names for each cell type
-    auto start3 = std::chrono::high_resolution_clock::now();
-    std::vector<Vector3f> cellTypeColors(_metaDatasetB.get<Clusters>()->getClusters().size());
-    std::vector<QString> cellTypeNames(_metaDatasetB.get<Clusters>()->getClusters().size());
+    std::vector<Vector3f> cellTypeColors(clusters.size());
+    std::vector<QString> cellTypeNames(clusters.size());
 
     int i = 0;
-    for (const auto& cluster : _metaDatasetB.get<Clusters>()->getClusters())
+    for (const auto& cluster : clusters)
     {
         cellTypeColors[i] = Vector3f(cluster.getColor().redF(), cluster.getColor().greenF(), cluster.getColor().blueF());
         cellTypeNames[i] = cluster.getName();
@@ -2088,8 +2561,12 @@ void DualViewPlugin::computeTopCellForEachGene()
     // assign the top cell for each gene to a cluster
     for (unsigned int i = 0; i < numGene; i++)
     {
-        const QString clusterName = cellTypeNames[topCellTypeForEachLocalGene[i]];
-        Vector3f clusterColor = cellTypeColors[topCellTypeForEachLocalGene[i]];
+        const int topCluster = _topClusterForEachGene[i];
+        if (topCluster < 0 || topCluster >= static_cast<int>(clusters.size()))
+            continue;
+
+        const QString clusterName = cellTypeNames[topCluster];
+        Vector3f clusterColor = cellTypeColors[topCluster];
         std::vector<unsigned int> indices = { i };
 
         Cluster cluster;
@@ -2101,14 +2578,14 @@ void DualViewPlugin::computeTopCellForEachGene()
     }
 
     events().notifyDatasetDataChanged(_topCellForEachGeneDataset);
-    // TEST 2: use the cell type with max avg expression for each gene - END 
-
-    qDebug() << "DualViewPlugin: computeTopCellForEachGene() done";
 
+    qDebug() << "DualViewPlugin: top cell for each gene updated";
 }
 
 void DualViewPlugin::getEnrichmentAnalysis()
 {
+    TRACE_SCOPE("DualViewPlugin::getEnrichmentAnalysis");
+
 
      //// output _simplifiedToIndexGeneMapping if not empty
      //if (!_simplifiedToIndexGeneMapping.empty()) {
@@ -2145,8 +2622,7 @@ void DualViewPlugin::getEnrichmentAnalysis()
     if (!_currentGeneSymbols.isEmpty())
     {
         qDebug() << "DualViewPlugin: getEnrichmentAnalysis()";
-        //_client->postGeneGprofiler(_currentGeneSymbols, _backgroundGeneNames, _currentEnrichmentSpecies, _currentSignificanceThresholdMethod);
-        _client->postGeneGprofiler(processedGeneSymbols, _backgroundGeneNames, _currentEnrichmentSpecies, _currentSignificanceThresholdMethod);
+        _client->postGeneEnrichment(processedGeneSymbols, _currentEnrichmentSpecies, _currentSignificanceThresholdMethod);
     }
     else
     {
@@ -2156,11 +2632,11 @@ void DualViewPlugin::getEnrichmentAnalysis()
 
 void DualViewPlugin::updateEnrichmentTable(const QVariantList& data)
 {
-    QString tableHtml = buildHtmlForEnrichmentResults(data);
+    TRACE_SCOPE("DualViewPlugin::updateEnrichmentTable");
 
     getSamplerAction().setSampleContext({
-        { "GeneInfo", _currentHtmlGeneInfo },
-        { "EnrichmentTable", tableHtml }
+        { "Selection", _selectionPayload },
+        { "Enrichment", buildEnrichmentPayload(data) }
         });
 
     qDebug() << "updateEnrichmentTable(): Table sent to Sample Scope.";
@@ -2168,24 +2644,37 @@ void DualViewPlugin::updateEnrichmentTable(const QVariantList& data)
 
 void DualViewPlugin::noDataEnrichmentTable()
 {
-    QString tableHtml = buildHtmlForEmpty();
-
     getSamplerAction().setSampleContext({
-        { "GeneInfo", _currentHtmlGeneInfo },
-        { "EnrichmentTable", tableHtml }
+        { "Selection", _selectionPayload },
+        { "Enrichment", buildEnrichmentPayload({}) }
         });
 }
 
+void DualViewPlugin::pushSampleScopeSection(const QString& section, const QVariantMap& payload)
+{
+    TRACE_SCOPE("DualViewPlugin::pushSampleScopeSection");
+
+    // only changed sections are sent to the page
+    if (_sampleScopeSections.contains(section) && _sampleScopeSections.value(section).toMap() == payload)
+        return;
+
+    _sampleScopeSections[section] = payload;
+
+    if (_sampleScopeReady)
+        emit _sampleScopeCommObject->qt_js_setSampleScopeSection(section, payload);
+}
+
 void DualViewPlugin::retrieveGOtermGenes(const QString& GOTermId)
 {
     qDebug() << "DualViewPlugin::retrieveGOtermGeneSet()" << GOTermId << "species" << _currentEnrichmentSpecies;
 
-    _client->postGOtermGprofiler(GOTermId, _currentEnrichmentSpecies);
-
+    _client->postGOtermGenes(GOTermId, _currentEnrichmentSpecies);
 }
 
 void DualViewPlugin::highlightGOTermGenesInEmbedding(const QStringList& geneSymbols)
 {
+    TRACE_SCOPE("DualViewPlugin::highlightGOTermGenesInEmbedding");
+
     qDebug() << "DualViewPlugin::highlightGOTermGenesInEmbedding()";
 
     QList<int> indices;
@@ -2305,6 +2794,29 @@ void DualViewPlugin::updateEnrichmentSignificanceThresholdMethod()
     getEnrichmentAnalysis();
 }
 
+void DualViewPlugin::updateEnrichmentProvider()
+{
+    auto& enrichmentSettingsAction = _settingsAction.getEnrichmentSettingsAction();
+
+    if (enrichmentSettingsAction.getProviderAction().getCurrentText() != "Local")
+    {
+        _client->setProvider(EnrichmentAnalysis::Provider::Gprofiler);
+        qDebug() << "Enrichment provider changed to: g:Profiler";
+        getEnrichmentAnalysis();
+        return;
+    }
+
+    const QString geneSetFilePath = enrichmentSettingsAction.getGeneSetFilePickerAction().getFilePath();
+    const QString ontologyFilePath = enrichmentSettingsAction.getOntologyFilePickerAction().getFilePath();
+
+    _client->setProvider(EnrichmentAnalysis::Provider::Local);
+    qDebug() << "Enrichment provider changed to: Local" << geneSetFilePath;
+
+    // changed files are loaded in the background, the enrichment is rerun once they are in place
+    if (!_client->loadLocalGeneSets(geneSetFilePath, ontologyFilePath))
+        getEnrichmentAnalysis();
+}
+
 
 // =============================================================================
 // Serialization
@@ -2316,6 +2828,10 @@ void DualViewPlugin::fromVariantMap(const QVariantMap& variantMap)
 
     ViewPlugin::fromVariantMap(variantMap);
 
+    // restored before the datasets, their changed handlers use the statistics
+    if (variantMap.contains("DerivedStatistics"))
+        _derivedStatistics.fromVariantMap(variantMap["DerivedStatistics"].toMap());
+
     qDebug() << "DualViewPlugin: fromVariantMap start";
 
     variantMapMustContain(variantMap, "SettingsAction");
@@ -2381,6 +2897,13 @@ void DualViewPlugin::fromVariantMap(const QVariantMap& variantMap)
 
     _loadingFromProject = false;
 
+    // the marker genes of the clusters are not stored in the project, they are ranked after loading (from the restored cluster summary)
+    if (_metaDatasetB.isValid())
+        markStale(TopCells);
+
+    // the products marked stale by the restored datasets and settings are computed once after loading
+    scheduleStaleProductsUpdate();
+
     getLearningCenterAction().getToolbarVisibleAction().setChecked(false);
     getLearningCenterAction().setAlignment(Qt::AlignmentFlag::AlignBottom | Qt::AlignmentFlag::AlignRight);
 }
@@ -2407,6 +2930,11 @@ QVariantMap DualViewPlugin::toVariantMap() const
         variantMap.insert("meanExpressionScalars", _meanExpressionScalars.getDatasetId());
     }
 
+    if (!_derivedStatistics.getSourceHash().isEmpty())
+    {
+        variantMap.insert("DerivedStatistics", _derivedStatistics.toVariantMap());
+    }
+
     // TODO: T. Kroes
     //insertIntoVariantMap(_embeddingWidgetA->getNavigationAction(), variantMap, "NavigationA");
 
@@ -21,6 +21,14 @@
 #include "Compute/EnrichmentAnalysis.h"
 #include "Compute/SampleScopeProcessor.h"
 #include "Compute/Computation.h"
+#include "Compute/DerivedStatistics.h"
+#include "Compute/DifferentialExpression.h"
+#include "Compute/ClusterColorCache.h"
+#include "Compute/OneDEmbeddingEngine.h"
+#include "Compute/LineLayoutEngine.h"
+#include "Compute/MarkerGeneEngine.h"
+#include "OneDEmbeddingPositions.h"
+#include "LandmarkMembership.h"
 
 /** All plugin related classes are in the ManiVault plugin namespace */
 using namespace mv::plugin;
@@ -68,10 +76,58 @@ public:
 
     void updateEnrichmentSignificanceThresholdMethod();
 
+    void updateEnrichmentProvider();
+
     void updateLog2FCThreshold();
 
+    // the test, the FDR threshold or the number of top genes of a selection in B changed
+    void updateDifferentialExpressionSettings();
+
+    // reorder the 1D embeddings to reduce line crossings, or restore their order, depending on the line settings
+    void updateMinimizeCrossings();
+
+    // show/hide the performance overlay in the three panels
+    void setPerformanceHudEnabled(bool enabled);
+
+    DerivedStatistics& getDerivedStatistics() { return _derivedStatistics; }
+
+    // cluster colors of embedding A or B, shared by the 2D and the 1D views of that embedding
+    ClusterColorCache& getClusterColorCache(bool isA) { return isA ? _clusterColorCacheA : _clusterColorCacheB; }
+
+
+protected:
+    // the stale products are computed when the view is shown
+    bool eventFilter(QObject* target, QEvent* event) override;
 
 private:
+    // derived products that are computed lazily: handlers mark them stale (with their dependents) and each stale
+    // product is computed once per event loop turn, after the project finished loading and only while the view is visible
+    enum DerivedProduct : std::uint32_t {
+        ColumnStatisticsB   = 1 << 0,   // per gene range and mean of the expression matrix of B
+        OneDPositionsA      = 1 << 1,   // 1D embedding positions of A
+        OneDPositionsB      = 1 << 2,   // 1D embedding positions of B
+        OneDColorsA         = 1 << 3,   // 1D embedding colors of A from the metadata
+        OneDColorsB         = 1 << 4,   // 1D embedding colors of B from the metadata
+        LineConnections     = 1 << 5,   // lines between the 1D embeddings
+        SizeA               = 1 << 6,   // point sizes of embedding A from the selection in B
+        SizeB               = 1 << 7,   // point sizes of embedding B from the selection in A
+        Highlights          = 1 << 8,   // highlighted lines and points of the latest selection
+        SampleScope         = 1 << 9,   // sample scope sections of the latest selection
+        LineLayout          = 1 << 10,  // crossing minimizing order of the 1D embeddings (optional)
+        TopCells            = 1 << 11,  // cluster summary and marker genes of the clusters of B, top cluster for each gene
+        ColorsA             = 1 << 12,  // 2D embedding colors of A from the metadata
+        ColorsB             = 1 << 13,  // 2D embedding colors of B from the metadata
+    };
+
+    // mark products and all products computed from them stale
+    void markStale(std::uint32_t products);
+
+    void scheduleStaleProductsUpdate();
+
+    void updateStaleProducts();
+
+    void updateColumnStatisticsB();
+
     QString getCurrentEmebeddingDataSetID(mv::Dataset<Points> dataset) const;
 
     void updateEmbeddingDataA();
@@ -94,12 +150,25 @@ private:
 
     // for embedding lines widget
 
-    void update1DEmbeddingPositions(bool isA); // bool isA: true for embedding A, false for embedding B
+    void update1DEmbeddingPositions(bool updateA, bool updateB); // recompute the 1D positions of A and/or B and share them with the lines widget
+
+    void updateEmbeddingColors(bool isA); // color the 2D embedding by its metadata
 
     void update1DEmbeddingColors(bool isA); // bool isA: true for embedding A, false for embedding B
 
     void updateLineConnections();
 
+    void updateLandmarkMembershipB(); // read the areas of influence of the landmarks if embedding B is an HSNE scale, marks the clusters and lines stale if they changed
+    void updateLandmarkLineConnections(); // lines of the landmarks of an HSNE scale, from their mean expression
+
+    void updateLineLayout(); // start reordering the 1D embeddings along the lines, if enabled
+
+    // replace the 1D positions by the reordered ones
+    void lineLayoutComputed(const std::vector<float>& sourceValues, const std::vector<float>& destinationValues, quint64 crossingsBefore, quint64 crossingsAfter);
+
+    // keep the ranked marker genes and the top cluster for each gene of the clusters of B, if they belong to the current clusters
+    void clusterMarkersComputed(const QByteArray& clustersKey, const kernels::GroupColumnMoments& clusterMoments, bool momentsComputed, const std::vector<std::vector<kernels::GeneStatistics>>& markers);
+
     void highlightSelectedLines(mv::Dataset<Points> dataset);
 
     
@@ -108,13 +177,35 @@ private:
 
     void sendDataToSampleScope();
 
+    // differential expression of the cells selected in B vs the other cells, see _selectionGeneStatistics
+    void computeSelectionDifferentialExpression();
+
+    // returns true if the rank index of expression matrix B is built, otherwise starts building it in the background, see geneRankIndexBuilt
+    bool requestGeneRankIndex();
+
+    // keep the rank index and test the current selection in B with it
+    void geneRankIndexBuilt(const QString& key, const std::shared_ptr<const kernels::GeneRankIndex>& index);
+
+    // significantly higher in the selection in B, with a fold change above the log2FC threshold
+    bool isEnrichedInSelection(const kernels::GeneStatistics& gene);
+
+    // start computing the cluster summary and the marker genes of the clusters of B, see clusterMarkersComputed
     void computeTopCellForEachGene();
 
+    // the clusters of the top cluster for each gene, with the names and colors of the clusters of B
+    void updateTopCellForEachGeneDataset();
+
+    // genes per selection (top genes setting), 0 for all genes
+    std::size_t getNumTopGenes();
+
     // experiment enrichment
     void updateEnrichmentTable(const QVariantList& data);
 
     void noDataEnrichmentTable();
 
+    // push a sample scope section to the page if its payload changed, an empty payload hides the section
+    void pushSampleScopeSection(const QString& section, const QVariantMap& payload);
+
    
 
     //void highlightGOTermGenesInEmbedding(const QVariantList& geneSymbols);
@@ -126,6 +217,9 @@ protected:
 
     void embeddingDatasetBChanged();
 
+    // publish a 1D embedding computed by the engine as child of embedding A or B
+    void oneDEmbeddingComputed(bool isA, const QString& datasetId, const std::vector<float>& coordinates);
+
 
 public: // Serialization
     /**
@@ -156,19 +250,27 @@ private:
     mv::Dataset<Points>        _embeddingSourceDatasetA;
     mv::Dataset<Points>        _embeddingSourceDatasetB;
 
+    LandmarkMembership         _landmarkMembershipB; // areas of influence of the landmarks if embedding B is an HSNE scale
+
     mv::Dataset<Points>        _oneDEmbeddingDatasetA; // 1D embedding
     mv::Dataset<Points>        _oneDEmbeddingDatasetB; // 2D embedding
 
+    OneDEmbeddingEngine        _oneDEmbeddingEngine; // computes the 1D embeddings of embeddings without one
+    LineLayoutEngine           _lineLayoutEngine; // reorders the 1D embeddings to reduce line crossings
+    MarkerGeneEngine           _markerGeneEngine; // ranks the marker genes of the clusters of B
+
     mv::Dataset<Clusters>       _metaDatasetA; // Dragged in to color embedding A
     mv::Dataset<Clusters>       _metaDatasetB; // Dragged in to color embedding B
+
+    ClusterColorCache           _clusterColorCacheA; // cluster labels and palette of embedding A
+    ClusterColorCache           _clusterColorCacheB; // cluster labels and palette of embedding B
     
     // 2D embedding positions
     std::vector<mv::Vector2f>  _embeddingPositionsA;
     std::vector<mv::Vector2f>  _embeddingPositionsB;
 
-    // 1D embedding positions
-    std::vector<mv::Vector2f>  _embedding_src;
-    std::vector<mv::Vector2f>  _embedding_dst;
+    // 1D embedding positions of A followed by B, shared with the lines widget
+    SharedOneDEmbeddingPositions _oneDEmbeddingPositions = std::make_shared<OneDEmbeddingPositions>();
 
     mv::Dataset<Points>        _meanExpressionScalars; 
     std::vector<float>         _selectedGeneMeanExpression; // TODO: remove dataset or vector, only keep one
@@ -189,10 +291,15 @@ private:
 
     bool                       _loadingFromProject = false;
 
+    std::uint32_t              _staleProducts = 0; // DerivedProduct flags that need to be computed
+    bool                       _staleProductsUpdateScheduled = false; // if updateStaleProducts() is queued
+
     bool                       _reversePointSizeB = false; // TODO: remove if not needed
 
-    // cached sample scope data, for later enrichment analysis
-    QString _currentHtmlGeneInfo; // cached gene info for sample scope
+    // cached sample scope sections (last payload sent to the page), for later enrichment analysis
+    QVariantMap                _sampleScopeSections;
+    QVariantMap                _selectionPayload; // selection section built by the latest sendDataToSampleScope, sent again with the enrichment results
+    bool                       _sampleScopeReady = false; // if the sample scope page is connected to the web channel
      
     
     // gene symbols, selected genes/ connected genes
@@ -211,7 +318,16 @@ private:
 
     // experiment about selection vs all compute
     std::vector<float>                 _meanExpressionForAllCells; // mean expression of all cells for each gene
-    std::vector<float>                 _diffSelectionvsAll; // difference between selection in B and all cells in B for each gene - FIXME: temperary for testing
+    DerivedStatistics                  _derivedStatistics; // statistics of expression matrix B (column stats, lines, cluster summaries), stored in the project
+    std::shared_ptr<const kernels::GeneRankIndex> _geneRankIndexB; // per gene cell order of expression matrix B, for the rank sums of every selection
+    QString                            _geneRankIndexKey; // dataset id and source hash of the matrix the rank index was built for
+    QString                            _geneRankIndexBuildKey; // dataset id and source hash of the matrix the rank index is being built for
+    std::vector<kernels::GeneStatistics> _selectionGeneStatistics; // differential expression of the selection in B vs the other cells, by descending score
+    QByteArray                         _clusterMarkersKey; // key of the cluster summary the marker genes are ranked from
+    std::size_t                        _clusterMarkersTopK = 0; // top genes setting the marker genes are ranked for
+    std::vector<std::vector<std::uint32_t>> _clusterMarkerCells; // sorted cells of every cluster of B, to recognize a selection of a whole cluster
+    std::vector<std::vector<kernels::GeneStatistics>> _clusterMarkers; // Welch test of every cluster of B vs the other cells, by descending score
+    std::vector<int>                   _topClusterForEachGene; // cluster of B with the highest mean of every gene
     float                              _log2FCThreshold = 2.0f; // log2FC threshold for lines
 
 protected:
@@ -235,6 +351,7 @@ public:
     /** Get smart pointer to points dataset for point position */
     mv::Dataset<Points>& getEmbeddingDatasetA() { return _embeddingDatasetA; }
     mv::Dataset<Points>& getEmbeddingDatasetB() { return _embeddingDatasetB; }
+    mv::Dataset<Points>& getEmbeddingDataset(bool isA) { return isA ? _embeddingDatasetA : _embeddingDatasetB; }
 
     mv::Dataset<Clusters>& getMetaDatasetA() { return _metaDatasetA; }
     mv::Dataset<Clusters>& getMetaDatasetB() { return _metaDatasetB; }
@@ -242,6 +359,7 @@ public:
 public:
     ScatterplotWidget& getEmbeddingWidgetB() { return *_embeddingWidgetB; }
     ScatterplotWidget& getEmbeddingWidgetA() { return *_embeddingWidgetA; }
+    ScatterplotWidget& getEmbeddingWidget(bool isA) { return isA ? *_embeddingWidgetA : *_embeddingWidgetB; }
 
     SettingsAction& getSettingsAction() { return _settingsAction; }
 };
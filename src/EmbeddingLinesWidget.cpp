@@ -1,4 +1,6 @@
 #include "EmbeddingLinesWidget.h"
+#include "Compute/PerformanceTrace.h"
+#include "Compute/Computation.h"
 
 #include <QSurfaceFormat>
 
@@ -7,7 +9,6 @@
 #include <unordered_set>
 
 #include <QDebug>
-#include <chrono>
 #include <graphics/Matrix3f.h>
 //#include <QOpenGLDebugLogger>
 
@@ -21,13 +22,17 @@ EmbeddingLinesWidget::EmbeddingLinesWidget() :
     _vboMode(0),
     _vboPositions(0),
     _lineConnections(0),
+    _highlightedLineCount(0),
     _highlightSource(true),
     _pointRenderer(this),
-    _colors(),
+    _labelsA(),
+    _labelsB(),
+    _paletteA(),
+    _paletteB(),
     _bounds(),
-    /*_embedding_src(nullptr),
-    _embedding_dst(nullptr),*/
-    _initialized(false)
+    _positions(std::make_shared<OneDEmbeddingPositions>()),
+    _initialized(false),
+    _performanceHud()
 {
 
     //Configure pixel selection tool
@@ -49,26 +54,22 @@ EmbeddingLinesWidget::EmbeddingLinesWidget() :
     _pointRenderer.getNavigator().setZoomMarginScreen(25.f);
 }
 
-void EmbeddingLinesWidget::setData(const std::vector<mv::Vector2f>& embedding_src, const std::vector<mv::Vector2f>& embedding_dst) 
+void EmbeddingLinesWidget::setData(SharedOneDEmbeddingPositions positions) 
 {
-    _embedding_src = embedding_src;
-    _embedding_dst = embedding_dst;
+    TRACE_SCOPE("EmbeddingLinesWidget::setData");
 
-    //qDebug() << "EmbeddingLinesWidget::setData - embedding_src size:" << _embedding_src.size() << "embedding_dst size:" << _embedding_dst.size();
+    _positions = positions ? std::move(positions) : std::make_shared<OneDEmbeddingPositions>();
 
-    // Set the data for the point renderer - src first , then dst
-    std::vector<mv::Vector2f> points;
-    points.reserve(_embedding_src.size() + _embedding_dst.size());
-    points.insert(points.end(), _embedding_src.begin(), _embedding_src.end());
-    points.insert(points.end(), _embedding_dst.begin(), _embedding_dst.end());
+    // the shared buffer already has the layout of the point renderer - src first , then dst
+    const std::vector<mv::Vector2f>& points = _positions->points;
 
     const auto numPoints = points.size();
 
-    mv::Vector3f pointColor = { _color.redF(), _color.greenF(), _color.blueF() };
-    _colors.clear();
-    _colors.reserve(numPoints);
-    for (unsigned long i = 0; i < numPoints; i++)
-        _colors.emplace_back(pointColor);
+    // labels of the previous points are never reused for the new ones
+    _labelsA.clear();
+    _labelsB.clear();
+    _paletteA.clear();
+    _paletteB.clear();
 
     //qDebug() << "EmbeddingLinesWidget::setData - points size:" << points.size();
 
@@ -92,7 +93,7 @@ void EmbeddingLinesWidget::setData(const std::vector<mv::Vector2f>& embedding_sr
 
 	_pointRenderer.getNavigator().resetView(true);
     _pointRenderer.setData(points);
-    _pointRenderer.setColors(_colors);
+    updatePointScalars();
 
     // line positions
     glBindBuffer(GL_ARRAY_BUFFER, _vboPositions);
@@ -100,55 +101,121 @@ void EmbeddingLinesWidget::setData(const std::vector<mv::Vector2f>& embedding_sr
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+    // the point renderer holds its own copy of the positions and the colors
+    _performanceHud.setBufferSize("line positions", points.size() * sizeof(mv::Vector2f));
+    _performanceHud.setBufferSize("points", points.size() * (sizeof(mv::Vector2f) + sizeof(Vector3f)));
+
 
     update();
 }
 
-void EmbeddingLinesWidget::setPointColorA(const std::vector<Vector3f>& pointColors)
+void EmbeddingLinesWidget::setPointLabels(bool isA, const std::vector<std::uint32_t>& labels, const std::vector<Vector3f>& palette)
 {
-    // pointColors only for A, so only need to set colors for src points
-    //qDebug() << "EmbeddingLinesWidget::setPointColorA - pointColors size:" << pointColors.size() << "embedding_dst size:" << _embedding_dst.size();
-    //qDebug() << "EmbeddingLinesWidget::setPointColorA - embedding_src size:" << _embedding_src.size() << "embedding_dst size:" << _embedding_dst.size();
-    int j = 0;
-    for (int i = 0; i < _embedding_src.size(); i++)
+    TRACE_SCOPE("EmbeddingLinesWidget::setPointLabels");
+
+    auto& sideLabels = isA ? _labelsA : _labelsB;
+    auto& sidePalette = isA ? _paletteA : _paletteB;
+
+    const std::size_t numSidePoints = isA ? _positions->numSrc : _positions->numDst();
+
+    if (labels.size() != numSidePoints)
     {
-        _colors[i] = pointColors[j];
-        j++;
+        qDebug() << "EmbeddingLinesWidget::setPointLabels - number of labels" << labels.size() << "does not match number of points" << numSidePoints;
+        return;
     }
 
-    _pointRenderer.setColors(_colors);
-    update();
+    // only the cluster colors changed
+    if (labels == sideLabels && palette.size() == sidePalette.size())
+    {
+        sidePalette = palette;
+        updatePointPalette();
+        return;
+    }
 
+    sideLabels = labels;
+    sidePalette = palette;
+
+    updatePointScalars();
 }
 
-void EmbeddingLinesWidget::setPointColorB(const std::vector<Vector3f>& pointColors)
+void EmbeddingLinesWidget::updatePointScalars()
 {
-    // pointColors only for B, so only need to set colors for dst points
-    //qDebug() << "EmbeddingLinesWidget::setPointColorB - pointColors size:" << pointColors.size() << "embedding_dst size:" << _embedding_dst.size();
-    //qDebug() << "EmbeddingLinesWidget::setPointColorB - embedding_src size:" << _embedding_src.size() << "embedding_dst size:" << _embedding_dst.size();
-    int j = 0;
-    for (int i = _embedding_src.size(); i < _embedding_dst.size()+ _embedding_src.size(); i++)
+    const std::size_t numSrc = _positions->numSrc;
+    const std::size_t numPoints = _positions->points.size();
+
+    const mv::Vector3f pointColor = { _color.redF(), _color.greenF(), _color.blueF() };
+
+    // too many clusters for a color map texture, the points are colored directly
+    if (1 + _paletteA.size() + _paletteB.size() > maxPaletteSize)
     {
-        _colors[i] = pointColors[j];
-        j++;
+        std::vector<Vector3f> colors(numPoints, pointColor);
+
+        for (std::size_t i = 0; i < _labelsA.size(); i++)
+            colors[i] = _paletteA[_labelsA[i]];
+
+        for (std::size_t i = 0; i < _labelsB.size(); i++)
+            colors[numSrc + i] = _paletteB[_labelsB[i]];
+
+        _pointRenderer.setColors(colors);
+        _pointRenderer.setScalarEffect(PointEffect::None);
+        _performanceHud.setBufferSize("colors", colors.size() * sizeof(Vector3f));
+
+        update();
+        return;
     }
-        
-    _pointRenderer.setColors(_colors);
-	update();
 
+    // label 0 is the constant point color, the labels of A and B follow
+    std::vector<float> scalars(numPoints, 0.0f);
+    const std::span<float> scalarsA = std::span<float>(scalars).first(numSrc);
+    const std::span<float> scalarsB = std::span<float>(scalars).subspan(numSrc);
+
+    labelsToScalars(_labelsA, 1.0f, scalarsA);
+    labelsToScalars(_labelsB, 1.0f + static_cast<float>(_paletteA.size()), scalarsB);
+
+    _pointRenderer.setColorChannelScalars(scalars);
+    _pointRenderer.setScalarEffect(PointEffect::Color);
+    _performanceHud.setBufferSize("scalars", scalars.size() * sizeof(float));
+
+    updatePointPalette();
+}
+
+void EmbeddingLinesWidget::updatePointPalette()
+{
+    // a palette entry for the constant point color, followed by the palettes of A and B
+    std::vector<Vector3f> palette;
+    palette.reserve(1 + _paletteA.size() + _paletteB.size());
+    palette.emplace_back(_color.redF(), _color.greenF(), _color.blueF());
+    palette.insert(palette.end(), _paletteA.begin(), _paletteA.end());
+    palette.insert(palette.end(), _paletteB.begin(), _paletteB.end());
+
+    if (palette.size() > maxPaletteSize)
+    {
+        updatePointScalars();
+        return;
+    }
+
+    // every label maps to the center of its palette texel, so filtering never blends neighbouring colors
+    _pointRenderer.setColorMapRange(-0.5f, static_cast<float>(palette.size()) - 0.5f);
+
+    if (isInitialized())
+        _pointRenderer.setColormap(createPaletteImage(palette));
+
+    update();
 }
 
 void EmbeddingLinesWidget::setLines(const std::vector<std::pair<uint32_t, uint32_t>>& lines) {
+    TRACE_SCOPE("EmbeddingLinesWidget::setLines");
+
     _lines = lines;
     _alpha_per_line.clear();
 
     // Build index buffer
     // For a line (i, j), i is in src array, j is in dst array
-    // The total unique points is _embedding_src.size() + _embedding_dst.size()
+    // The total unique points is the size of the shared positions buffer
     // So the index for a src point is i
-    // The index for a dst point is offset by _embedding_src.size()
+    // The index for a dst point is offset by the number of src points
 
-    const uint32_t srcCount = static_cast<uint32_t>(_embedding_src.size());
+    const uint32_t srcCount = static_cast<uint32_t>(_positions->numSrc);
     std::vector<GLuint> indices;
     indices.resize(_lines.size() * 2);
 
@@ -169,7 +236,7 @@ void EmbeddingLinesWidget::setLines(const std::vector<std::pair<uint32_t, uint32
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
 
     // Method 1: clear highlight data - using the 1 byte per vertex to store the highlight data in the mode buffer
-    size_t totalVertices = _embedding_src.size() + _embedding_dst.size();
+    size_t totalVertices = _positions->points.size();
     std::vector<GLubyte> highlightData(totalVertices, 0);
     glBindVertexArray(_vao);
     glBindBuffer(GL_ARRAY_BUFFER, _vboMode);
@@ -182,21 +249,24 @@ void EmbeddingLinesWidget::setLines(const std::vector<std::pair<uint32_t, uint32
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+    _performanceHud.setBufferSize("lines", indices.size() * sizeof(GLuint));
+    _performanceHud.setBufferSize("modes", highlightData.size() * sizeof(GLubyte));
+    _performanceHud.setBufferSize("highlighted lines", 0);
+
     update();
 }
 
 void EmbeddingLinesWidget::setColor(const QColor& color) {
     _color = color;
 
-    // TODO: set the color for the point renderer
-
-    update();
+    // unlabeled points share the first palette entry with the lines
+    updatePointPalette();
 }
 
 void EmbeddingLinesWidget::setColor(int r, int g, int b) 
 {
     _color = QColor(r, g, b);
-    update();
+    updatePointPalette();
 }
 
 void EmbeddingLinesWidget::setAlpha(float alpha) {
@@ -207,6 +277,8 @@ void EmbeddingLinesWidget::setAlpha(float alpha) {
 
 void EmbeddingLinesWidget::setHighlights(const std::vector<int>& indices, bool highlightSource)
 {
+    TRACE_SCOPE("EmbeddingLinesWidget::setHighlights");
+
     // set highlights by one side (embedding_src or embedding_dst)
     _highlightIndices = indices;
     _highlightSource = highlightSource;
@@ -242,9 +314,7 @@ void EmbeddingLinesWidget::setHighlights(const std::vector<int>& indices, bool h
     // Method 2: highlight per line using the highlighted ebo
     std::unordered_set<int> highlightIndicesSet(_highlightIndices.begin(), _highlightIndices.end());
 
-    size_t srcCount = _embedding_src.size();
-    size_t dstCount = _embedding_dst.size();
-    size_t totalVertices = srcCount + dstCount;
+    size_t srcCount = _positions->numSrc;
 
     std::vector<GLuint> highlightedIndices;
     highlightedIndices.reserve(_lines.size() * 2); // worst case: all lines
@@ -266,6 +336,7 @@ void EmbeddingLinesWidget::setHighlights(const std::vector<int>& indices, bool h
     // upload the highlight subset EBO
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _highlightedLineConnections);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, highlightedIndices.size() * sizeof(GLuint), highlightedIndices.data(), GL_STATIC_DRAW);
+    _performanceHud.setBufferSize("highlighted lines", highlightedIndices.size() * sizeof(GLuint));
 
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -275,11 +346,13 @@ void EmbeddingLinesWidget::setHighlights(const std::vector<int>& indices, bool h
 
 void EmbeddingLinesWidget::setHighlightsByPair(const std::vector<std::pair<int, int>>& highlightedLines, const std::vector<int>& indices, bool highlightSource)
 {
+    TRACE_SCOPE("EmbeddingLinesWidget::setHighlightsByPair");
+
     // set highlights by pairs of indices
     _highlightIndices = indices;
     _highlightSource = highlightSource;
 
-    size_t srcCount = _embedding_src.size();
+    size_t srcCount = _positions->numSrc;
 
     std::vector<GLuint> highlightedIndices;
     highlightedIndices.reserve(highlightedLines.size() * 2);
@@ -295,6 +368,7 @@ void EmbeddingLinesWidget::setHighlightsByPair(const std::vector<std::pair<int,
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _highlightedLineConnections);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, highlightedIndices.size() * sizeof(GLuint), highlightedIndices.data(), GL_STATIC_DRAW);
+    _performanceHud.setBufferSize("highlighted lines", highlightedIndices.size() * sizeof(GLuint));
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     update();
@@ -305,8 +379,6 @@ void EmbeddingLinesWidget::onWidgetInitialized()
     // Initialize renderers
     _pointRenderer.init();
 
-    // Set a default color map for both renderers
-    _pointRenderer.setScalarEffect(PointEffect::None);
     _pointRenderer.setPointSize(5); // TODO: automatically set a proper point size
     _pointRenderer.setSelectionOutlineColor(Vector3f(1, 0, 0));
 
@@ -314,6 +386,9 @@ void EmbeddingLinesWidget::onWidgetInitialized()
 
     _initialized = true;
 
+    // the palette color map can only be uploaded once the renderer is initialized
+    updatePointScalars();
+
     emit initialized();
 
     qDebug() << "GL initialized";
@@ -404,10 +479,14 @@ void EmbeddingLinesWidget::onWidgetInitialized()
 
 void EmbeddingLinesWidget::onWidgetRendered()
 {
+    TRACE_SCOPE("EmbeddingLinesWidget::onWidgetRendered");
+
     if (!_initialized) {
         throw std::logic_error("OpenGL context must be initialized");
     }
 
+    _performanceHud.beginFrame();
+
     //qDebug() << "EmbeddingLinesWidget::onWidgetRendered";
 
     try
@@ -496,7 +575,14 @@ void EmbeddingLinesWidget::onWidgetRendered()
 
         painter.drawImage(0, 0, pixelSelectionToolsImage);*/
 
+        _performanceHud.paint(painter, rect(), {
+            QString("Lines: %1 (highlighted %2)").arg(_lines.size()).arg(_highlightedLineCount / 2),
+            QString("Points: %1 + %2").arg(_positions->numSrc).arg(_positions->numDst())
+        });
+
         painter.end();
+
+        _performanceHud.endFrame();
     }
 
     catch (std::exception& e)
@@ -545,6 +631,14 @@ void EmbeddingLinesWidget::onWidgetCleanup()
     _pointRenderer.destroy();
 }
 
+void EmbeddingLinesWidget::setShowPerformanceHud(bool show)
+{
+    _performanceHud.setEnabled(show);
+
+    if (isInitialized())
+        update();
+}
+
 PixelSelectionTool& EmbeddingLinesWidget::getPixelSelectionTool()
 {
     return _pixelSelectionTool;
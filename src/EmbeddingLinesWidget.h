@@ -22,6 +22,9 @@
 
 #include <util/PixelSelectionTool.h>
 
+#include "src/PerformanceHud.h"
+#include "src/OneDEmbeddingPositions.h"
+
 using namespace mv;
 using namespace mv::util;
 using namespace mv::gui;
@@ -33,7 +36,7 @@ class EmbeddingLinesWidget : public OpenGLWidget
 public:
     EmbeddingLinesWidget();
 
-    void setData(const std::vector<mv::Vector2f>& embedding_src, const std::vector<mv::Vector2f>& embedding_dst);
+    void setData(SharedOneDEmbeddingPositions positions); // positions of A followed by B, shared with the caller
     void setLines(const std::vector<std::pair<uint32_t, uint32_t>>& lines);
     void setColor(const QColor& color);
     void setColor(int r, int g, int b);
@@ -42,8 +45,10 @@ public:
 
     void setHighlightsByPair(const std::vector<std::pair<int, int>>& highlightedLines, const std::vector<int>& indices, bool highlightSource); // highlight by pair of indices
 
-    void setPointColorA(const std::vector<Vector3f>& pointColors);
-    void setPointColorB(const std::vector<Vector3f>& pointColors);   
+    // color the points of A or B by a label per point and a palette, only the palette is uploaded if the labels did not change
+    void setPointLabels(bool isA, const std::vector<std::uint32_t>& labels, const std::vector<Vector3f>& palette);
+
+    void setShowPerformanceHud(bool show); // show/hide the performance overlay
 
     /** Get reference to the pixel selection tool */
     PixelSelectionTool& getPixelSelectionTool();
@@ -69,13 +74,12 @@ protected:
 
     void paintPixelSelectionToolNative(PixelSelectionTool& pixelSelectionTool, QImage& image, QPainter& painter) const;
 
+    void updatePointScalars(); // upload the labels of both sides as color scalars
+    void updatePointPalette(); // upload the palettes of both sides as color map
 
-private:
-    /*const scalar_type* _embedding_src; 
-    const scalar_type* _embedding_dst;*/
 
-    std::vector<mv::Vector2f> _embedding_src; //TODO: change to pointer
-    std::vector<mv::Vector2f> _embedding_dst;
+private:
+    SharedOneDEmbeddingPositions _positions; // positions of both 1D embeddings, shared with the plugin
     std::vector<std::pair<uint32_t, uint32_t>> _lines;
     std::vector<float> _alpha_per_line;
 
@@ -111,5 +115,10 @@ private:
     // Point rendering
     PointRenderer           _pointRenderer;     /* ManiVault OpenGL point renderer implementation */
     Bounds                  _bounds;            /* Min and max point coordinates for camera placement */
-    std::vector<Vector3f>   _colors;            /* Color of points - here we use a constant color for simplicity */
+    std::vector<std::uint32_t> _labelsA;        /* Palette index per point of A, empty if A is not labeled */
+    std::vector<std::uint32_t> _labelsB;        /* Palette index per point of B, empty if B is not labeled */
+    std::vector<Vector3f>   _paletteA;          /* Colors of the labels of A */
+    std::vector<Vector3f>   _paletteB;          /* Colors of the labels of B */
+
+    PerformanceHud          _performanceHud;    /* Optional performance overlay */
 };
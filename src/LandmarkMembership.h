@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Area of influence of every landmark of an HSNE scale: the data points each landmark represents, as global indices of the
+// expression matrix. Read from the linked data the HSNE analysis adds to a scale embedding, empty if the embedding is no HSNE scale
+struct LandmarkMembership
+{
+    std::vector<std::uint32_t>  offsets;        // start of the points of every landmark, numLandmarks + 1 entries
+    std::vector<std::uint32_t>  points;         // global data point indices, grouped by landmark
+
+    bool empty() const { return points.empty(); }
+    std::size_t numLandmarks() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    std::span<const std::uint32_t> members(std::size_t landmark) const { return std::span<const std::uint32_t>(points).subspan(offsets[landmark], offsets[landmark + 1] - offsets[landmark]); }
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "graphics/Vector2f.h"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Positions of both 1D embeddings in a single buffer: those of A (source) followed by those of B (destination)
+// This is the layout the lines widget draws and selects in, so the buffer is shared between the plugin and the
+// widget without copies. A buffer is never modified once shared, an update creates a new one
+struct OneDEmbeddingPositions
+{
+    std::vector<mv::Vector2f>   points;         // positions of A followed by the positions of B
+    std::size_t                 numSrc = 0;     // number of positions of A
+
+    std::size_t numDst() const { return points.size() - numSrc; }
+
+    std::span<const mv::Vector2f> src() const { return std::span<const mv::Vector2f>(points).first(numSrc); }
+    std::span<const mv::Vector2f> dst() const { return std::span<const mv::Vector2f>(points).subspan(numSrc); }
+};
+
+using SharedOneDEmbeddingPositions = std::shared_ptr<const OneDEmbeddingPositions>;
@@ -0,0 +1,131 @@
+#include "PerformanceHud.h"
+
+#include "Compute/PerformanceTrace.h"
+
+#include <QFontDatabase>
+#include <QFontMetrics>
+
+#include <algorithm>
+
+namespace
+{
+    QString formatBytes(std::size_t numBytes)
+    {
+        if (numBytes >= 1024 * 1024)
+            return QString("%1 MB").arg(static_cast<double>(numBytes) / (1024.0 * 1024.0), 0, 'f', 1);
+
+        return QString("%1 KB").arg(static_cast<double>(numBytes) / 1024.0, 0, 'f', 1);
+    }
+}
+
+PerformanceHud::PerformanceHud() :
+    _enabled(false),
+    _frameTimer(),
+    _frameIntervalTimer(),
+    _paintTime(0.0),
+    _frameInterval(0.0),
+    _handledSelectionTimestamp(-1),
+    _selectionLatency(-1.0),
+    _bufferSizes()
+{
+}
+
+void PerformanceHud::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+
+    // the latency of a selection made while the HUD was hidden is meaningless
+    _handledSelectionTimestamp = trace::Tracer::instance().getSelectionTimestamp();
+}
+
+void PerformanceHud::beginFrame()
+{
+    if (!_enabled)
+        return;
+
+    if (_frameIntervalTimer.isValid())
+        _frameInterval = _frameIntervalTimer.nsecsElapsed() / 1e6;
+
+    _frameIntervalTimer.start();
+    _frameTimer.start();
+}
+
+void PerformanceHud::endFrame()
+{
+    if (!_enabled || !_frameTimer.isValid())
+        return;
+
+    _paintTime = _frameTimer.nsecsElapsed() / 1e6;
+
+    // the first frame after a selection change closes the selection-to-update latency
+    auto& tracer = trace::Tracer::instance();
+    const std::int64_t selectionTimestamp = tracer.getSelectionTimestamp();
+
+    if (selectionTimestamp > _handledSelectionTimestamp)
+    {
+        _selectionLatency = (tracer.now() - selectionTimestamp) / 1000.0;
+        _handledSelectionTimestamp = selectionTimestamp;
+    }
+}
+
+void PerformanceHud::setBufferSize(const QString& name, std::size_t numBytes)
+{
+    _bufferSizes[name] = numBytes;
+}
+
+void PerformanceHud::paint(QPainter& painter, const QRect& rect, const QStringList& panelLines) const
+{
+    if (!_enabled)
+        return;
+
+    QStringList lines;
+
+    // views repaint on demand, so the interval is the time since the previous repaint rather than a frame rate
+    lines << QString("Frame: paint %1 ms, %2 ms since previous").arg(_paintTime, 0, 'f', 1).arg(_frameInterval, 0, 'f', 1);
+    lines << panelLines;
+
+    std::size_t totalBufferSize = 0;
+    QStringList bufferSizes;
+    for (const auto& [name, numBytes] : _bufferSizes)
+    {
+        totalBufferSize += numBytes;
+        bufferSizes << QString("%1 %2").arg(name, formatBytes(numBytes));
+    }
+
+    lines << QString("GPU buffers: %1").arg(formatBytes(totalBufferSize));
+    if (!bufferSizes.isEmpty())
+        lines << QString("  %1").arg(bufferSizes.join(", "));
+
+    lines << (_selectionLatency < 0.0 ? QString("Selection to update: -") : QString("Selection to update: %1 ms").arg(_selectionLatency, 0, 'f', 1));
+
+    const auto lastJob = trace::Tracer::instance().getLastJob();
+    lines << (lastJob.name == nullptr ? QString("Last job: -") : QString("Last job: %1 %2 ms").arg(lastJob.name).arg(lastJob.milliseconds, 0, 'f', 1));
+
+    painter.save();
+
+    painter.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    const QFontMetrics fontMetrics = painter.fontMetrics();
+    const int margin = 6;
+
+    int textWidth = 0;
+    for (const QString& line : lines)
+        textWidth = std::max(textWidth, fontMetrics.horizontalAdvance(line));
+
+    const QRect backgroundRect(rect.topLeft() + QPoint(margin, margin), QSize(textWidth + 2 * margin, lines.size() * fontMetrics.height() + 2 * margin));
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 160));
+    painter.drawRoundedRect(backgroundRect, 4, 4);
+
+    painter.setPen(Qt::white);
+
+    int y = backgroundRect.top() + margin + fontMetrics.ascent();
+    for (const QString& line : lines)
+    {
+        painter.drawText(backgroundRect.left() + margin, y, line);
+        y += fontMetrics.height();
+    }
+
+    painter.restore();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QRect>
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+#include <map>
+
+// On-screen performance overlay of a view
+// The view reports its frames and GPU buffer sizes, the HUD adds the latency since the last selection change
+// and the last analytics job from the tracer counters, and draws everything in the QPainter pass of the view
+class PerformanceHud
+{
+public:
+    PerformanceHud();
+
+    bool isEnabled() const { return _enabled; }
+    void setEnabled(bool enabled);
+
+    // call at the start and end of the paint function of the view
+    void beginFrame();
+    void endFrame();
+
+    // size of a GPU buffer of the view, in bytes
+    void setBufferSize(const QString& name, std::size_t numBytes);
+
+    // draw the overlay in the top left corner of rect, panelLines are view specific (e.g. the number of points drawn)
+    void paint(QPainter& painter, const QRect& rect, const QStringList& panelLines) const;
+
+private:
+    bool                            _enabled;                   // whether the overlay is drawn
+    QElapsedTimer                   _frameTimer;                // measures the paint time of the current frame
+    QElapsedTimer                   _frameIntervalTimer;        // measures the time between two frames
+    double                          _paintTime;                 // paint time of the last frame in ms
+    double                          _frameInterval;             // time between the last two frames in ms
+    std::int64_t                    _handledSelectionTimestamp; // tracer selection timestamp that the last latency was measured for
+    double                          _selectionLatency;          // ms from the last selection change to the end of the first frame after it, -1 if none yet
+    std::map<QString, std::size_t>  _bufferSizes;               // GPU buffer sizes in bytes
+};
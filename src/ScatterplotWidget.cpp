@@ -1,4 +1,6 @@
 #include "ScatterplotWidget.h"
+#include "Compute/PerformanceTrace.h"
+#include "Compute/Computation.h"
 
 #include <CoreInterface.h>
 
@@ -63,6 +65,10 @@ ScatterplotWidget::ScatterplotWidget(mv::plugin::ViewPlugin* parentPlugin) :
     _pixelRatio(1.0),
     _isNavigating(false),
     _weightDensity(false),
+    _densityStale(true),
+    _densityUpdateTimer(),
+    _numPoints(0),
+    _performanceHud(),
     _parentPlugin(parentPlugin)
 {
     setContextMenuPolicy(Qt::CustomContextMenu);
@@ -147,6 +153,15 @@ ScatterplotWidget::ScatterplotWidget(mv::plugin::ViewPlugin* parentPlugin) :
 
     getPointRendererNavigator().setEnabled(true);
     _densityRenderer.setCustomNavigator(&getPointRendererNavigator());
+
+    // while the weights change continuously (e.g. brushing genes) the density is recomputed at most once per interval
+    _densityUpdateTimer.setSingleShot(true);
+    _densityUpdateTimer.setInterval(densityUpdateInterval);
+
+    connect(&_densityUpdateTimer, &QTimer::timeout, this, [this]() -> void {
+        if (_densityStale && _renderMode != SCATTERPLOT)
+            computeDensity();
+    });
 }
 
 bool ScatterplotWidget::event(QEvent* event)
@@ -223,12 +238,11 @@ void ScatterplotWidget::setRenderMode(const RenderMode& renderMode)
         case ScatterplotWidget::SCATTERPLOT:
             break;
         
+        // density and landscape share the density, it is only recomputed if its inputs changed
         case ScatterplotWidget::DENSITY:
-            computeDensity();
-            break;
-
         case ScatterplotWidget::LANDSCAPE:
-            computeDensity();
+            if (_densityStale)
+                computeDensity();
             break;
 
         default:
@@ -265,8 +279,13 @@ PixelSelectionTool& ScatterplotWidget::getSamplerPixelSelectionTool()
 
 void ScatterplotWidget::computeDensity()
 {
+    TRACE_SCOPE("ScatterplotWidget::computeDensity");
+
     emit densityComputationStarted();
 
+    _densityUpdateTimer.stop();
+    _densityStale = false;
+
     _densityRenderer.computeDensity();
 
     emit densityComputationEnded();
@@ -274,22 +293,45 @@ void ScatterplotWidget::computeDensity()
     update();
 }
 
+void ScatterplotWidget::markDensityStale()
+{
+    _densityStale = true;
+
+    // in scatterplot mode the density is computed when switching to density or landscape mode
+    if (_renderMode == SCATTERPLOT || _densityUpdateTimer.isActive())
+        return;
+
+    _densityUpdateTimer.start();
+}
+
 // Positions need to be passed as a pointer as we need to store them locally in order
 // to be able to find the subset of data that's part of a selection. If passed
 // by reference then we can upload the data to the GPU, but not store it in the widget.
 void ScatterplotWidget::setData(const std::vector<Vector2f>* points)
 {
+    TRACE_SCOPE("ScatterplotWidget::setData");
+
     auto dataBounds = getDataBounds(*points);
 
     const auto dataBoundsRect = QRectF(QPointF(dataBounds.getLeft(), dataBounds.getBottom()), QSizeF(dataBounds.getWidth(), dataBounds.getHeight()));
 
     _pointRenderer.setDataBounds(dataBoundsRect);
+    _densityRenderer.setDataBounds(dataBoundsRect);
 
     _dataRectangleAction.setBounds(dataBounds);
 
     _pointRenderer.getNavigator().resetView(true);
 
 	_pointRenderer.setData(*points);
+    _densityRenderer.setData(points);
+
+    // labels of the previous points are never reused for the new ones
+    _labels.clear();
+
+    _numPoints = points->size();
+    _performanceHud.setBufferSize("positions", points->size() * sizeof(Vector2f));
+
+    markDensityStale();
 
     switch (_renderMode)
     {
@@ -317,40 +359,120 @@ void ScatterplotWidget::setBackgroundColor(QColor color)
 
 void ScatterplotWidget::setHighlights(const std::vector<char>& highlights, const std::int32_t& numSelectedPoints)
 {
+    TRACE_SCOPE("ScatterplotWidget::setHighlights");
+
     _pointRenderer.setHighlights(highlights, numSelectedPoints);
+    _performanceHud.setBufferSize("highlights", highlights.size() * sizeof(char));
 
     update();
 }
 
 void ScatterplotWidget::setScalars(const std::vector<float>& scalars)
 {
+    TRACE_SCOPE("ScatterplotWidget::setScalars");
+
     _pointRenderer.setColorChannelScalars(scalars);
+    _performanceHud.setBufferSize("scalars", scalars.size() * sizeof(float));
     
     update();
 }
 
 void ScatterplotWidget::setColors(const std::vector<Vector3f>& colors)
 {
+    TRACE_SCOPE("ScatterplotWidget::setColors");
+
     _pointRenderer.setColors(colors);
     _pointRenderer.setScalarEffect(None);
+    _performanceHud.setBufferSize("colors", colors.size() * sizeof(Vector3f));
+
+    // the point renderer colors by the colors again, so it gets the regular color map back
+    if (_coloringMode == ColoringMode::Categorical && _isInitialized)
+        _pointRenderer.setColormap(_colorMapImage);
+
+    _labels.clear();
+    _palette.clear();
+
+    setColoringMode(ColoringMode::Data);
+
+    update();
+}
+
+void ScatterplotWidget::setLabels(const std::vector<std::uint32_t>& labels, const std::vector<Vector3f>& palette)
+{
+    TRACE_SCOPE("ScatterplotWidget::setLabels");
+
+    // only the cluster colors changed
+    if (_coloringMode == ColoringMode::Categorical && labels == _labels && palette.size() == _palette.size())
+    {
+        _palette = palette;
+        updatePaletteColorMap();
+        return;
+    }
+
+    // a palette that does not fit a color map texture is applied as colors
+    if (palette.empty() || palette.size() > maxPaletteSize)
+    {
+        std::vector<Vector3f> colors(labels.size());
+
+#pragma omp parallel for
+        for (std::int64_t i = 0; i < static_cast<std::int64_t>(labels.size()); i++)
+            colors[i] = labels[i] < palette.size() ? palette[labels[i]] : Vector3f(0.0f, 0.0f, 0.0f);
+
+        setColors(colors);
+        return;
+    }
+
+    // a float label per point instead of three float color channels
+    std::vector<float> scalars(labels.size());
+    labelsToScalars(labels, 0.0f, scalars);
+
+    _pointRenderer.setColorChannelScalars(scalars);
+    _pointRenderer.setScalarEffect(PointEffect::Color);
+    _performanceHud.setBufferSize("scalars", scalars.size() * sizeof(float));
+    _performanceHud.setBufferSize("colors", 0);
+
+    _labels = labels;
+    _palette = palette;
+
+    setColoringMode(ColoringMode::Categorical);
+    updatePaletteColorMap();
+}
+
+void ScatterplotWidget::updatePaletteColorMap()
+{
+    // every label maps to the center of its palette texel, so filtering never blends neighbouring colors
+    _pointRenderer.setColorMapRange(-0.5f, static_cast<float>(_palette.size()) - 0.5f);
+
+    if (_isInitialized)
+        _pointRenderer.setColormap(createPaletteImage(_palette));
 
     update();
 }
 
 void ScatterplotWidget::setPointSizeScalars(const std::vector<float>& pointSizeScalars)
 {
+    TRACE_SCOPE("ScatterplotWidget::setPointSizeScalars");
+
     if (pointSizeScalars.empty())
         return;
 
     _pointRenderer.setSizeChannelScalars(pointSizeScalars);
+    _performanceHud.setBufferSize("sizes", pointSizeScalars.size() * sizeof(float));
     _pointRenderer.setPointSize(*std::max_element(pointSizeScalars.begin(), pointSizeScalars.end()));
 
+    // the size scalars are the density weights, an unweighted density does not depend on them
+    if (_weightDensity)
+        markDensityStale();
+
     update();
 }
 
 void ScatterplotWidget::setPointOpacityScalars(const std::vector<float>& pointOpacityScalars)
 {
+    TRACE_SCOPE("ScatterplotWidget::setPointOpacityScalars");
+
     _pointRenderer.setOpacityChannelScalars(pointOpacityScalars);
+    _performanceHud.setBufferSize("opacities", pointOpacityScalars.size() * sizeof(float));
 
     update();
 }
@@ -373,11 +495,16 @@ void ScatterplotWidget::setSigma(const float sigma)
 {
     _densityRenderer.setSigma(sigma);
 
+    markDensityStale();
+
     update();
 }
 
 void ScatterplotWidget::setWeightDensity(bool useWeights) 
 { 
+    if (useWeights == _weightDensity)
+        return;
+
     _weightDensity = useWeights; 
 
     const std::vector<float>* weights = nullptr;
@@ -386,6 +513,8 @@ void ScatterplotWidget::setWeightDensity(bool useWeights)
         weights = &_pointRenderer.getGpuPoints().getSizeScalars();
 
     _densityRenderer.setWeights(weights);
+
+    markDensityStale();
 }
 
 mv::Vector3f ScatterplotWidget::getColorMapRange() const
@@ -432,6 +561,13 @@ void ScatterplotWidget::showHighlights(bool show)
     update();
 }
 
+void ScatterplotWidget::setShowPerformanceHud(bool show)
+{
+    _performanceHud.setEnabled(show);
+
+    update();
+}
+
 void ScatterplotWidget::createScreenshot(std::int32_t width, std::int32_t height, const QString& fileName, const QColor& backgroundColor)
 {
     // Exit if the viewer is not initialized
@@ -641,6 +777,10 @@ void ScatterplotWidget::resizeGL(int w, int h)
 
 void ScatterplotWidget::paintGL()
 {
+    TRACE_SCOPE("ScatterplotWidget::paintGL");
+
+    _performanceHud.beginFrame();
+
     try {
         QPainter painter;
 
@@ -693,7 +833,13 @@ void ScatterplotWidget::paintGL()
 
         painter.drawImage(0, 0, pixelSelectionToolsImage);
 
+        _performanceHud.paint(painter, rect(), {
+            QString("Points: %1 (%2)").arg(_numPoints).arg(_renderMode == SCATTERPLOT ? "scatterplot" : "density")
+        });
+
         painter.end();
+
+        _performanceHud.endFrame();
     }
     catch (std::exception& e)
     {
@@ -736,7 +882,7 @@ void ScatterplotWidget::setColorMap(const QImage& colorMapImage)
         return;
 
     // Apply color maps to renderers
-    _pointRenderer.setColormap(_colorMapImage);
+    _pointRenderer.setColormap(_coloringMode == ColoringMode::Categorical ? createPaletteImage(_palette) : _colorMapImage);
     _densityRenderer.setColormap(_colorMapImage);
 
     // Render
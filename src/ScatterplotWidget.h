@@ -5,6 +5,8 @@
 
 #include <util/PixelSelectionTool.h>
 
+#include "PerformanceHud.h"
+
 #include <actions/DecimalRectangleAction.h>
 
 #include <graphics/Bounds.h>
@@ -14,6 +16,7 @@
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLWidget>
 #include <QPoint>
+#include <QTimer>
 
 using namespace mv::gui;
 using namespace mv::util;
@@ -47,6 +50,7 @@ public:
         Constant,      /** Point color is a constant color */
         Data,          /** Determined by external dataset */
         Scatter,       /** Determined by scatter layout using a 2D colormap */
+        Categorical,   /** Determined by a label per point and a palette */
     };
 
 public:
@@ -94,6 +98,15 @@ public:
      */
     void setColors(const std::vector<mv::Vector3f>& colors);
 
+    /**
+     * Color the points by a label per point and a palette, the palette is uploaded as color map
+     * If the labels did not change since the last call, only the palette is uploaded
+     * @param labels Palette index per point (size must match that of the loaded points dataset)
+     * @param palette Color per label
+     */
+    void setLabels(const std::vector<std::uint32_t>& labels, const std::vector<mv::Vector3f>& palette);
+
+
     /**
      * Set point size scalars
      * @param pointSizeScalars Point size scalars
@@ -152,6 +165,9 @@ public:
      */
     void createScreenshot(std::int32_t width, std::int32_t height, const QString& fileName, const QColor& backgroundColor);
 
+    /** Show/hide the performance overlay */
+    void setShowPerformanceHud(bool show);
+
 public: // Selection
 
     /**
@@ -245,6 +261,12 @@ protected:
     void paintPixelSelectionToolNative(PixelSelectionTool& pixelSelectionTool, QImage& image, QPainter& painter) const;
 
     void cleanup();
+
+    /** Upload the palette of the categorical coloring as color map of the point renderer */
+    void updatePaletteColorMap();
+
+    /** Positions, weights or sigma changed, recompute the density (throttled) if it is shown */
+    void markDensityStale();
     
     void showEvent(QShowEvent* event) Q_DECL_OVERRIDE
     {
@@ -324,14 +346,22 @@ private:
     widgetSizeInfo              _widgetSizeInfo;                /** Info about size of the scatterplot widget */
     DecimalRectangleAction      _dataRectangleAction;           /** Rectangle action for the bounds of the loaded data */
     QImage                      _colorMapImage;                 /** 1D/2D color map image */
+    std::vector<std::uint32_t>  _labels;                        /** Labels of the categorical coloring */
+    std::vector<mv::Vector3f>   _palette;                       /** Palette of the categorical coloring */
     PixelSelectionTool          _pixelSelectionTool;            /** 2D pixel selection tool */
     PixelSelectionTool          _samplerPixelSelectionTool;     /** 2D pixel selection tool */
     float                       _pixelRatio;                    /** Current pixel ratio */
     QVector<QPoint>             _mousePositions;                /** Recorded mouse positions */
     bool                        _isNavigating;                  /** Boolean determining whether view navigation is currently taking place or not */
     bool                        _weightDensity;                 /** Use point scalar sizes to weight density */
+    bool                        _densityStale;                  /** Whether the density has to be recomputed before it is shown */
+    QTimer                      _densityUpdateTimer;            /** Throttles density recomputation while its inputs change */
+    std::size_t                 _numPoints;                     /** Number of points passed to the point renderer */
+    PerformanceHud              _performanceHud;                /** Optional performance overlay */
 
     mv::plugin::ViewPlugin*     _parentPlugin = nullptr;
 
+    static constexpr int        densityUpdateInterval = 100;    /** Minimum time between density recomputations in ms */
+
     friend class NavigationAction;
 };
@@ -0,0 +1,310 @@
+// Tests of the Qt based parts of the compute module: the offline enrichment, the caches and the derived statistics
+//
+// Files are written to temporary directories, no network access or running ManiVault core is needed
+
+#include "TestCheck.h"
+
+#include "Compute/DerivedDataCache.h"
+#include "Compute/DerivedStatistics.h"
+#include "Compute/EnrichmentCache.h"
+#include "Compute/LocalEnrichment.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVariantMap>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    bool writeTextFile(const QString& filePath, const QString& text)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+            return false;
+
+        QTextStream(&file) << text;
+        return true;
+    }
+}
+
+// terms without genes in the background are not tested and must not take part in the Benjamini-Hochberg ranks
+// before, a tested term with p = 1 could be ranked behind the untested ones and cap the adjusted p values of all other terms
+TEST_CASE(localEnrichmentIgnoresUntestedTermsInFdr)
+{
+    QTemporaryDir directory;
+    CHECK(directory.isValid());
+
+    QStringList background, query;
+    for (int i = 1; i <= 5; i++)
+        background << QString("A%1").arg(i);
+    for (int i = 1; i <= 10; i++)
+        background << QString("B%1").arg(i);
+    for (int i = 1; i <= 20; i++)
+        background << QString("C%1").arg(i);
+
+    query << "A1" << "A2" << "A3" << "A4" << "A5" << "C1";
+
+    QString gmt;
+    gmt += "HIT\tstrong\tA1\tA2\tA3\tA4\tA5\n";
+    gmt += "WEAK\tweak\tC1\tB1\tB2\tB3\tB4\n";         // one of 5 genes in the query, p ~ 0.63
+    gmt += "ZERO\tno overlap\tB5\tB6\tB7\tB8\tB9\tB10\n"; // tested, p = 1
+
+    // many terms without genes in the background
+    for (int i = 0; i < 200; i++)
+        gmt += QString("UNTESTED%1\tuntested\tX%1\n").arg(i);
+
+    const QString gmtFilePath = directory.filePath("terms.gmt");
+    CHECK(writeTextFile(gmtFilePath, gmt));
+
+    LocalEnrichment enrichment;
+    CHECK(enrichment.loadGmt(gmtFilePath));
+
+    const QVariantList significant = enrichment.enrich(query, background, "fdr", 0.05);
+
+    CHECK(significant.size() == 1);
+    if (!significant.isEmpty())
+        CHECK(significant.first().toMap().value("Term ID").toString() == "HIT");
+}
+
+// gene sets loaded into a separate object (as on the loader thread) replace the loaded ones, the ontology is kept when
+// only the gene sets change, and the genes of a term are available offline
+TEST_CASE(localEnrichmentTakesLoadedGeneSets)
+{
+    QTemporaryDir directory;
+    CHECK(directory.isValid());
+
+    const QString oboFilePath = directory.filePath("terms.obo");
+    CHECK(writeTextFile(oboFilePath, "[Term]\nid: GO:0000001\nname: first term\nnamespace: biological_process\n"));
+
+    const QString firstGmtFilePath = directory.filePath("first.gmt");
+    CHECK(writeTextFile(firstGmtFilePath, "GO:0000001\tfirst\tA\tB\n"));
+
+    const QString secondGmtFilePath = directory.filePath("second.gmt");
+    CHECK(writeTextFile(secondGmtFilePath, "GO:0000001\tfirst\tB\tC\tD\n"));
+
+    LocalEnrichment enrichment;
+
+    LocalEnrichment first;
+    CHECK(first.loadGmt(firstGmtFilePath));
+    CHECK(first.loadObo(oboFilePath));
+    enrichment.takeLoaded(std::move(first));
+
+    CHECK(enrichment.getTermGenes("GO:0000001") == QStringList({ "A", "B" }));
+    CHECK(enrichment.getTermGenes("GO:0000002").isEmpty());
+
+    // a background mask of the first gene sets must not survive the swap
+    CHECK(enrichment.enrich({ "A", "B" }, {}, "fdr", 1.1).size() == 1);
+
+    LocalEnrichment second;
+    CHECK(second.loadGmt(secondGmtFilePath));
+    enrichment.takeLoaded(std::move(second));
+
+    CHECK(enrichment.getGmtFilePath() == secondGmtFilePath);
+    CHECK(enrichment.getOboFilePath() == oboFilePath);
+    CHECK(enrichment.getTermGenes("GO:0000001") == QStringList({ "B", "C", "D" }));
+
+    const QVariantList terms = enrichment.enrich({ "C", "D" }, {}, "fdr", 1.1);
+
+    CHECK(terms.size() == 1);
+    if (!terms.isEmpty())
+        CHECK(terms.first().toMap().value("Term Name").toString() == "first term");
+}
+
+// results are found again from disk, but not after the service announced a new data version or once they are too old
+TEST_CASE(enrichmentCacheHonorsDataVersionAndAge)
+{
+    QTemporaryDir directory;
+    CHECK(directory.isValid());
+
+    const QByteArray key = EnrichmentCache::fingerprint({ "A", "B" }, EnrichmentCache::fingerprint(QStringList()), "hsapiens", "fdr");
+    const QVariantList result = { QVariantMap({ { "Term ID", "GO:0000001" } }) };
+
+    {
+        EnrichmentCache cache;
+        cache.setCacheDirectory(directory.path());
+        cache.setDataVersion("e111");
+        cache.insert(key, result);
+    }
+
+    QVariantList found;
+
+    EnrichmentCache cache;
+    cache.setCacheDirectory(directory.path());
+
+    CHECK(cache.getDataVersion() == "e111");
+    CHECK(cache.lookup(key, found) && found == result);
+
+    cache.setDataVersion("e112");
+    CHECK(!cache.lookup(key, found));
+
+    cache.insert(key, result);
+
+    // an entry written long ago is looked up again
+    for (const QFileInfo& entry : QDir(directory.path()).entryInfoList({ "*.bin" }, QDir::Files)) {
+        QFile file(entry.absoluteFilePath());
+        CHECK(file.open(QIODevice::ReadWrite));
+        CHECK(file.setFileTime(QDateTime::currentDateTime().addDays(-cache.getMaxAgeDays() - 1), QFileDevice::FileModificationTime));
+    }
+
+    EnrichmentCache restarted;
+    restarted.setCacheDirectory(directory.path());
+    CHECK(!restarted.lookup(key, found));
+}
+
+// the least recently used entry files are removed once the files exceed the maximum size
+TEST_CASE(enrichmentCacheEvictsLeastRecentlyUsed)
+{
+    QTemporaryDir directory;
+    CHECK(directory.isValid());
+
+    EnrichmentCache cache;
+    cache.setCacheDirectory(directory.path());
+
+    QVariantList result;
+    for (int i = 0; i < 100; i++)
+        result.append(QVariantMap({ { "Term ID", QString("GO:%1").arg(i) }, { "Padj", 1.0 / (i + 1) } }));
+
+    const QByteArray background = EnrichmentCache::fingerprint(QStringList());
+
+    for (int i = 0; i < 10; i++)
+        cache.insert(EnrichmentCache::fingerprint({ QString("G%1").arg(i) }, background, "hsapiens", "fdr"), result);
+
+    const QFileInfoList entries = QDir(directory.path()).entryInfoList({ "*.bin" }, QDir::Files);
+    CHECK(entries.size() == 10);
+
+    qint64 entrySize = 0;
+    for (const QFileInfo& entry : entries)
+        entrySize = std::max(entrySize, entry.size());
+
+    cache.setMaxSize(3 * entrySize);
+
+    CHECK(QDir(directory.path()).entryInfoList({ "*.bin" }, QDir::Files).size() <= 3);
+
+    cache.setMaxSize(0);
+
+    QVariantList found;
+    CHECK(QDir(directory.path()).entryInfoList({ "*.bin" }, QDir::Files).isEmpty());
+    CHECK(cache.lookup(EnrichmentCache::fingerprint({ "G9" }, background, "hsapiens", "fdr"), found));   // still in memory
+}
+
+// artifacts are read back byte for byte, bounded by the maximum size and not read at all with a maximum size of 0
+TEST_CASE(derivedDataCacheStoresAndEvicts)
+{
+    QTemporaryDir directory;
+    CHECK(directory.isValid());
+
+    DerivedDataCache cache;
+    cache.setCacheDirectory(directory.path());
+
+    std::vector<std::byte> data(1000);
+    for (std::size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<std::byte>(i * 7);
+
+    CHECK(!cache.contains("source", "first"));
+    CHECK(cache.store("source", "first", data));
+    CHECK(cache.contains("source", "first"));
+    CHECK(!cache.contains("other source", "first"));
+
+    {
+        const MappedArtifact artifact = cache.open("source", "first");
+        CHECK(artifact.isValid());
+        CHECK(artifact.bytes().size() == data.size() && std::memcmp(artifact.bytes().data(), data.data(), data.size()) == 0);
+    }
+
+    // storing beyond the limit evicts the older artifact
+    cache.setMaxSize(1500);
+    CHECK(cache.store("source", "second", data));
+    CHECK(!cache.contains("source", "first"));
+    CHECK(cache.contains("source", "second"));
+
+    // larger than the whole cache
+    CHECK(!cache.store("source", "third", std::vector<std::byte>(2000)));
+
+    cache.setMaxSize(0);
+    CHECK(!cache.open("source", "second").isValid());
+}
+
+// a project restores the column statistics from its blob and the lines and the cluster summary from the disk cache, the blob itself
+// only names them
+TEST_CASE(derivedStatisticsRoundTrip)
+{
+    QTemporaryDir directory;
+    CHECK(directory.isValid());
+
+    const std::vector<float> mins = { 0.0f, 1.0f, 2.0f }, ranges = { 3.0f, 4.0f, 5.0f }, means = { 0.5f, 1.5f, 2.5f };
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> lines;
+    for (std::uint32_t i = 0; i < 100000; i++)
+        lines.emplace_back(i % 3, i / 7);
+
+    kernels::GroupColumnMoments moments;
+    moments.numRows = 10;
+    moments.numColumns = 3;
+    moments.groupSizes = { 4, 6 };
+    moments.sums = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+    moments.sumSquares = { 1.0, 4.0, 9.0, 16.0, 25.0, 36.0 };
+    moments.numPositive = { 1, 2, 3, 4, 5, 6 };
+    moments.totalSums = { 5.0, 7.0, 9.0 };
+    moments.totalSumSquares = { 17.0, 29.0, 45.0 };
+    moments.totalNumPositive = { 5, 7, 9 };
+
+    QVariantMap project;
+
+    {
+        DerivedStatistics statistics;
+        statistics.getDiskCache().setCacheDirectory(directory.path());
+        statistics.setSourceHash("0123abcd");
+        statistics.setColumnStatistics(mins, ranges, means);
+        statistics.setLines("cells", 0.5f, lines);
+        statistics.setClusterSummary("clusters", moments);
+
+        project = statistics.toVariantMap();
+    }
+
+    // the lines alone take 800 kB, the blob holds a few values per gene and the keys
+    CHECK(project.value("Data").toString().size() < 1000);
+
+    DerivedStatistics statistics;
+    statistics.getDiskCache().setCacheDirectory(directory.path());
+    statistics.fromVariantMap(project);
+
+    CHECK(statistics.getSourceHash() == "0123abcd");
+
+    std::vector<float> restoredMins, restoredRanges, restoredMeans;
+    CHECK(statistics.getColumnStatistics(restoredMins, restoredRanges, restoredMeans));
+    CHECK(restoredMins == mins && restoredRanges == ranges && restoredMeans == means);
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> restoredLines;
+    CHECK(statistics.getLines("cells", 0.5f, restoredLines));
+    CHECK(restoredLines == lines);
+    CHECK(!statistics.getLines("cells", 0.25f, restoredLines));
+
+    kernels::GroupColumnMoments restoredMoments;
+    CHECK(statistics.getClusterSummary("clusters", restoredMoments));
+    CHECK(restoredMoments.numRows == moments.numRows && restoredMoments.numColumns == moments.numColumns);
+    CHECK(restoredMoments.groupSizes == moments.groupSizes && restoredMoments.sums == moments.sums && restoredMoments.sumSquares == moments.sumSquares);
+    CHECK(restoredMoments.numPositive == moments.numPositive && restoredMoments.totalSums == moments.totalSums);
+    CHECK(restoredMoments.totalSumSquares == moments.totalSumSquares && restoredMoments.totalNumPositive == moments.totalNumPositive);
+
+    // another expression matrix drops everything
+    CHECK(!statistics.setSourceHash("4567ef01"));
+    CHECK(!statistics.getLines("cells", 0.5f, restoredLines));
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    // the default cache directories of the caches are created in a test location
+    QStandardPaths::setTestModeEnabled(true);
+
+    return test::runAll();
+}
@@ -0,0 +1,300 @@
+// Tests of the dataset independent compute kernels, they need no Qt or ManiVault
+//
+// Expected values are either computed by hand or by a brute force version of the kernel in this file
+
+#include "TestCheck.h"
+
+#include "Compute/ComputeKernels.h"
+#include "Compute/CrossingMinimization.h"
+#include "Compute/DifferentialExpression.h"
+#include "Compute/SpectralOrdering.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // cells x genes, about half of the values are zero like in a sparse expression matrix, genes are shifted up in some rows so
+    // that the groups of rows differ
+    std::vector<float> randomExpression(std::int64_t numCells, std::int64_t numGenes, std::uint32_t seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+        std::vector<float> values(numCells * numGenes);
+        for (std::int64_t cell = 0; cell < numCells; cell++)
+            for (std::int64_t gene = 0; gene < numGenes; gene++)
+            {
+                const float shift = (cell + gene) % 3 == 0 ? 1.5f : 0.0f;
+                values[cell * numGenes + gene] = uniform(generator) < 0.5f ? 0.0f : std::round(4.0f * uniform(generator) + shift);
+            }
+
+        return values;
+    }
+
+    std::vector<double> benjaminiHochberg(const std::vector<double>& pValues, double numTests)
+    {
+        std::vector<double> adjusted(pValues.size());
+        kernels::benjaminiHochberg(pValues, numTests, adjusted);
+        return adjusted;
+    }
+}
+
+// p values and adjusted p values computed by hand: p * m / rank, then the running minimum from the largest rank down
+TEST_CASE(benjaminiHochbergHandComputed)
+{
+    const std::vector<double> pValues = { 0.041, 0.001, 0.205, 0.039, 0.042, 0.008, 0.074, 0.06 };
+    const std::vector<double> expected = { 0.0672, 0.008, 0.205, 0.0672, 0.0672, 0.032, 0.074 * 8 / 7, 0.08 };
+
+    const auto adjusted = benjaminiHochberg(pValues, 8.0);
+
+    for (std::size_t i = 0; i < pValues.size(); i++)
+        CHECK_NEAR(adjusted[i], expected[i], 1e-12);
+}
+
+TEST_CASE(benjaminiHochbergCappedAtOne)
+{
+    const auto adjusted = benjaminiHochberg({ 0.9, 0.95, 1.0 }, 3.0);
+
+    for (const double value : adjusted)
+        CHECK(value <= 1.0);
+
+    CHECK_NEAR(adjusted[2], 1.0, 1e-12);
+}
+
+// with more tests than given p values (the top k of all genes) the adjusted p values are upper bounds
+TEST_CASE(benjaminiHochbergUpperBound)
+{
+    const std::vector<double> pValues = { 0.001, 0.008, 0.039, 0.041 };
+
+    const auto exact = benjaminiHochberg(pValues, 4.0);
+    const auto bound = benjaminiHochberg(pValues, 10.0);
+
+    for (std::size_t i = 0; i < pValues.size(); i++)
+        CHECK(bound[i] >= exact[i]);
+
+    CHECK_NEAR(bound[0], 0.001 * 10.0, 1e-12);
+}
+
+// a cancelled minimization returns before its first sweep and keeps the given ranks
+TEST_CASE(minimizeCrossingsCancelled)
+{
+    const std::vector<kernels::Line> lines = { { 0, 2 }, { 1, 1 }, { 2, 0 } };
+    std::vector<std::uint32_t> sourceRanks = { 0, 1, 2 };
+    std::vector<std::uint32_t> destinationRanks = { 0, 1, 2 };
+
+    kernels::CancelFlag cancelled(true);
+    kernels::CrossingMinimizationSettings settings;
+    settings.cancelled = &cancelled;
+
+    CHECK(kernels::minimizeCrossings(lines, sourceRanks, destinationRanks, settings) == 3);
+    CHECK(sourceRanks == std::vector<std::uint32_t>({ 0, 1, 2 }));
+
+    cancelled = false;
+    CHECK(kernels::minimizeCrossings(lines, sourceRanks, destinationRanks, settings) == 0);
+}
+
+// a cancelled ordering returns all 0 coordinates, which the engines discard
+TEST_CASE(spectralOrderingCancelled)
+{
+    std::vector<float> points;
+    for (int i = 0; i < 1000; i++)
+    {
+        points.push_back(static_cast<float>(i % 40));
+        points.push_back(static_cast<float>(i / 40));
+    }
+
+    kernels::CancelFlag cancelled(true);
+    kernels::SpectralOrderingSettings settings;
+    settings.cancelled = &cancelled;
+
+    std::vector<float> coordinates;
+    kernels::spectralOrdering(points, coordinates, settings);
+
+    CHECK(coordinates.size() == 1000);
+    CHECK(std::all_of(coordinates.begin(), coordinates.end(), [](float coordinate) { return coordinate == 0.0f; }));
+
+    cancelled = false;
+    kernels::spectralOrdering(points, coordinates, settings);
+    CHECK(*std::max_element(coordinates.begin(), coordinates.end()) == 1.0f);
+}
+
+// the marker genes of a cluster are what the Welch test of a selection of exactly its cells gives, with the same top k and adjusted
+// over all genes
+TEST_CASE(rankMarkerGenesMatchesWelchTest)
+{
+    const std::int64_t numCells = 300, numGenes = 40;
+    const std::vector<float> values = randomExpression(numCells, numGenes, 7);
+    const kernels::MatrixView<float> matrix(values, numCells, numGenes);
+
+    std::vector<std::vector<std::uint32_t>> clusters(3);
+    for (std::uint32_t cell = 0; cell < numCells; cell++)
+        clusters[cell % 7 == 0 ? 0 : (cell < 150 ? 1 : 2)].push_back(cell);
+
+    kernels::GroupColumnMoments moments;
+    kernels::groupColumnMoments(matrix, clusters, moments);
+
+    kernels::GeneRankIndex index;
+    index.build(matrix);
+
+    for (const std::size_t topK : { std::size_t(0), std::size_t(10) })
+    {
+        std::vector<std::vector<kernels::GeneStatistics>> markers;
+        kernels::rankMarkerGenes(moments, topK, markers);
+
+        kernels::DifferentialExpressionSettings settings;
+        settings.test = kernels::DifferentialExpressionTest::WelchTTest;
+        settings.topK = topK;
+
+        for (std::size_t cluster = 0; cluster < clusters.size(); cluster++)
+        {
+            std::vector<kernels::GeneStatistics> genes;
+            kernels::differentialExpression(matrix, index, clusters[cluster], settings, genes);
+
+            CHECK(markers[cluster].size() == genes.size());
+
+            for (std::size_t i = 0; i < genes.size() && i < markers[cluster].size(); i++)
+            {
+                CHECK(markers[cluster][i].gene == genes[i].gene);
+                CHECK_NEAR(markers[cluster][i].score, genes[i].score, 1e-4);
+                CHECK_NEAR(markers[cluster][i].adjustedPValue, genes[i].adjustedPValue, 1e-6);
+                CHECK_NEAR(markers[cluster][i].fractionSelected, genes[i].fractionSelected, 1e-6);
+            }
+        }
+    }
+}
+
+// the rank sum z scores of the index, whose zeros are one implicit tie group, are those of ranking every gene over all cells with
+// mid ranks and the tie correction sum of t^3 - t over all tie groups
+TEST_CASE(wilcoxonTieCorrectionMatchesBruteForce)
+{
+    const std::int64_t numCells = 200, numGenes = 30;
+    const std::vector<float> values = randomExpression(numCells, numGenes, 11);
+    const kernels::MatrixView<float> matrix(values, numCells, numGenes);
+
+    std::vector<std::uint32_t> selectedCells;
+    for (std::uint32_t cell = 0; cell < numCells; cell++)
+        if (cell % 3 == 0 || cell % 5 == 0)
+            selectedCells.push_back(cell);
+
+    kernels::GeneRankIndex index;
+    index.build(matrix);
+
+    std::vector<kernels::GeneStatistics> genes;
+    kernels::differentialExpression(matrix, index, selectedCells, {}, genes);
+
+    CHECK(genes.size() == static_cast<std::size_t>(numGenes));
+
+    std::vector<bool> selected(numCells, false);
+    for (const std::uint32_t cell : selectedCells)
+        selected[cell] = true;
+
+    const double n1 = static_cast<double>(selectedCells.size());
+    const double n2 = static_cast<double>(numCells) - n1;
+    const double n = static_cast<double>(numCells);
+
+    for (const kernels::GeneStatistics& statistics : genes)
+    {
+        std::vector<std::pair<float, std::uint32_t>> column(numCells);
+        for (std::uint32_t cell = 0; cell < numCells; cell++)
+            column[cell] = { matrix.at(cell, statistics.gene), cell };
+
+        std::sort(column.begin(), column.end());
+
+        double rankSum = 0.0, tieSum = 0.0;
+        for (std::size_t begin = 0, end = 0; begin < column.size(); begin = end)
+        {
+            while (end < column.size() && column[end].first == column[begin].first)
+                end++;
+
+            const double ties = static_cast<double>(end - begin);
+            const double midRank = (begin + 1 + end) / 2.0;
+
+            tieSum += ties * ties * ties - ties;
+            for (std::size_t i = begin; i < end; i++)
+                if (selected[column[i].second])
+                    rankSum += midRank;
+        }
+
+        const double u = rankSum - n1 * (n1 + 1.0) / 2.0;
+        const double variance = n1 * n2 / 12.0 * ((n + 1.0) - tieSum / (n * (n - 1.0)));
+        const double z = (u - n1 * n2 / 2.0) / std::sqrt(variance);
+
+        CHECK_NEAR(statistics.score, z, 1e-3);
+    }
+}
+
+// pruning genes whose rank sum can no longer reach the top k keeps exactly the top k genes of the full test, their adjusted p values
+// are the upper bounds of adjusting over all genes
+TEST_CASE(wilcoxonTopKMatchesFullTest)
+{
+    const std::int64_t numCells = 400, numGenes = 300;
+    const std::vector<float> values = randomExpression(numCells, numGenes, 13);
+    const kernels::MatrixView<float> matrix(values, numCells, numGenes);
+
+    std::vector<std::uint32_t> selectedCells;
+    for (std::uint32_t cell = 0; cell < numCells; cell += 4)
+        selectedCells.push_back(cell);
+
+    kernels::GeneRankIndex index;
+    index.build(matrix);
+
+    std::vector<kernels::GeneStatistics> allGenes;
+    kernels::differentialExpression(matrix, index, selectedCells, {}, allGenes);
+
+    for (const std::size_t topK : { std::size_t(1), std::size_t(10), std::size_t(50) })
+    {
+        kernels::DifferentialExpressionSettings settings;
+        settings.topK = topK;
+
+        std::vector<kernels::GeneStatistics> topGenes;
+        kernels::differentialExpression(matrix, index, selectedCells, settings, topGenes);
+
+        CHECK(topGenes.size() == topK);
+
+        for (std::size_t i = 0; i < topGenes.size(); i++)
+        {
+            CHECK(topGenes[i].gene == allGenes[i].gene);
+            CHECK(topGenes[i].score == allGenes[i].score);
+            CHECK(topGenes[i].adjustedPValue >= allGenes[i].adjustedPValue);
+        }
+    }
+}
+
+// the Fenwick tree count is the number of pairs of lines whose sources and destinations are in opposite order
+TEST_CASE(countCrossingsMatchesBruteForce)
+{
+    std::mt19937 generator(17);
+
+    const std::uint32_t numSources = 40, numDestinations = 30;
+
+    std::vector<kernels::Line> lines;
+    std::uniform_int_distribution<std::uint32_t> source(0, numSources - 1), destination(0, numDestinations - 1);
+    for (int i = 0; i < 300; i++)
+        lines.emplace_back(source(generator), destination(generator));
+
+    std::vector<std::uint32_t> sourceRanks(numSources), destinationRanks(numDestinations);
+    std::iota(sourceRanks.begin(), sourceRanks.end(), 0u);
+    std::iota(destinationRanks.begin(), destinationRanks.end(), 0u);
+    std::shuffle(sourceRanks.begin(), sourceRanks.end(), generator);
+    std::shuffle(destinationRanks.begin(), destinationRanks.end(), generator);
+
+    std::uint64_t crossings = 0;
+    for (std::size_t i = 0; i < lines.size(); i++)
+        for (std::size_t j = i + 1; j < lines.size(); j++)
+        {
+            const std::int64_t sourceOrder = std::int64_t(sourceRanks[lines[i].first]) - sourceRanks[lines[j].first];
+            const std::int64_t destinationOrder = std::int64_t(destinationRanks[lines[i].second]) - destinationRanks[lines[j].second];
+            crossings += (sourceOrder < 0 && destinationOrder > 0) || (sourceOrder > 0 && destinationOrder < 0);
+        }
+
+    CHECK(kernels::countCrossings(lines, sourceRanks, destinationRanks) == crossings);
+}
+
+int main()
+{
+    return test::runAll();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+// Minimal test harness of the DualView test executables, no test framework is required
+// TEST_CASE registers a function, CHECK records a failure and continues with the next check
+// main() returns runAll(), so ctest reports an executable with a failed case as failed
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace test
+{
+    struct TestCase
+    {
+        const char*             name;
+        std::function<void()>   function;
+    };
+
+    inline std::vector<TestCase>& registry()
+    {
+        static std::vector<TestCase> testCases;
+        return testCases;
+    }
+
+    inline int& numFailedChecks()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char* name, std::function<void()> function) { registry().push_back({ name, std::move(function) }); }
+    };
+
+    inline void fail(const char* file, int line, const char* expression)
+    {
+        std::printf("  FAILED %s:%d: %s\n", file, line, expression);
+        numFailedChecks()++;
+    }
+
+    // runs all registered cases, returns 1 if any of them failed
+    inline int runAll()
+    {
+        int numFailedCases = 0;
+
+        for (const auto& testCase : registry())
+        {
+            const int before = numFailedChecks();
+            testCase.function();
+
+            const bool failed = numFailedChecks() != before;
+            numFailedCases += failed;
+
+            std::printf("%s %s\n", failed ? "FAIL" : "PASS", testCase.name);
+        }
+
+        std::printf("%d of %zu test cases failed\n", numFailedCases, registry().size());
+
+        return numFailedCases > 0 ? 1 : 0;
+    }
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static const test::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(expression) \
+    do { if (!(expression)) test::fail(__FILE__, __LINE__, #expression); } while (false)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { if (!(std::abs((actual) - (expected)) <= (tolerance))) test::fail(__FILE__, __LINE__, #actual " == " #expected); } while (false)